@@ -0,0 +1,243 @@
+package main
+
+import (
+	"bufio"
+	"cmd/common"
+	"cmd/common/exit"
+	"cmd/common/flags"
+	"cmd/common/flags/help"
+	"cmd/run-qemu/qemu"
+	"encoding/json"
+	"flag"
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+)
+
+const BASELINE_LONG_FLAG = "baseline"
+const BASELINE_SHORT_FLAG = "b"
+
+const INPUT_LONG_FLAG = "input"
+const INPUT_SHORT_FLAG = "i"
+
+const THRESHOLD_LONG_FLAG = "threshold"
+const THRESHOLD_SHORT_FLAG = "t"
+
+const UPDATE_LONG_FLAG = "update"
+const UPDATE_SHORT_FLAG = "u"
+
+// NOTE: Every benchmark result is written to serial as a single JSON line
+// starting with this.
+const RESULT_PREFIX = "{\"benchmark\""
+
+var baselineFile = ""
+var inputFile = qemu.FILE_OUTPUT
+var thresholdPercent = 10
+var isUpdate = false
+
+var isHelp = false
+
+type result struct {
+	Benchmark          string `json:"benchmark"`
+	Parameter          uint64 `json:"parameter"`
+	Iterations         uint64 `json:"iterations"`
+	Min                uint64 `json:"min"`
+	Median             uint64 `json:"median"`
+	P99                uint64 `json:"p99"`
+	Mean               uint64 `json:"mean"`
+	Stddev             uint64 `json:"stddev"`
+	MilliCyclesPerByte uint64 `json:"milliCyclesPerByte"`
+}
+
+func (r result) key() string {
+	return fmt.Sprintf("%s %d", r.Benchmark, r.Parameter)
+}
+
+func usage() {
+	flags.DisplayUsage("")
+	fmt.Printf("\n")
+	flags.DisplayRequiredFlags()
+	flags.DisplayNoDefaultArgumentInput(BASELINE_SHORT_FLAG, BASELINE_LONG_FLAG, "Stored results to compare against")
+	fmt.Printf("\n")
+	flags.DisplayOptionalFlags()
+	flags.DisplayArgumentInput(INPUT_SHORT_FLAG, INPUT_LONG_FLAG, "Serial output that contains the results", inputFile)
+	flags.DisplayArgumentInput(THRESHOLD_SHORT_FLAG, THRESHOLD_LONG_FLAG, "Percentage a median may grow before it is a regression", fmt.Sprint(thresholdPercent))
+	flags.DisplayArgumentInput(UPDATE_SHORT_FLAG, UPDATE_LONG_FLAG, "Store the results as the new baseline instead", fmt.Sprint(isUpdate))
+	help.DisplayHelp()
+	fmt.Printf("\n")
+	exit.DisplayExitCodes()
+	exit.DisplayExitCode(exit.EXIT_SUCCESS)
+	exit.DisplayExitCode(exit.EXIT_MISSING_ARGUMENT)
+	exit.DisplayExitCode(exit.EXIT_CLI_PARSING_ERROR)
+	exit.DisplayExitCode(exit.EXIT_TARGET_ERROR)
+	exit.DisplayExitCode(exit.EXIT_BENCHMARK_REGRESSION)
+	fmt.Printf("\n")
+	flags.DisplayExamples()
+	fmt.Printf("  %s --%s benchmarks.jsonl --%s\n", filepath.Base(os.Args[0]), BASELINE_LONG_FLAG, UPDATE_LONG_FLAG)
+	fmt.Printf("  %s -%s benchmarks.jsonl -%s %s -%s 5\n", filepath.Base(os.Args[0]), BASELINE_SHORT_FLAG, INPUT_SHORT_FLAG, qemu.FILE_OUTPUT, THRESHOLD_SHORT_FLAG)
+	fmt.Printf("\n")
+}
+
+// Reads all result lines, the serial output may contain other lines as well.
+// A later result of the same benchmark replaces an earlier one.
+func resultsRead(fileName string) ([]result, error) {
+	file, err := os.Open(fileName)
+	if err != nil {
+		return nil, err
+	}
+	defer file.Close()
+
+	var results []result
+	indices := make(map[string]int)
+
+	scanner := bufio.NewScanner(file)
+	for scanner.Scan() {
+		line := strings.TrimSpace(scanner.Text())
+		if !strings.HasPrefix(line, RESULT_PREFIX) {
+			continue
+		}
+
+		var current result
+		if err := json.Unmarshal([]byte(line), &current); err != nil {
+			return nil, fmt.Errorf("could not parse %q: %w", line, err)
+		}
+
+		if index, ok := indices[current.key()]; ok {
+			results[index] = current
+		} else {
+			indices[current.key()] = len(results)
+			results = append(results, current)
+		}
+	}
+	return results, scanner.Err()
+}
+
+func resultsWrite(fileName string, results []result) error {
+	file, err := os.Create(fileName)
+	if err != nil {
+		return err
+	}
+	defer file.Close()
+
+	encoder := json.NewEncoder(file)
+	for _, current := range results {
+		if err := encoder.Encode(current); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+func percentageChange(before uint64, after uint64) float64 {
+	if before == 0 {
+		return 0
+	}
+	return (float64(after) - float64(before)) * 100 / float64(before)
+}
+
+// Returns the number of regressions. Only the median is used to decide, the
+// p99 is shown because it is what the tail of a change looks like.
+func resultsCompare(baseline []result, current []result) int {
+	baselines := make(map[string]result)
+	for _, before := range baseline {
+		baselines[before.key()] = before
+	}
+
+	regressions := 0
+	fmt.Printf("%-30s %14s %14s %9s %9s\n", "benchmark", "median before", "median after", "median", "p99")
+	for _, after := range current {
+		before, ok := baselines[after.key()]
+		if !ok {
+			fmt.Printf("%-30s %14s %14d %9s %9s\n", after.key(), "-", after.Median, "new", "new")
+			continue
+		}
+		delete(baselines, after.key())
+
+		medianChange := percentageChange(before.Median, after.Median)
+		color := common.RESET
+		if medianChange > float64(thresholdPercent) {
+			color = common.RED
+			regressions++
+		} else if medianChange < -float64(thresholdPercent) {
+			color = common.GREEN
+		}
+		fmt.Printf("%s%-30s %14d %14d %+8.1f%% %+8.1f%%%s\n", color, after.key(), before.Median, after.Median, medianChange, percentageChange(before.P99, after.P99), common.RESET)
+	}
+
+	for _, before := range baseline {
+		if _, ok := baselines[before.key()]; ok {
+			fmt.Printf("%s%-30s did not run%s\n", common.YELLOW, before.key(), common.RESET)
+		}
+	}
+
+	return regressions
+}
+
+func main() {
+	flag.StringVar(&baselineFile, BASELINE_LONG_FLAG, baselineFile, "")
+	flag.StringVar(&baselineFile, BASELINE_SHORT_FLAG, baselineFile, "")
+
+	flag.StringVar(&inputFile, INPUT_LONG_FLAG, inputFile, "")
+	flag.StringVar(&inputFile, INPUT_SHORT_FLAG, inputFile, "")
+
+	flag.IntVar(&thresholdPercent, THRESHOLD_LONG_FLAG, thresholdPercent, "")
+	flag.IntVar(&thresholdPercent, THRESHOLD_SHORT_FLAG, thresholdPercent, "")
+
+	flag.BoolVar(&isUpdate, UPDATE_LONG_FLAG, isUpdate, "")
+	flag.BoolVar(&isUpdate, UPDATE_SHORT_FLAG, isUpdate, "")
+
+	help.AddHelpAsFlag(&isHelp)
+
+	flag.Usage = usage
+	flag.Parse()
+
+	var showHelpAndExit = false
+
+	if len(baselineFile) == 0 {
+		showHelpAndExit = true
+	}
+
+	if isHelp {
+		showHelpAndExit = true
+	}
+
+	if showHelpAndExit {
+		usage()
+		if isHelp {
+			os.Exit(exit.EXIT_SUCCESS)
+		}
+		os.Exit(exit.EXIT_MISSING_ARGUMENT)
+	}
+
+	current, err := resultsRead(inputFile)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "Could not read results from %s: %v\n", inputFile, err)
+		os.Exit(exit.EXIT_TARGET_ERROR)
+	}
+	if len(current) == 0 {
+		fmt.Fprintf(os.Stderr, "No benchmark results in %s\n", inputFile)
+		os.Exit(exit.EXIT_TARGET_ERROR)
+	}
+
+	if isUpdate {
+		if err := resultsWrite(baselineFile, current); err != nil {
+			fmt.Fprintf(os.Stderr, "Could not write baseline %s: %v\n", baselineFile, err)
+			os.Exit(exit.EXIT_TARGET_ERROR)
+		}
+		fmt.Printf("Stored %d results in %s\n", len(current), baselineFile)
+		os.Exit(exit.EXIT_SUCCESS)
+	}
+
+	baseline, err := resultsRead(baselineFile)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "Could not read baseline %s: %v\n", baselineFile, err)
+		os.Exit(exit.EXIT_TARGET_ERROR)
+	}
+
+	regressions := resultsCompare(baseline, current)
+	if regressions > 0 {
+		fmt.Printf("%s%d benchmark(s) regressed by more than %d%%%s\n", common.RED, regressions, thresholdPercent, common.RESET)
+		os.Exit(exit.EXIT_BENCHMARK_REGRESSION)
+	}
+}
@@ -10,3 +10,5 @@ go build -o run-qemu.elf run-qemu/run-qemu.go
 go build -o hardware.elf hardware/hardware.go
 go build -o headers.elf headers/headers.go
 go build -o iwyu.elf iwyu/iwyu.go
+go build -o profile.elf profile/profile.go
+go build -o benchmark.elf benchmark/benchmark.go
@@ -17,7 +17,7 @@ func includeWhatYouUseFlag(flag string) string {
 	return fmt.Sprintf("-Xiwyu;%s;", flag)
 }
 
-func AddDefaultConfigureOptions(options *strings.Builder, proj *project.ProjectStructure, buildDirectory string, buildMode string, buildTests bool, projectTargetsFile string, architecture string, serial bool, vendor string, underlying string) {
+func AddDefaultConfigureOptions(options *strings.Builder, proj *project.ProjectStructure, buildDirectory string, buildMode string, buildTests bool, projectTargetsFile string, architecture string, serial bool, memoryTrace bool, vendor string, underlying string) {
 	argument.AddArgument(options, fmt.Sprintf("-S %s", proj.CodeFolder))
 	argument.AddArgument(options, fmt.Sprintf("-B %s", buildDirectory))
 
@@ -40,6 +40,7 @@ func AddDefaultConfigureOptions(options *strings.Builder, proj *project.ProjectS
 	argument.AddArgument(options, fmt.Sprintf("-D PROJECT_TARGETS_FILE=%s", projectTargetsFile))
 	argument.AddArgument(options, fmt.Sprintf("-D FLOAT_OPERATIONS=%t", proj.FloatOperations))
 	argument.AddArgument(options, fmt.Sprintf("-D SERIAL=%t", serial))
+	argument.AddArgument(options, fmt.Sprintf("-D MEMORY_TRACE=%t", memoryTrace))
 
 	var build string
 	if buildTests {
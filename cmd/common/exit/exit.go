@@ -10,12 +10,14 @@ const EXIT_SUCCESS = 0
 const EXIT_MISSING_ARGUMENT = 1
 const EXIT_CLI_PARSING_ERROR = 2
 const EXIT_TARGET_ERROR = 3
+const EXIT_BENCHMARK_REGRESSION = 4
 
 var exitToString = [...]string{
 	"Success",
 	"Incorrect argument(s)",
 	"CLI parsing error",
 	"Targets to build error",
+	"Benchmark regression",
 }
 
 func DisplayExitCodes() {
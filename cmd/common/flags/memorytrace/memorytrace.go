@@ -0,0 +1,26 @@
+package memorytrace
+
+import (
+	"cmd/common/configuration"
+	"cmd/common/flags"
+	"flag"
+	"fmt"
+)
+
+const MEMORY_TRACE_LONG_FLAG = "memory-trace"
+
+func DefaultMemoryTrace() bool {
+	return false
+}
+
+func DisplayMemoryTrace() {
+	flags.DisplayLongFlagArgumentInput(MEMORY_TRACE_LONG_FLAG, "Record allocations and page faults, exported over serial", fmt.Sprint(DefaultMemoryTrace()))
+}
+
+func AddMemoryTraceAsFlag(memoryTrace *bool) {
+	flag.BoolVar(memoryTrace, MEMORY_TRACE_LONG_FLAG, *memoryTrace, "")
+}
+
+func DisplayMemoryTraceConfiguration(memoryTrace bool) {
+	configuration.DisplayBoolArgument(MEMORY_TRACE_LONG_FLAG, memoryTrace)
+}
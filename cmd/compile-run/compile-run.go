@@ -6,6 +6,7 @@ import (
 	"cmd/common/flags"
 	"cmd/common/flags/buildmode"
 	"cmd/common/flags/graphic"
+	"cmd/common/flags/memorytrace"
 	"cmd/common/flags/qemuoutput"
 	"cmd/common/flags/serial"
 	"cmd/common/uefiimage"
@@ -29,6 +30,7 @@ func usage() {
 
 	buildmode.DisplayBuildMode()
 	serial.DisplaySerial()
+	memorytrace.DisplayMemoryTrace()
 	qemuoutput.DisplayQemuOutput()
 	graphic.DisplayGraphic()
 
@@ -48,6 +50,7 @@ func usage() {
 func main() {
 	buildmode.AddBuildModeAsFlag(&buildArgs.BuildMode)
 	serial.AddSerialAsFlag(&buildArgs.Serial)
+	memorytrace.AddMemoryTraceAsFlag(&buildArgs.MemoryTrace)
 	qemuoutput.AddQemuOutputAsFlag(&qemuArgs.OutputToFile)
 	graphic.AddGraphicAsFlag(&qemuArgs.Graphic)
 
@@ -75,6 +78,7 @@ func main() {
 	configuration.DisplayConfiguration()
 	buildmode.DisplayBuildModeConfiguration(buildArgs.BuildMode)
 	serial.DisplaySerialConfiguration(buildArgs.Serial)
+	memorytrace.DisplayMemoryTraceConfiguration(buildArgs.MemoryTrace)
 	qemuoutput.DisplayQemuOutputConfiguration(qemuArgs.OutputToFile)
 	graphic.DisplayGraphicConfiguration(qemuArgs.Graphic)
 	fmt.Printf("\n")
@@ -70,7 +70,7 @@ func buildProject(args *BuildArgs, proj *project.ProjectStructure) {
 
 	var buildDirectory = project.BuildDirectoryRoot(proj, args.BuildMode, args.Architecture, args.Serial)
 	var projectTargetsFile = project.BuildProjectTargetsFile(proj.CodeFolder)
-	cmake.AddDefaultConfigureOptions(&configureOptions, proj, buildDirectory, args.BuildMode, args.BuildTests, projectTargetsFile, args.Architecture, args.Serial, args.Vendor, args.Underlying)
+	cmake.AddDefaultConfigureOptions(&configureOptions, proj, buildDirectory, args.BuildMode, args.BuildTests, projectTargetsFile, args.Architecture, args.Serial, args.MemoryTrace, args.Vendor, args.Underlying)
 	argument.ExecCommandWriteOutput(fmt.Sprintf("%s %s", cmake.EXECUTABLE, configureOptions.String()), errorWriters...)
 
 	buildOptions := strings.Builder{}
@@ -93,6 +93,7 @@ type BuildArgs struct {
 	ErrorsToFile     bool
 	Threads          int
 	Serial           bool
+	MemoryTrace      bool
 	SelectedTargets  []string
 	SelectedProjects []string
 	BuildTests       bool
@@ -116,6 +117,7 @@ var RunBuildArgs = BuildArgs{
 	ErrorsToFile:     false,
 	Threads:          runtime.NumCPU(),
 	Serial:           false,
+	MemoryTrace:      false,
 	SelectedTargets:  []string{},
 	SelectedProjects: []string{project.KERNEL, project.IMAGE_BUILDER, project.OS_LOADER},
 	BuildTests:       false,
@@ -132,6 +134,7 @@ var DefaultBuildArgs = BuildArgs{
 	ErrorsToFile:     false,
 	Threads:          runtime.NumCPU(),
 	Serial:           false,
+	MemoryTrace:      false,
 	SelectedTargets:  []string{},
 	SelectedProjects: []string{},
 	BuildTests:       false,
@@ -9,6 +9,7 @@ import (
 	"cmd/common/flags/buildmode"
 	"cmd/common/flags/environment"
 	"cmd/common/flags/help"
+	"cmd/common/flags/memorytrace"
 	"cmd/common/flags/serial"
 	"cmd/common/flags/vendor"
 	"cmd/common/project"
@@ -54,6 +55,7 @@ func main() {
 	project.AddProjectAsFlag(&projectsToBuild)
 	help.AddHelpAsFlag(&isHelp)
 	serial.AddSerialAsFlag(&buildArgs.Serial)
+	memorytrace.AddMemoryTraceAsFlag(&buildArgs.MemoryTrace)
 	vendor.AddVendorAsFlag(&buildArgs.Vendor)
 
 	flag.StringVar(&targetsToBuild, SELECT_TARGETS_LONG_FLAG, "", "")
@@ -121,6 +123,7 @@ func main() {
 	environment.DisplayEnvironmentConfiguration(buildArgs.Environment)
 	project.DisplayProjectConfiguration(buildArgs.SelectedProjects)
 	serial.DisplaySerialConfiguration(buildArgs.Serial)
+	memorytrace.DisplayMemoryTraceConfiguration(buildArgs.MemoryTrace)
 
 	var targetsConfiguration string
 	if len(buildArgs.SelectedTargets) > 0 {
@@ -162,6 +165,7 @@ func usage() {
 	architecture.DisplayArchitecture()
 	project.DisplayProject()
 	serial.DisplaySerial()
+	memorytrace.DisplayMemoryTrace()
 
 	flags.DisplayArgumentInput(ERRORS_TO_FILE_SHORT_FLAG, ERRORS_TO_FILE_LONG_FLAG, "Save errors to file", fmt.Sprint(buildArgs.ErrorsToFile))
 
@@ -0,0 +1,207 @@
+package main
+
+import (
+	"bufio"
+	"cmd/common/exit"
+	"cmd/common/flags"
+	"cmd/common/flags/help"
+	"cmd/run-qemu/qemu"
+	"debug/elf"
+	"flag"
+	"fmt"
+	"os"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"strings"
+)
+
+const KERNEL_LONG_FLAG = "kernel"
+const KERNEL_SHORT_FLAG = "k"
+
+const INPUT_LONG_FLAG = "input"
+const INPUT_SHORT_FLAG = "i"
+
+const PROFILE_BEGIN = "PROFILE BEGIN"
+const PROFILE_END = "PROFILE END"
+
+var kernelFile = ""
+var inputFile = qemu.FILE_OUTPUT
+
+var isHelp = false
+
+type function struct {
+	start uint64
+	end   uint64
+	name  string
+}
+
+func usage() {
+	flags.DisplayUsage("")
+	fmt.Printf("\n")
+	flags.DisplayRequiredFlags()
+	flags.DisplayNoDefaultArgumentInput(KERNEL_SHORT_FLAG, KERNEL_LONG_FLAG, "The kernel ELF that produced the profile")
+	fmt.Printf("\n")
+	flags.DisplayOptionalFlags()
+	flags.DisplayArgumentInput(INPUT_SHORT_FLAG, INPUT_LONG_FLAG, "Serial output that contains the profile", inputFile)
+	help.DisplayHelp()
+	fmt.Printf("\n")
+	exit.DisplayExitCodes()
+	exit.DisplayExitCode(exit.EXIT_SUCCESS)
+	exit.DisplayExitCode(exit.EXIT_MISSING_ARGUMENT)
+	exit.DisplayExitCode(exit.EXIT_CLI_PARSING_ERROR)
+	exit.DisplayExitCode(exit.EXIT_TARGET_ERROR)
+	fmt.Printf("\n")
+	flags.DisplayExamples()
+	fmt.Printf("  %s --%s %s > kernel.folded\n", filepath.Base(os.Args[0]), KERNEL_LONG_FLAG, "projects/kernel/code/build/.../serial/PROFILING/kernel")
+	fmt.Printf("  %s -%s kernel -%s %s | flamegraph.pl > kernel.svg\n", filepath.Base(os.Args[0]), KERNEL_SHORT_FLAG, INPUT_SHORT_FLAG, qemu.FILE_OUTPUT)
+	fmt.Printf("\n")
+}
+
+func functionsRead(kernel string) ([]function, error) {
+	file, err := elf.Open(kernel)
+	if err != nil {
+		return nil, err
+	}
+	defer file.Close()
+
+	symbols, err := file.Symbols()
+	if err != nil {
+		return nil, err
+	}
+
+	var functions []function
+	for _, symbol := range symbols {
+		if elf.ST_TYPE(symbol.Info) != elf.STT_FUNC || symbol.Value == 0 {
+			continue
+		}
+		functions = append(functions, function{start: symbol.Value, end: symbol.Value + symbol.Size, name: symbol.Name})
+	}
+	sort.Slice(functions, func(i, j int) bool { return functions[i].start < functions[j].start })
+	return functions, nil
+}
+
+func symbolize(functions []function, address uint64) string {
+	index := sort.Search(len(functions), func(i int) bool { return functions[i].start > address }) - 1
+	// NOTE: Symbols without a size, e.g., from assembly, cover everything up
+	// to the next symbol.
+	if index >= 0 && (address < functions[index].end || functions[index].start == functions[index].end) {
+		return functions[index].name
+	}
+	return fmt.Sprintf("0x%x", address)
+}
+
+// Every line is "root;...;leaf count" with raw addresses. All but the leaf are
+// return addresses, so they are moved back into the call instruction first.
+func stackSymbolize(functions []function, line string) (string, error) {
+	separator := strings.LastIndexByte(line, ' ')
+	if separator < 0 {
+		return "", fmt.Errorf("no count in %q", line)
+	}
+
+	frames := strings.Split(line[:separator], ";")
+	for i, frame := range frames {
+		address, err := strconv.ParseUint(strings.TrimPrefix(frame, "0x"), 16, 64)
+		if err != nil {
+			return "", err
+		}
+		if i != len(frames)-1 {
+			address--
+		}
+		frames[i] = symbolize(functions, address)
+	}
+	return strings.Join(frames, ";"), nil
+}
+
+func profileConvert(functions []function, input *os.File) (map[string]uint64, error) {
+	counts := make(map[string]uint64)
+	inProfile := false
+
+	scanner := bufio.NewScanner(input)
+	for scanner.Scan() {
+		line := strings.TrimSpace(scanner.Text())
+		if strings.HasPrefix(line, PROFILE_BEGIN) {
+			inProfile = true
+			continue
+		}
+		if strings.HasPrefix(line, PROFILE_END) {
+			inProfile = false
+			continue
+		}
+		if !inProfile || len(line) == 0 {
+			continue
+		}
+
+		stack, err := stackSymbolize(functions, line)
+		if err != nil {
+			return nil, err
+		}
+		count, err := strconv.ParseUint(line[strings.LastIndexByte(line, ' ')+1:], 10, 64)
+		if err != nil {
+			return nil, err
+		}
+		counts[stack] += count
+	}
+	return counts, scanner.Err()
+}
+
+func main() {
+	flag.StringVar(&kernelFile, KERNEL_LONG_FLAG, kernelFile, "")
+	flag.StringVar(&kernelFile, KERNEL_SHORT_FLAG, kernelFile, "")
+
+	flag.StringVar(&inputFile, INPUT_LONG_FLAG, inputFile, "")
+	flag.StringVar(&inputFile, INPUT_SHORT_FLAG, inputFile, "")
+
+	help.AddHelpAsFlag(&isHelp)
+
+	flag.Usage = usage
+	flag.Parse()
+
+	var showHelpAndExit = false
+
+	if len(kernelFile) == 0 {
+		showHelpAndExit = true
+	}
+
+	if isHelp {
+		showHelpAndExit = true
+	}
+
+	if showHelpAndExit {
+		usage()
+		if isHelp {
+			os.Exit(exit.EXIT_SUCCESS)
+		}
+		os.Exit(exit.EXIT_MISSING_ARGUMENT)
+	}
+
+	functions, err := functionsRead(kernelFile)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "Could not read symbols of %s: %v\n", kernelFile, err)
+		os.Exit(exit.EXIT_TARGET_ERROR)
+	}
+
+	input, err := os.Open(inputFile)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "Could not open %s: %v\n", inputFile, err)
+		os.Exit(exit.EXIT_TARGET_ERROR)
+	}
+	defer input.Close()
+
+	counts, err := profileConvert(functions, input)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "Could not convert profile: %v\n", err)
+		os.Exit(exit.EXIT_TARGET_ERROR)
+	}
+
+	stacks := make([]string, 0, len(counts))
+	for stack := range counts {
+		stacks = append(stacks, stack)
+	}
+	sort.Strings(stacks)
+	// NOTE: Only the folded stacks go to stdout, so they can be piped into a
+	// flame graph generator.
+	for _, stack := range stacks {
+		fmt.Printf("%s %d\n", stack, counts[stack])
+	}
+}
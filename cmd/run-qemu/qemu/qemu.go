@@ -17,6 +17,7 @@ type QemuArgs struct {
 	Verbose      bool
 	Debug        bool
 	Graphic      bool
+	Processors   int
 }
 
 var DefaultQemuArgs = QemuArgs{
@@ -26,6 +27,7 @@ var DefaultQemuArgs = QemuArgs{
 	Verbose:      false,
 	Debug:        false,
 	Graphic:      false,
+	Processors:   4,
 }
 
 func Run(args *QemuArgs) {
@@ -44,7 +46,7 @@ func Run(args *QemuArgs) {
 		argument.AddArgument(&qemuOptions, "-nographic")
 	}
 
-	argument.AddArgument(&qemuOptions, "-smp 1")
+	argument.AddArgument(&qemuOptions, fmt.Sprintf("-smp %d", args.Processors))
 	argument.AddArgument(&qemuOptions, "-usb")
 	argument.AddArgument(&qemuOptions, "-vga std")
 	argument.AddArgument(&qemuOptions, "-enable-kvm")
@@ -27,6 +27,9 @@ const VERBOSE_SHORT_FLAG = "v"
 const DEBUG_LONG_FLAG = "debug"
 const DEBUG_SHORT_FLAG = "d"
 
+const PROCESSORS_LONG_FLAG = "processors"
+const PROCESSORS_SHORT_FLAG = "p"
+
 var qemuArgs = qemu.DefaultQemuArgs
 
 var isHelp = false
@@ -41,6 +44,7 @@ func usage() {
 	qemuoutput.DisplayQemuOutput()
 	flags.DisplayArgumentInput(VERBOSE_SHORT_FLAG, VERBOSE_LONG_FLAG, "Enable verbose QEMU", fmt.Sprint(qemuArgs.Verbose))
 	flags.DisplayArgumentInput(DEBUG_SHORT_FLAG, DEBUG_LONG_FLAG, "Wait for gdb to connect to port 1234 before running", fmt.Sprint(qemuArgs.Debug))
+	flags.DisplayArgumentInput(PROCESSORS_SHORT_FLAG, PROCESSORS_LONG_FLAG, "Set the number of processors to emulate", fmt.Sprint(qemuArgs.Processors))
 	graphic.DisplayGraphic()
 	help.DisplayHelp()
 	fmt.Printf("\n")
@@ -71,6 +75,9 @@ func main() {
 	flag.BoolVar(&qemuArgs.Debug, DEBUG_LONG_FLAG, qemuArgs.Debug, "")
 	flag.BoolVar(&qemuArgs.Debug, DEBUG_SHORT_FLAG, qemuArgs.Debug, "")
 
+	flag.IntVar(&qemuArgs.Processors, PROCESSORS_LONG_FLAG, qemuArgs.Processors, "")
+	flag.IntVar(&qemuArgs.Processors, PROCESSORS_SHORT_FLAG, qemuArgs.Processors, "")
+
 	help.AddHelpAsFlag(&isHelp)
 
 	flag.Usage = usage
@@ -98,6 +105,7 @@ func main() {
 	configuration.DisplayStringArgument(EFI_LOCATION_LONG_FLAG, qemuArgs.UefiLocation)
 	configuration.DisplayBoolArgument(VERBOSE_LONG_FLAG, qemuArgs.Verbose)
 	configuration.DisplayBoolArgument(DEBUG_LONG_FLAG, qemuArgs.Debug)
+	configuration.DisplayIntArgument(PROCESSORS_LONG_FLAG, qemuArgs.Processors)
 	fmt.Printf("\n")
 
 	qemu.Run(&qemuArgs)
@@ -0,0 +1,33 @@
+#ifndef ABSTRACTION_COROUTINE_H
+#define ABSTRACTION_COROUTINE_H
+
+#include "shared/types/numeric.h"
+
+// Stackful coroutines that are switched cooperatively on the same processor.
+// Switching only saves the registers the calling convention preserves, so it
+// is far cheaper than a thread switch.
+
+typedef struct Coroutine Coroutine;
+typedef void (*CoroutineFunction)(Coroutine *self, void *argument);
+// Polled by whoever resumes the coroutine, so a coroutine that waits on a
+// device is not switched to until the device is done.
+typedef bool (*CoroutineCompletion)(void *argument);
+
+[[nodiscard]] Coroutine *coroutineCreate(CoroutineFunction function,
+                                         void *argument);
+// NOTE: Only free a coroutine that finished or will never be resumed again.
+void coroutineDestroy(Coroutine *coroutine);
+
+// Runs the coroutine until it yields, awaits or finishes. Returns whether it
+// still has work left.
+bool coroutineResume(Coroutine *coroutine);
+
+// NOTE: Only to be called by the coroutine itself.
+void coroutineYield(Coroutine *self);
+void coroutineAwait(Coroutine *self, CoroutineCompletion completed,
+                    void *argument);
+
+// Resumes the coroutines in turn until all of them finished.
+void coroutinesRun(Coroutine **coroutines, U32 count);
+
+#endif
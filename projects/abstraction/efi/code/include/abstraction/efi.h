@@ -10,7 +10,12 @@
 void virtualMemoryRootPageInit();
 void kernelMemoryManagementInit(U64 startingAddress, U64 endingAddress);
 
-void archParamsFill(void *archParams, U64 memoryVirtualAddressAvailable);
+// Returns the first available virtual address after the memory that the arch
+// mapped for the kernel. stackTop is the top of the stack that the kernel is
+// entered on.
+[[nodiscard]] U64 archParamsFill(void *archParams,
+                                 U64 memoryVirtualAddressAvailable,
+                                 U64 stackTop);
 
 typedef struct KernelParameters KernelParameters;
 void kernelJump(U64 newStackPointer, U16 processorID,
@@ -13,6 +13,7 @@ void interruptsInit();
 // arch specific - should only be called in freestanding
 void interruptsEnable();
 void interruptsDisable();
+[[nodiscard]] bool interruptsEnabled();
 
 // arch specific and / or emulated by env such as efi
 __attribute__((noreturn)) void interruptPhysicalMemory();
@@ -23,8 +24,6 @@ __attribute__((noreturn)) void interruptBuffer();
 
 __attribute__((noreturn)) void interruptUnexpectedError();
 
-extern U64 pageFaultsCurrent;
-
 typedef struct Registers Registers;
 void faultHandler(Registers *regs);
 
@@ -1,9 +1,32 @@
 #ifndef ABSTRACTION_KERNEL_H
 #define ABSTRACTION_KERNEL_H
 
+#include "shared/types/numeric.h"
+
 // NOTE: If this grows out of control, we can collapse this into a single
 // archInit function that takes a stage and a void* to arguments and take it
 // from there.
 void archInit(void *archInit);
 
+typedef void (*ProcessorWork)(void *argument);
+
+// Starts all other processors and waits until they are running. Returns the
+// number of running processors, including the current one. Processors that
+// are not the current one wait for work with interrupts disabled.
+[[nodiscard]] U32 processorsStart();
+
+// Hands the work to the processor once it is idle.
+void processorWorkRun(U32 processorID, ProcessorWork work, void *argument);
+void processorWorkWait(U32 processorID);
+
+// Halts the current processor until it is woken or another interrupt arrives.
+// Must be called with interrupts disabled, they are only enabled for the halt
+// itself so a wake-up that is sent right before can not be missed.
+void processorSleep();
+void processorWake(U32 processorID);
+
+// Appends the latency percentiles of every interrupt vector, and of page faults
+// per outcome, over all processors.
+void interruptLatenciesStatusAppend();
+
 #endif
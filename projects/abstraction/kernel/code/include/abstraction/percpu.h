@@ -0,0 +1,14 @@
+#ifndef ABSTRACTION_PERCPU_H
+#define ABSTRACTION_PERCPU_H
+
+// Provides PERCPU_GET(field), PERCPU_SET(field, value) and
+// PERCPU_ADD(field, value) to access the area of the current processor.
+// clang-format off
+#ifdef X86
+    #include "x86/kernel/percpu.h"
+#else
+    #error "ABSTRACTION_PERCPU_H"
+#endif
+// clang-format on
+
+#endif
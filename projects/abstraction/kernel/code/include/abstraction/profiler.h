@@ -0,0 +1,19 @@
+#ifndef ABSTRACTION_PROFILER_H
+#define ABSTRACTION_PROFILER_H
+
+#include "shared/types/numeric.h"
+
+// Samples where the current processor is executing at a fixed interval. Every
+// processor has its own ring of samples, only the newest ones are kept.
+//
+// NOTE: Samples are taken from an NMI of a performance counter that counts
+// core cycles, so code that runs with interrupts disabled is sampled too, but
+// a halted processor is not.
+void profilerStart(U64 intervalMicroSeconds);
+void profilerStop();
+
+// Stops the profiler of the current processor and writes its samples to serial
+// as folded stacks of raw addresses, see cmd/profile to symbolize them.
+void profilerDump();
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef ABSTRACTION_TIMER_H
+#define ABSTRACTION_TIMER_H
+
+#include "shared/types/numeric.h"
+
+typedef void (*TimerFunction)(void *argument);
+
+// NOTE: Embedded by the user, so starting and cancelling never allocates. The
+// fields are only for the timer code.
+typedef struct Timer {
+    struct Timer *next;
+    struct Timer **previousNext;
+    U64 deadline; // In timer ticks
+    U64 expiry;   // The deadline rounded up to the slot it is in
+    U64 period;   // 0 for a one-shot timer
+    U32 processorID;
+    bool pending;
+    TimerFunction function;
+    void *argument;
+} Timer;
+
+// Sets up the timers of the current processor. Timers fire on the processor
+// that started them, with interrupts disabled.
+void timersInit();
+
+void timerInit(Timer *timer, TimerFunction function, void *argument);
+// Fires once after the given time. Starting a pending timer moves it.
+void timerStart(Timer *timer, U64 microSeconds);
+void timerPeriodicStart(Timer *timer, U64 microSeconds);
+// NOTE: A function that already started running is not waited for.
+void timerCancel(Timer *timer);
+
+#endif
@@ -24,9 +24,19 @@ void pageMap_(U64 virt, U64 physical, U64_pow2 mappingSize, U64 flags);
 // with bytes being the size of that page which is unmapped.
 [[nodiscard]] Memory pageUnmap(U64 virt);
 
+// Whether anything is mapped at the virtual address.
+[[nodiscard]] bool pageMapped(U64 virt);
+
+// NOTE: Only flush the page cache of the current processor.
 void pageCacheEntryFlush(U64 virt);
 void pageCacheFlush();
 
+// Flushes the entries on every processor that shares the address space. From
+// PAGE_CACHE_FLUSH_THRESHOLD entries on, the whole page cache is flushed
+// instead.
+void pageCacheEntriesShootdown(U64 *virts, U32 len);
+void pageCacheShootdown();
+
 // NOTE: c26 please consteva0 or smth
 
 #ifdef X86
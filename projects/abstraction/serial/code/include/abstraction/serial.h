@@ -5,4 +5,9 @@
 
 void serialFlush(U8_a buffer);
 
+// NOTE: For callers that have something better to do than spinning while the
+// port is busy, e.g., a coroutine that awaits serialReady before every byte.
+[[nodiscard]] bool serialReady();
+void serialByteSend(U8 byte);
+
 #endif
@@ -1,6 +1,40 @@
 #ifndef ABSTRACTION_THREAD_H
 #define ABSTRACTION_THREAD_H
 
+#include "shared/lock/spin.h"
+#include "shared/types/numeric.h"
+
 void threadHang();
+// Hint to the processor that this is a spin-wait loop.
+void spinWaitHint();
+
+// NOTE: Everything below is kernel only.
+
+typedef struct Thread Thread;
+typedef void (*ThreadFunction)(void *argument);
+
+// Turns the running code into the first thread of the current processor and
+// starts preempting it once other threads are runnable. Threads stay on the
+// processor that created them.
+void threadsInit();
+
+// The thread exits when the function returns.
+Thread *threadCreate(ThreadFunction function, void *argument);
+__attribute__((noreturn)) void threadExit();
+void threadYield();
+void threadSleep(U64 microSeconds);
+
+// Auto-resetting: a signal wakes a single waiter. Without waiters, the next
+// thread that waits passes straight through.
+typedef struct {
+    SpinLock lock;
+    bool signaled;
+    Thread *waitersHead;
+    Thread *waitersTail;
+} ThreadEvent;
+
+void threadEventInit(ThreadEvent *event);
+void threadEventWait(ThreadEvent *event);
+void threadEventSignal(ThreadEvent *event);
 
 #endif
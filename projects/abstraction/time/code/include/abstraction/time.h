@@ -8,6 +8,12 @@
                                       bool blocksSubsequent);
 void waitBlock(U64 microSeconds);
 
+// NOTE: Only accurate once the cycle counter frequency is known, which is the
+// case from the start of the kernel.
+[[nodiscard]] U64 cyclesToNanos(U64 cycles);
+// Nanoseconds since the cycle counter started counting.
+[[nodiscard]] U64 monotonicNanos();
+
 #define BENCHMARK(cycleCounter)                                                \
     for (U64 MACRO_VAR(i) = 0,                                                 \
              MACRO_VAR(startCycles) = cycleCounterGet(false, false);       \
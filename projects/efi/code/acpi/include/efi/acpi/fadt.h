@@ -0,0 +1,27 @@
+#ifndef EFI_ACPI_FADT_H
+#define EFI_ACPI_FADT_H
+
+#include "efi/acpi/rsdt.h"
+#include "shared/macros.h"
+#include "shared/types/numeric.h"
+
+static constexpr U8 FADT_SIGNATURE[ACPI_DESCRIPTION_TABLE_SIGNATURE_LEN] = {
+    'F', 'A', 'C', 'P'};
+
+// NOTE: Only the fields up to the flags, the rest is not used.
+typedef struct __attribute__((packed)) {
+    CAcpiDescriptionTableHeader header;
+    U8 reserved1[40];
+    U32 PMTimerBlock; // I/O port of the PM timer, 0 if there is none
+    U8 reserved2[32];
+    U32 flags;
+} CAcpiFADT;
+
+static_assert(OFFSETOF(CAcpiFADT, PMTimerBlock) == 76);
+static_assert(OFFSETOF(CAcpiFADT, flags) == 112);
+
+// NOTE: Without this flag, the PM timer only has 24 bits.
+static constexpr U32 FADT_PM_TIMER_32_BITS = (1 << 8);
+static constexpr auto PM_TIMER_FREQUENCY_HERTZ = 3579545;
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef EFI_ACPI_HPET_H
+#define EFI_ACPI_HPET_H
+
+#include "efi/acpi/rsdt.h"
+#include "shared/types/numeric.h"
+
+static constexpr U8 HPET_SIGNATURE[ACPI_DESCRIPTION_TABLE_SIGNATURE_LEN] = {
+    'H', 'P', 'E', 'T'};
+
+typedef enum : U8 {
+    ACPI_ADDRESS_SPACE_MEMORY = 0,
+    ACPI_ADDRESS_SPACE_IO = 1,
+} CAcpiAddressSpace;
+
+typedef struct __attribute__((packed)) {
+    CAcpiAddressSpace addressSpace;
+    U8 registerBitWidth;
+    U8 registerBitOffset;
+    U8 accessSize;
+    U64 address;
+} CAcpiGenericAddress;
+
+typedef struct __attribute__((packed)) {
+    CAcpiDescriptionTableHeader header;
+    U32 eventTimerBlockID;
+    CAcpiGenericAddress base;
+    U8 number;
+    U16 minimumTick;
+    U8 pageProtection;
+} CAcpiHPET;
+
+// NOTE: Offsets into the memory-mapped registers of the HPET.
+static constexpr auto HPET_CAPABILITIES_REGISTER = 0x0;
+static constexpr auto HPET_CONFIGURATION_REGISTER = 0x10;
+static constexpr auto HPET_MAIN_COUNTER_REGISTER = 0xF0;
+
+// The upper 32 bits of the capabilities are the tick period.
+static constexpr auto HPET_PERIOD_SHIFT = 32;
+static constexpr U64 HPET_CONFIGURATION_ENABLE = (1 << 0);
+static constexpr U64 FEMTOSECONDS_PER_SECOND = 1000000000000000;
+
+#endif
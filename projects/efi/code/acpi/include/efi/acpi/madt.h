@@ -1,21 +1,36 @@
 #ifndef EFI_ACPI_MADT_H
 #define EFI_ACPI_MADT_H
 
-#include "efi/acpi/c-acpi-rsdt.h"
+#include "efi/acpi/rsdt.h"
 #include "shared/types/numeric.h"
 
+static constexpr U8 MADT_SIGNATURE[ACPI_DESCRIPTION_TABLE_SIGNATURE_LEN] = {
+    'A', 'P', 'I', 'C'};
+
 typedef struct __attribute__((packed)) {
-    CAcpiSDT header;
+    CAcpiDescriptionTableHeader header;
     U32 localControllerAddress;
     U32 flags;
     I8 madtEntriesStart[];
 } CAcpiMADT;
 
+typedef enum : U8 {
+    MADT_LAPIC = 0,
+    MADT_IOAPIC = 1,
+    MADT_LAPIC_ADDRESS_OVERRIDE = 5,
+    MADT_X2APIC = 9,
+} CAcpiMADTType;
+
 typedef struct __attribute__((packed)) {
-    U8 type;
+    CAcpiMADTType type;
     U8 length;
 } CAcpiMADTHeader;
 
+// NOTE: Applies to both LAPIC and X2APIC entries. A processor that is neither
+// enabled nor online capable can not be started.
+static constexpr U32 MADT_PROCESSOR_ENABLED = (1 << 0);
+static constexpr U32 MADT_PROCESSOR_ONLINE_CAPABLE = (1 << 1);
+
 typedef struct __attribute__((packed)) {
     CAcpiMADTHeader header;
     U8 ACPIProcessorUID;
@@ -31,6 +46,12 @@ typedef struct __attribute__((packed)) {
     U32 ACPIProcessorUID;
 } CAcpiMADTX2APIC;
 
+typedef struct __attribute__((packed)) {
+    CAcpiMADTHeader header;
+    U16 reserved;
+    U64 address;
+} CAcpiMADTLAPICAddressOverride;
+
 typedef struct __attribute__((packed)) {
     U8 type;
     U8 length;
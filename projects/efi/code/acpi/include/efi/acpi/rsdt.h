@@ -1,6 +1,7 @@
 #ifndef EFI_ACPI_RSDT_H
 #define EFI_ACPI_RSDT_H
 
+#include "efi/acpi/rdsp.h"
 #include "shared/types/numeric.h"
 
 static constexpr auto ACPI_DESCRIPTION_TABLE_SIGNATURE_LEN = 4;
@@ -19,7 +20,13 @@ typedef struct __attribute__((packed)) {
 
 typedef struct __attribute__((packed)) {
     CAcpiDescriptionTableHeader header;
-    void **descriptionHeaders;
+    // NOTE: 4-byte entries for the RSDT, 8-byte entries for the XSDT.
+    U8 descriptionHeaders[];
 } CAcpiSDT;
 
+// Returns the description table with the signature that is pointed to by the
+// RSDT or XSDT of this RSDP, or nullptr if there is none.
+[[nodiscard]] CAcpiDescriptionTableHeader *descriptionTableFind(
+    RSDPResult rsdp, U8 signature[ACPI_DESCRIPTION_TABLE_SIGNATURE_LEN]);
+
 #endif
@@ -0,0 +1,43 @@
+#include "efi/acpi/rsdt.h"
+
+#include "abstraction/memory/manipulation.h" // for memcmp, memcpy
+#include "efi/acpi/rdsp.h"
+#include "shared/types/numeric.h"
+
+CAcpiDescriptionTableHeader *descriptionTableFind(
+    RSDPResult rsdp, U8 signature[ACPI_DESCRIPTION_TABLE_SIGNATURE_LEN]) {
+    CAcpiSDT *sdt;
+    U32 entrySize;
+    switch (rsdp.revision) {
+    case RSDP_REVISION_1: {
+        sdt = (CAcpiSDT *)(U64)rsdp.rsdp->v1.rsdt_addr;
+        entrySize = sizeof(U32);
+        break;
+    }
+    case RSDP_REVISION_2: {
+        sdt = (CAcpiSDT *)rsdp.rsdp->v2.xsdt_addr;
+        entrySize = sizeof(U64);
+        break;
+    }
+    default: {
+        return nullptr;
+    }
+    }
+
+    U32 entries = (sdt->header.length - sizeof(CAcpiSDT)) / entrySize;
+    for (typeof(entries) i = 0; i < entries; i++) {
+        // NOTE: Entries are not necessarily naturally aligned and the RSDT
+        // holds 32-bit addresses, so copy instead of dereferencing.
+        U64 address = 0;
+        memcpy(&address, &sdt->descriptionHeaders[i * entrySize], entrySize);
+
+        CAcpiDescriptionTableHeader *header =
+            (CAcpiDescriptionTableHeader *)address;
+        if (!memcmp(header->signature, signature,
+                    ACPI_DESCRIPTION_TABLE_SIGNATURE_LEN)) {
+            return header;
+        }
+    }
+
+    return nullptr;
+}
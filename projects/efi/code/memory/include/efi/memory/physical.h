@@ -37,6 +37,11 @@ alignedMemoryBlockAlloc(U64_pow2 bytes, U64_pow2 alignment, Arena scratch,
 [[nodiscard]] __attribute__((malloc, aligned(UEFI_PAGE_SIZE))) void *
 pagesAlloc(U64 bytes);
 
+// Allocates pages that end below addressEnd and that are kept out of the
+// kernel's physical memory, e.g., for code that has to run in real mode.
+[[nodiscard]] __attribute__((malloc, aligned(UEFI_PAGE_SIZE))) void *
+kernelPagesBelowAlloc(U64 bytes, U64 addressEnd);
+
 [[nodiscard]] U64 highestMemoryAddressFind(U64 currentHighestAddress,
                                            Arena scratch);
 
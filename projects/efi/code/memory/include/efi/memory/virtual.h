@@ -12,8 +12,11 @@ typedef struct {
     U64 stackVirtualTop;
     U64 virtualMemoryFirstAvailable;
 } StackResult;
+// Reserves stackSize bytes of virtual memory with a guard of the same size
+// below it. Only the top bytesBacked are backed by physical memory, the rest
+// is backed on demand once the kernel handles page faults.
 [[nodiscard]] StackResult stackCreateAndMap(U64 virtualMemoryFirstAvailable,
-                                            U64 stackSize,
+                                            U64 stackSize, U64 bytesBacked,
                                             bool attemptLargestMapping);
 
 #endif
@@ -153,6 +153,13 @@ static void addAddressToKernelStructure(U64 address, U64 bytes) {
     kernelStructureLocations.len++;
 }
 
+void *kernelPagesBelowAlloc(U64 bytes, U64 addressEnd) {
+    U64 address = addressEnd - 1;
+    pagesAllocAll(ALLOCATE_MAX_ADDRESS, bytes, &address);
+    addAddressToKernelStructure(address, alignUp(bytes, UEFI_PAGE_SIZE));
+    return (void *)address;
+}
+
 void *alignedMemoryBlockAlloc(U64_pow2 bytes, U64_pow2 alignment, Arena scratch,
                              bool attemptLargestMapping) {
     MemoryInfo memoryInfo = memoryInfoGet(&scratch);
@@ -55,30 +55,31 @@ U64 memoryMap(U64 virt, U64 physical, U64 bytes, U64 flags) {
 }
 
 StackResult stackCreateAndMap(U64 virtualMemoryFirstAvailable, U64 stackSize,
-                              bool attemptLargestMapping) {
+                              U64 bytesBacked, bool attemptLargestMapping) {
     U64 stackAddress =
-        (U64)alignedMemoryBlockAlloc(stackSize, KERNEL_STACK_ALIGNMENT,
+        (U64)alignedMemoryBlockAlloc(bytesBacked, KERNEL_STACK_ALIGNMENT,
                                     globals.uefiMemory, attemptLargestMapping);
 
     // NOTE: Overflow precaution
     virtualMemoryFirstAvailable += stackSize;
-    virtualMemoryFirstAvailable =
-        virtualAlign(virtualMemoryFirstAvailable, stackAddress, stackSize);
-    U64 stackGuardPageAddress = virtualMemoryFirstAvailable - stackSize;
+    U64 backedVirtualStart =
+        virtualAlign(virtualMemoryFirstAvailable + stackSize - bytesBacked,
+                     stackAddress, bytesBacked);
+    U64 stackVirtualStart = backedVirtualStart + bytesBacked - stackSize;
+    U64 stackGuardPageAddress = stackVirtualStart - stackSize;
     pageMappingAdd((Memory){.start = stackGuardPageAddress, .bytes = stackSize},
                    GUARD_PAGE_SIZE);
 
     KFLUSH_AFTER {
-        mappingVirtualGuardPageAppend(stackGuardPageAddress, KERNEL_STACK_SIZE);
+        mappingVirtualGuardPageAppend(stackGuardPageAddress, stackSize);
     }
 
-    U64 stackVirtualStart = virtualMemoryFirstAvailable;
     virtualMemoryFirstAvailable =
-        memoryMap(virtualMemoryFirstAvailable, stackAddress, stackSize,
+        memoryMap(backedVirtualStart, stackAddress, bytesBacked,
                   pageFlagsReadWrite() | pageFlagsNoCacheEvict());
 
     KFLUSH_AFTER {
-        mappingMemoryAppend(stackVirtualStart, stackAddress, stackSize);
+        mappingMemoryAppend(backedVirtualStart, stackAddress, bytesBacked);
     }
 
     return (StackResult){.stackVirtualTop = stackVirtualStart + stackSize,
@@ -1,11 +1,50 @@
 #ifndef FREESTANDING_LOG_INIT_H
 #define FREESTANDING_LOG_INIT_H
 
+#include "shared/lock/spin.h"
 #include "shared/memory/allocator/arena.h"
 #include "shared/types/array-types.h"
+#include "shared/types/numeric.h"
 
 extern U8_max_a loggingFlushBuffer;
 
+// What a flush does when the log ring has no room for the flushed bytes.
+typedef enum : U8 {
+    // Drains the ring on the flushing processor until there is room.
+    LOG_PRESSURE_BLOCK,
+    // Drops the flushed bytes, the drainer reports how many were dropped.
+    LOG_PRESSURE_DROP,
+} LogPressure;
+
+// Flushes copy their bytes into the ring as a record of a U64 header followed
+// by the data, padded to the next U64. Processors reserve their records with a
+// compare-and-swap on reserved and set the ready bit in the header once the
+// data is copied, so only the drainer, that writes to screen and serial, ever
+// waits on another processor.
+typedef struct {
+    U8 *buf;
+    U64_pow2 cap;
+    LogPressure pressure;
+    __attribute__((aligned(64))) U64 reserved;
+    // NOTE: On its own cache line, only the drainer writes it.
+    __attribute__((aligned(64))) U64 read;
+    U64 readOffset; // Bytes of the record at read that are written out
+    U64 dropped;
+    U64 droppedReported;
+    // NOTE: Held with interrupts disabled, so a processor never waits on a
+    // drain it interrupted itself.
+    SpinLock drainLock;
+} LogRing;
+
+extern LogRing logRing;
+
 void initLogger(Arena *perm);
+// Call after threadsInit. Before that, and whenever interrupts are disabled,
+// flushes write to screen and serial right away.
+void logDrainerStart();
+
+// Writes buffer to serial only, after everything that is in the ring and
+// without log output in between. For output that a host tool parses.
+void logSerialFlush(U8_a buffer);
 
 #endif
@@ -1,17 +1,36 @@
 #include "freestanding/log/init.h"
 
+#include "shared/lock/spin.h"
 #include "shared/memory/allocator/arena.h"
+#include "shared/memory/allocator/macros.h"
 #include "shared/memory/policy.h"
 #include "shared/memory/sizes.h"
 #include "shared/types/array-types.h"
 #include "shared/types/numeric.h"
 
 static constexpr auto FLUSH_BUFFER_SIZE = (2 * MiB);
+static constexpr U64_pow2 LOG_RING_SIZE = (1 * MiB);
 
 U8_max_a loggingFlushBuffer;
+LogRing logRing;
+
+static LockClass logDrainLockClass = LOCK_CLASS("log drain");
 
 void initLogger(Arena *perm) {
     loggingFlushBuffer.buf = NEW(perm, U8, .count = FLUSH_BUFFER_SIZE);
     loggingFlushBuffer.cap = FLUSH_BUFFER_SIZE;
     loggingFlushBuffer.len = 0;
+
+    // NOTE: The drainer stops at the first header without the ready bit, so
+    // the ring starts out zeroed and is zeroed again behind the drainer.
+    logRing.buf = NEW(perm, U8, .count = LOG_RING_SIZE, .align = alignof(U64),
+                      .flags = ALLOCATOR_ZERO_MEMORY);
+    logRing.cap = LOG_RING_SIZE;
+    logRing.pressure = LOG_PRESSURE_BLOCK;
+    logRing.reserved = 0;
+    logRing.read = 0;
+    logRing.readOffset = 0;
+    logRing.dropped = 0;
+    logRing.droppedReported = 0;
+    spinLockInit(&logRing.drainLock, &logDrainLockClass);
 }
@@ -1,32 +1,216 @@
 #include "abstraction/log.h"
 
+#include "abstraction/interrupts.h"
 #include "abstraction/serial.h"
+#include "abstraction/thread.h"
 #include "freestanding/log/init.h"
 #include "freestanding/memory/manipulation.h"
 #include "freestanding/peripheral/screen.h"
+#include "shared/lock/spin.h"
 #include "shared/log.h"
 #include "shared/maths.h"
 #include "shared/text/string.h"
 #include "shared/types/array-types.h" // for U8_a, uint8_max_a, U8_d_a
 #include "shared/types/numeric.h"
 
+static constexpr auto LOG_DRAIN_INTERVAL_MICROSECONDS = 10000;
+static constexpr auto LOG_HEADER_READY = 1;
+// NOTE: The drain lock, and with it interrupts, is held for at most this many
+// bytes of a record, see recordDrain.
+static constexpr auto LOG_DRAIN_BYTES_MAX = 256;
+
+static bool drainerRunning = false;
+
 // We are going to flush to:
 // - The in-memory standin file buffer, this will be replaced by a file
 // buffer in the future.
-void bufferFlush(U8_a *buffer, void *flushContext) {
-    (void)flushContext;
-
-    bufferToScreenFlush(*buffer);
+static void logOutput(U8_a buffer) {
+    bufferToScreenFlush(buffer);
 
 #ifdef SERIAL
-    serialFlush(*buffer);
+    serialFlush(buffer);
 #endif
 
     // TODO: Flush to file system here?
+}
+
+static U64 recordBytes(U64 len) {
+    return sizeof(U64) + alignUp(len, sizeof(U64));
+}
+
+static bool recordPublish(U8 *data, U64 len) {
+    U64 bytes = recordBytes(len);
+    U64 start = __atomic_load_n(&logRing.reserved, __ATOMIC_RELAXED);
+    do {
+        if (start + bytes - __atomic_load_n(&logRing.read, __ATOMIC_ACQUIRE) >
+            logRing.cap) {
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&logRing.reserved, &start,
+                                          start + bytes, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    // NOTE: The header is never split, the data may wrap around.
+    U64 dataStart = ringBufferIndex(start + sizeof(U64), logRing.cap);
+    U64 firstPart = MIN(len, logRing.cap - dataStart);
+    memcpy(&logRing.buf[dataStart], data, firstPart);
+    memcpy(logRing.buf, data + firstPart, len - firstPart);
+
+    __atomic_store_n(
+        (U64 *)&logRing.buf[ringBufferIndex(start, logRing.cap)],
+        (len << 1) | LOG_HEADER_READY, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Writes out the next LOG_DRAIN_BYTES_MAX bytes of the oldest record at most.
+// The record is only given back once all of it is written, whoever takes the
+// drain lock next writes its next piece, so records are not mixed in the
+// output. Returns false if there is no record ready.
+// NOTE: Call with the drain lock held.
+static bool recordDrain() {
+    U64 read = logRing.read;
+    U64 header =
+        __atomic_load_n((U64 *)&logRing.buf[ringBufferIndex(read, logRing.cap)],
+                        __ATOMIC_ACQUIRE);
+    if (!(header & LOG_HEADER_READY)) {
+        return false;
+    }
+
+    U64 len = header >> 1;
+    U64 piece = MIN(len - logRing.readOffset, LOG_DRAIN_BYTES_MAX);
+    U64 pieceStart = ringBufferIndex(read + sizeof(U64) + logRing.readOffset,
+                                     logRing.cap);
+    U64 firstPart = MIN(piece, logRing.cap - pieceStart);
+    logOutput((U8_a){.buf = &logRing.buf[pieceStart], .len = firstPart});
+    if (piece > firstPart) {
+        logOutput((U8_a){.buf = logRing.buf, .len = piece - firstPart});
+    }
+
+    logRing.readOffset += piece;
+    if (logRing.readOffset < len) {
+        return true;
+    }
+    logRing.readOffset = 0;
+
+    U64 bytes = recordBytes(len);
+    U64 recordStart = ringBufferIndex(read, logRing.cap);
+    U64 firstZeroed = MIN(bytes, logRing.cap - recordStart);
+    memset(&logRing.buf[recordStart], 0, firstZeroed);
+    memset(logRing.buf, 0, bytes - firstZeroed);
+
+    __atomic_store_n(&logRing.read, read + bytes, __ATOMIC_RELEASE);
+    return true;
+}
+
+// NOTE: Call with the drain lock held.
+static void droppedReport() {
+    U64 dropped = __atomic_load_n(&logRing.dropped, __ATOMIC_RELAXED);
+    if (dropped == logRing.droppedReported) {
+        return;
+    }
+
+    U8 lineBuffer[64];
+    U8_a line = {.buf = lineBuffer, .len = 0};
+    KLOG_APPEND(&line, STRING("Log dropped "));
+    KLOG_APPEND(&line, dropped - logRing.droppedReported);
+    KLOG_APPEND(&line, STRING(" bytes\n"));
+    logOutput(line);
+
+    logRing.droppedReported = dropped;
+}
+
+// Drains the ring one piece at a time and writes buffer with output once it is
+// empty, so buffer lands after everything that was flushed before it and not
+// inside a record.
+static void ringDrainThenOutput(U8_a buffer, void (*output)(U8_a buffer)) {
+    while (1) {
+        bool interruptsWereEnabled =
+            spinLockAcquireInterruptsDisable(&logRing.drainLock);
+        if (!recordDrain()) {
+            droppedReport();
+            output(buffer);
+            spinLockReleaseInterruptsRestore(&logRing.drainLock,
+                                             interruptsWereEnabled);
+            return;
+        }
+        spinLockReleaseInterruptsRestore(&logRing.drainLock,
+                                         interruptsWereEnabled);
+    }
+}
+
+// Records are at most a quarter of the ring, so a large flush does not have to
+// wait for the ring to be empty.
+static void ringPublish(U8 *data, U64 len) {
+    for (U64 written = 0; written < len;) {
+        U64 bytes = MIN(len - written, logRing.cap / 4);
+        while (!recordPublish(data + written, bytes)) {
+            if (logRing.pressure == LOG_PRESSURE_DROP) {
+                __atomic_fetch_add(&logRing.dropped, len - written,
+                                   __ATOMIC_RELAXED);
+                return;
+            }
+
+            bool interruptsWereEnabled =
+                spinLockAcquireInterruptsDisable(&logRing.drainLock);
+            if (!recordDrain()) {
+                droppedReport();
+            }
+            spinLockReleaseInterruptsRestore(&logRing.drainLock,
+                                             interruptsWereEnabled);
+            spinWaitHint();
+        }
+        written += bytes;
+    }
+}
+
+// Takes the drain lock for a single piece of a record at a time, so interrupts
+// are not disabled for the whole drain.
+static void logDrainer(void *argument) {
+    (void)argument;
+
+    while (1) {
+        for (bool drained = true; drained;) {
+            bool interruptsWereEnabled =
+                spinLockAcquireInterruptsDisable(&logRing.drainLock);
+            drained = recordDrain();
+            if (!drained) {
+                droppedReport();
+            }
+            spinLockReleaseInterruptsRestore(&logRing.drainLock,
+                                             interruptsWereEnabled);
+        }
+
+        threadSleep(LOG_DRAIN_INTERVAL_MICROSECONDS);
+    }
+}
+
+void logDrainerStart() {
+    threadCreate(logDrainer, nullptr);
+    __atomic_store_n(&drainerRunning, true, __ATOMIC_RELEASE);
+}
+
+// With interrupts disabled, we may be panicking and the drainer may never run
+// again, so the buffer is written out right away, after everything that is
+// still in the ring.
+void bufferFlush(U8_a *buffer, void *flushContext) {
+    (void)flushContext;
+
+    if (__atomic_load_n(&drainerRunning, __ATOMIC_ACQUIRE) &&
+        interruptsEnabled()) {
+        ringPublish(buffer->buf, buffer->len);
+    } else {
+        ringDrainThenOutput(*buffer, logOutput);
+    }
 
     buffer->len = 0;
 }
 
+#ifdef SERIAL
+void logSerialFlush(U8_a buffer) { ringDrainThenOutput(buffer, serialFlush); }
+#else
+void logSerialFlush(U8_a buffer) { (void)buffer; }
+#endif
+
 void standardBufferFlush() {
     bufferFlush((U8_a *)&loggingFlushBuffer, nullptr);
 }
@@ -1,7 +1,6 @@
 #include "abstraction/memory/virtual/allocator.h"
 #include "abstraction/interrupts.h"
 
-#include "abstraction/memory/manipulation.h"
 #include "abstraction/memory/virtual/map.h"
 #include "shared/maths.h"
 #include "shared/memory/converter.h"
@@ -12,11 +11,15 @@
 
 // NOTE: Don't cause page faults in this code. The code is called inside a page
 // fault. Any potential page faults must be anticipated and solved manually!
+// The page fault stub does not save the vector state either, so no memset.
 
 void *memoryZeroedForVirtualGet(VirtualAllocationType type) {
     U32 bytes = virtualStructBytes[type];
     void *result = identityMemoryAlloc(bytes);
-    memset(result, 0, bytes);
+    U64 *words = result;
+    for (U32 i = 0; i < bytes / sizeof(U64); i++) {
+        words[i] = 0;
+    }
 
     return result;
 }
@@ -11,5 +11,9 @@ void screenInit(Window *window, Arena *perm);
 void rewind(U16 numberOfScreenLines);
 void prowind(U16 numberOfScreenLines);
 void bufferToScreenFlush(U8_a buffer);
+// NOTE: Copies the whole backing buffer to the framebuffer and returns the
+// number of bytes written. Used to measure framebuffer throughput. The log
+// writes to the screen under its drain lock, so hold that lock around it.
+U64 screenBlit();
 
 #endif
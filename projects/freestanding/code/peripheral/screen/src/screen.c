@@ -2,6 +2,7 @@
 
 #include "freestanding/memory/manipulation.h"
 #include "shared/assert.h" // for ASSERT
+#include "shared/macros.h" // for COUNTOF
 #include "shared/maths.h"  // for RING_PLUS, RING_INCREMENT, RING_MINUS
 #include "shared/memory/allocator/macros.h"
 #include "shared/types/array-types.h" // for U8_a, uint8_max_a, U8_d_a
@@ -55,41 +56,143 @@ static constexpr auto HAXOR_WHITE = 0x00FFFFFF;
 
 static constexpr auto TAB_SIZE_IN_GLYPHS = (1 << 2);
 
-// NOTE: we write to this variable all the time, care should be taken when we
-// move to multithreading
+// NOTE: Only written by the log drain and screenBlit, both under the drain lock
+// of the log.
 static Screen dim;
 
 static U16 glyphsPerLine;
 static U16 glyphsPerColumn;
-static U32 maxGlyphsOnScreen;
-static U32 maxCharsToProcess;
 static U32 bytesPerGlyphLine;
 static U32 glyphStartOffset;
 static U32 glyphStartVerticalOffset;
 
-static U16 ringGlyphsPerLine;
-static U16 ringGlyphsPerColumn;
+// Every possible line of a glyph expanded to its pixels, so a glyph line is
+// drawn with a single copy instead of testing each bit. Glyph lines narrower
+// than a byte are shifted up so their first pixel is in the top bit.
+static U32 glyphLinePixels[1 << BITS_PER_BYTE][BITS_PER_BYTE];
+static U8 glyphLineShift;
 
-static constexpr auto MAX_SCROLLBACK_LINES = (1ULL << 13ULL);
 static constexpr auto FILE_BUF_LEN = (1ULL << 16ULL);
 
-static U32 *logicalLineLens;
-static U32 logicalLines[MAX_SCROLLBACK_LINES];
-static U32 logicalLineToWrite;
+// Every screen line that was ever written gets a number, counting up from 0.
+// The index stores where each screen line starts in buf and how long its
+// logical line already is at that point, which is needed to align tabs. It is
+// updated as characters are appended, so scrolling never has to rescan buf to
+// find out where lines wrap.
+//
+// The index starts with a screen full of empty screen lines, so the last
+// screen line is always shown at the bottom of the screen.
+static U32 *screenLineStarts;
+static U32 *screenLineLogicalLens;
+static U32 screenLinesTotal;
+// The oldest screen line of which all characters are still in buf, except for
+// the last screen line which is never dropped.
+static U32 oldestScreenLine;
+
+// The wrapping state at the end of buf.
+static U16 lastScreenLineGlyphs;
+static U32 lastLogicalLineLen;
 static bool logicalNewline;
-static U32 *screenLines;
-static U16 oldestScreenLineIndex;
-static U32 *screenLinesCopy;
+static bool lastScreenLineFull;
+
+// The screen lines that are shown, and the screen lines from firstScreenLine
+// up to drawnScreenLinesEnd that are drawn in their final form. The last
+// screen line can still grow, so it is never counted as final.
+static U32 firstScreenLine;
+static U32 drawnScreenLinesEnd;
+
+// The glyph rows of the backing buffer form a ring, firstGlyphRow is the glyph
+// row that is shown at the top of the screen. Scrolling only moves
+// firstGlyphRow and draws the new lines, the rows that stay on screen are not
+// touched.
+static U16 firstGlyphRow;
+static U32 glyphRowsPixelStart;
+static U32 glyphRowsPixelEnd;
+
+// The pixel rows of the screen that changed since the last time the backing
+// buffer was copied to it, the range is empty when start >= end.
+static U32 dirtyRowsStart;
+static U32 dirtyRowsEnd;
 
-static bool lastScreenlineOpen;
 static bool isTailing = true;
 static U32 charCount;
 static U32 nextCharInBuf;
 static U8 *buf;
 
-static void switchToScreenDisplay() {
-    memcpy(dim.window.pixels, dim.backingPixels,
-           dim.window.scanline * dim.window.height * BYTES_PER_PIXEL);
+static void rowsDirty(U32 row, U32 rows) {
+    dirtyRowsStart = MIN(dirtyRowsStart, row);
+    dirtyRowsEnd = MAX(dirtyRowsEnd, MIN(row + rows, dim.window.height));
+}
+
+static void glyphRowsDirty(U16 screenRow, U32 glyphRows) {
+    rowsDirty(glyphRowsPixelStart + screenRow * font->height,
+              glyphRows * font->height);
+}
+
+static void allRowsDirty() {
+    dirtyRowsStart = 0;
+    dirtyRowsEnd = dim.window.height;
+}
+
+static U32 glyphRowOffset(U16 screenRow) {
+    return glyphStartOffset +
+           ((U32)((firstGlyphRow + screenRow) % glyphsPerColumn) *
+            (dim.window.scanline * font->height));
+}
+
+static void glyphRowsScroll(I32 screenRows) {
+    firstGlyphRow =
+        (U16)((firstGlyphRow + glyphsPerColumn + screenRows) % glyphsPerColumn);
+    glyphRowsDirty(0, glyphsPerColumn);
+}
+
+// Pixel rows outside of the glyph rows are stored in the same place as on the
+// screen.
+static U32 backingRow(U32 screenRow) {
+    if (screenRow < glyphRowsPixelStart || screenRow >= glyphRowsPixelEnd) {
+        return screenRow;
+    }
+
+    return glyphRowsPixelStart +
+           ((screenRow - glyphRowsPixelStart + firstGlyphRow * font->height) %
+            (glyphRowsPixelEnd - glyphRowsPixelStart));
+}
+
+// NOTE: The framebuffer is mapped write-combining, so these stores already
+// bypass the cache the same way non-temporal stores would.
+static U64 switchToScreenDisplay() {
+    U64 bytes = 0;
+
+    // The screen row where the glyph ring wraps around to its first row.
+    U32 wrapRow = glyphRowsPixelEnd - firstGlyphRow * font->height;
+    for (U32 row = dirtyRowsStart; row < dirtyRowsEnd;) {
+        U32 segmentEnd = dirtyRowsEnd;
+        if (row < glyphRowsPixelStart) {
+            segmentEnd = MIN(segmentEnd, glyphRowsPixelStart);
+        } else if (row < wrapRow) {
+            segmentEnd = MIN(segmentEnd, wrapRow);
+        } else if (row < glyphRowsPixelEnd) {
+            segmentEnd = MIN(segmentEnd, glyphRowsPixelEnd);
+        }
+
+        U64 segmentBytes =
+            (U64)(segmentEnd - row) * dim.window.scanline * BYTES_PER_PIXEL;
+        memcpy(&dim.window.pixels[row * dim.window.scanline],
+               &dim.backingPixels[backingRow(row) * dim.window.scanline],
+               segmentBytes);
+
+        bytes += segmentBytes;
+        row = segmentEnd;
+    }
+
+    dirtyRowsStart = dim.window.height;
+    dirtyRowsEnd = 0;
+    return bytes;
+}
+
+U64 screenBlit() {
+    allRowsDirty();
+    return switchToScreenDisplay();
 }
 
 static void drawTerminalBox() {
@@ -114,6 +217,7 @@ static void drawTerminalBox() {
             HAXOR_GREEN;
     }
 
+    allRowsDirty();
     switchToScreenDisplay();
 }
 
@@ -121,28 +225,35 @@ static void drawGlyph(U8 ch, U32 topRightGlyphOffset) {
     U8 *glyphStart = &(font->glyphs[ch * font->bytesPerGlyph]);
     U32 glyphOffset = topRightGlyphOffset;
     for (typeof(font->height) y = 0; y < font->height; y++) {
-        // TODO: use SIMD instructions?
-        U32 line = glyphOffset;
-        U32 mask = 1 << (font->width - 1);
-        U8 glyphLine = *glyphStart;
         // NOTE: The important part is that the glyphLine captures the
         // whole of the line of the glyph, e.g., it covers one line of the glyph
         //
         // +----------+ +--+
         // 000001100000 0000
         // 000011110000 0000
-        ASSERT(font->width <= sizeof(glyphLine) * BITS_PER_BYTE);
-        for (typeof(font->width) x = 0; x < font->width; x++) {
-            dim.backingPixels[line] =
-                (((glyphLine) & (mask)) != 0) * HAXOR_WHITE;
-            mask >>= 1;
-            line++;
-        }
+        U8 glyphLine = (U8)(*glyphStart << glyphLineShift);
+        memcpy(&dim.backingPixels[glyphOffset], glyphLinePixels[glyphLine],
+               font->width * BYTES_PER_PIXEL);
         glyphStart += bytesPerGlyphLine;
         glyphOffset += dim.window.scanline;
     }
 }
 
+static void glyphLinePixelsInit() {
+    ASSERT(font->width <= BITS_PER_BYTE);
+    glyphLineShift = (U8)(BITS_PER_BYTE - font->width);
+
+    for (U32 glyphLine = 0; glyphLine < COUNTOF(glyphLinePixels);
+         glyphLine++) {
+        U32 mask = 1 << (BITS_PER_BYTE - 1);
+        for (U32 x = 0; x < BITS_PER_BYTE; x++) {
+            glyphLinePixels[glyphLine][x] =
+                ((glyphLine & mask) != 0) * HAXOR_WHITE;
+            mask >>= 1;
+        }
+    }
+}
+
 static void zeroOutGlyphs(U32 topRightGlyphOffset, U16 numberOfGlyphs) {
     for (typeof(font->height) i = 0; i < font->height; i++) {
         memset(&dim.backingPixels[topRightGlyphOffset], 0,
@@ -151,16 +262,34 @@ static void zeroOutGlyphs(U32 topRightGlyphOffset, U16 numberOfGlyphs) {
     }
 }
 
-static void drawLines(U32 startIndex, U16 screenLinesToDraw,
-                      U32 currentLogicalLineLen, U16 rowNumber) {
+static U32 screenLineStart(U32 screenLine) {
+    return screenLineStarts[ringBufferIndex(screenLine, FILE_BUF_LEN)];
+}
+
+static U32 screenLineEnd(U32 screenLine) {
+    if (screenLine + 1 < screenLinesTotal) {
+        return screenLineStart(screenLine + 1);
+    }
+    return charCount;
+}
+
+static void drawLines(U32 screenLine, U16 screenLinesToDraw, U16 rowNumber) {
+    if (!screenLinesToDraw) {
+        return;
+    }
+    glyphRowsDirty(rowNumber, screenLinesToDraw);
+
     U16 currentScreenLines = 0;
+    U32 currentLogicalLineLen =
+        screenLineLogicalLens[ringBufferIndex(screenLine, FILE_BUF_LEN)];
+    U32 endIndexExclusive = screenLineEnd(screenLine + screenLinesToDraw - 1);
 
-    U32 topRightGlyphOffset =
-        glyphStartOffset + (rowNumber * (dim.window.scanline * font->height));
+    U32 topRightGlyphOffset = glyphRowOffset(rowNumber);
     U16 currentGlyphLen = 0;
     bool toNext = false;
 
-    for (typeof(charCount) i = screenLines[startIndex]; i < charCount; i++) {
+    for (typeof(charCount) i = screenLineStart(screenLine);
+         i < endIndexExclusive; i++) {
         U8 ch = buf[ringBufferIndex(i, FILE_BUF_LEN)];
 
         if (toNext) {
@@ -172,8 +301,7 @@ static void drawLines(U32 startIndex, U16 screenLinesToDraw,
             zeroOutGlyphs(topRightGlyphOffset, glyphsPerLine - currentGlyphLen);
 
             topRightGlyphOffset =
-                glyphStartOffset + ((rowNumber + currentScreenLines) *
-                                    (dim.window.scanline * font->height));
+                glyphRowOffset((U16)(rowNumber + currentScreenLines));
             currentGlyphLen = 0;
             toNext = false;
         }
@@ -214,8 +342,7 @@ static void drawLines(U32 startIndex, U16 screenLinesToDraw,
                 }
 
                 topRightGlyphOffset =
-                    glyphStartOffset + ((rowNumber + currentScreenLines) *
-                                        (dim.window.scanline * font->height));
+                    glyphRowOffset((U16)(rowNumber + currentScreenLines));
                 currentGlyphLen = additionalSpace - extraSpacePreviousLine;
 
                 zeroOutGlyphs(topRightGlyphOffset, currentGlyphLen);
@@ -241,257 +368,108 @@ static void drawLines(U32 startIndex, U16 screenLinesToDraw,
     zeroOutGlyphs(topRightGlyphOffset, glyphsPerLine - currentGlyphLen);
 }
 
-typedef struct {
-    U16 realScreenLinesWritten;
-    U16 currentScreenLineIndex;
-    bool lastLineDone;
-} FillResult;
-
-static FillResult fillScreenLines(U32 dryStartIndex, U32 startIndex,
-                                  U32 endIndexExclusive,
-                                  U16 maxNewScreenLinesToFill) {
-    U16 currentScreenLineIndex = 0;
-    U16 screenLinesInWindow = dryStartIndex >= startIndex;
-
-    U16 currentGlyphLen = 0;
-    U32 currentLogicalLineLen = 0;
-
-    bool toNext = false;
-    // The parsing process is as follows:
-    // 1. An index is marked as a new screenline
-    // 2. The screenline is parsed.
-    // TODO: SIMD up in this bitch.
-    screenLinesCopy[currentScreenLineIndex] = dryStartIndex;
-    logicalLineLens[currentScreenLineIndex] = currentLogicalLineLen;
-
-    typeof(endIndexExclusive) i = dryStartIndex;
-    for (; i < endIndexExclusive; i++) {
-        U8 ch = buf[ringBufferIndex(i, FILE_BUF_LEN)];
-
-        if (toNext) {
-            if (maxNewScreenLinesToFill &&
-                screenLinesInWindow >= maxNewScreenLinesToFill) {
-                break;
-            }
-
-            currentScreenLineIndex = (U16)ringBufferIncrement(
-                currentScreenLineIndex, ringGlyphsPerColumn);
-            screenLinesCopy[currentScreenLineIndex] = i;
-            logicalLineLens[currentScreenLineIndex] = currentLogicalLineLen;
-
-            currentGlyphLen = 0;
-            screenLinesInWindow += (i >= startIndex);
-
-            toNext = false;
-        }
-
-        switch (ch) {
-        case '\0': {
-            break;
-        }
-        case '\n': {
-            toNext = true;
-            currentLogicalLineLen = 0;
-
-            break;
-        }
-        case '\t': {
-            U8 additionalSpace =
-                (U8)(((currentLogicalLineLen + TAB_SIZE_IN_GLYPHS) &
-                      (MAX_VALUE(additionalSpace) - (TAB_SIZE_IN_GLYPHS - 1))) -
-                     currentLogicalLineLen);
-            U16 finalSize = currentGlyphLen + additionalSpace;
-
-            if (finalSize <= glyphsPerLine) {
-                currentGlyphLen = finalSize;
-
-                toNext = (finalSize == glyphsPerLine &&
-                          buf[ringBufferIndex(i + 1, FILE_BUF_LEN)] != '\n');
-            } else {
-                // The tab overflows into the next screen line.
-                // We mark the current screen line as having the
-                // exclusive end index of the current tab. This
-                // is fine as the drawLines function will black
-                // out any remaining space in the screen line,
-                // the same as a space.
-                if (maxNewScreenLinesToFill &&
-                    screenLinesInWindow >= maxNewScreenLinesToFill) {
-                    break;
-                }
-
-                currentScreenLineIndex = (U16)ringBufferIncrement(
-                    currentScreenLineIndex, ringGlyphsPerColumn);
-                U8 extraSpacePreviousLine =
-                    (U8)(glyphsPerLine - currentGlyphLen);
-                // The tab is split up in 2 screen lines, so the
-                // tab we encounter on the new line should know
-                // that part of it is already drawn in the
-                // previous line.
-                currentGlyphLen = additionalSpace - extraSpacePreviousLine;
-                screenLinesCopy[currentScreenLineIndex] = i;
-                logicalLineLens[currentScreenLineIndex] =
-                    currentLogicalLineLen + extraSpacePreviousLine;
+// Shows the screen lines starting at newFirstScreenLine. The screen lines that
+// were already drawn and stay on screen are kept as they are, only the others
+// are drawn.
+static void screenLinesShow(U32 newFirstScreenLine) {
+    U32 windowEnd =
+        MIN(newFirstScreenLine + glyphsPerColumn, screenLinesTotal);
+
+    U32 keptStart = MAX(firstScreenLine, newFirstScreenLine);
+    U32 keptEnd = MIN(drawnScreenLinesEnd, windowEnd);
+    if (keptStart >= keptEnd) {
+        keptStart = windowEnd;
+        keptEnd = windowEnd;
+    }
 
-                screenLinesInWindow += (i >= startIndex);
-            }
-            currentLogicalLineLen += additionalSpace;
+    if (newFirstScreenLine != firstScreenLine) {
+        glyphRowsScroll(
+            (I32)(((I64)newFirstScreenLine - (I64)firstScreenLine) %
+                  glyphsPerColumn));
 
-            break;
-        }
-        default: {
-            currentGlyphLen++;
-            currentLogicalLineLen++;
-            if (currentGlyphLen >= glyphsPerLine &&
-                buf[ringBufferIndex(i + 1, FILE_BUF_LEN)] != '\n') {
-                toNext = true;
-            }
-            break;
-        }
+        // Only happens when the lines in buf do not fill the screen anymore,
+        // the rows below them can hold lines that were scrolled out.
+        for (U32 row = windowEnd - newFirstScreenLine; row < glyphsPerColumn;
+             row++) {
+            zeroOutGlyphs(glyphRowOffset((U16)row), glyphsPerLine);
         }
     }
+    firstScreenLine = newFirstScreenLine;
 
-    // Add entry indicating the end of the last actual screenline
-    currentScreenLineIndex =
-        (U16)ringBufferIncrement(currentScreenLineIndex, ringGlyphsPerColumn);
-    screenLinesCopy[currentScreenLineIndex] = i;
+    drawLines(newFirstScreenLine, (U16)(keptStart - newFirstScreenLine), 0);
+    drawLines(keptEnd, (U16)(windowEnd - keptEnd),
+              (U16)(keptEnd - newFirstScreenLine));
 
-    return (FillResult){.realScreenLinesWritten =
-                            MIN(screenLinesInWindow, glyphsPerColumn),
-                        .currentScreenLineIndex = currentScreenLineIndex,
-                        .lastLineDone = toNext};
-}
+    drawnScreenLinesEnd =
+        windowEnd == screenLinesTotal ? windowEnd - 1 : windowEnd;
 
-// A screenLine of 0 length still counts as a line.
-// For the observent, all our screenlines have a length > 0 except when they are
-// uninitialized, which is what the second operand of the addition handles
-static U32 toScreenLines(U32 number) {
-    return ((number > 0) * ((number + (glyphsPerLine - 1)) / glyphsPerLine)) +
-           (number == 0);
+    switchToScreenDisplay();
 }
 
-static U32 I8IndexToLogicalLine(U32 I8Index) {
-    if (I8Index >= logicalLines[logicalLineToWrite]) {
-        return logicalLineToWrite;
-    }
-
-    U32 right = logicalLineToWrite;
-    U32 left = (U32)ringBufferIncrement(right, MAX_SCROLLBACK_LINES);
-
-    while (ringBufferMinus(right, left, MAX_SCROLLBACK_LINES) > 1) {
-        U32 mid = (U32)ringBufferPlus(
-            left, ((U32)ringBufferMinus(right, left, MAX_SCROLLBACK_LINES) / 2),
-            MAX_SCROLLBACK_LINES);
+static void toTail() {
+    screenLinesShow(MAX(screenLinesTotal - glyphsPerColumn, oldestScreenLine));
+}
 
-        if (logicalLines[mid] > I8Index) {
-            right = mid;
-        } else {
-            left = mid;
-        }
+static void screenLineAdd(U32 start, U32 logicalLineLen) {
+    if (screenLinesTotal - oldestScreenLine == FILE_BUF_LEN) {
+        oldestScreenLine++;
     }
 
-    return left;
+    U32 index = (U32)ringBufferIndex(screenLinesTotal, FILE_BUF_LEN);
+    screenLineStarts[index] = start;
+    screenLineLogicalLens[index] = logicalLineLen;
+    screenLinesTotal++;
 }
 
-static U32 oldestCharToParseGivenScreenLines(U32 endCharExclusive,
-                                             U16 screenLinesToProcess) {
-    U32 oldestLogicalLineIndex =
-        (U32)ringBufferIncrement(logicalLineToWrite, MAX_SCROLLBACK_LINES);
-
-    U32 logicalLineIndex = I8IndexToLogicalLine(endCharExclusive);
-    if (logicalLineIndex == oldestLogicalLineIndex &&
-        logicalLines[logicalLineIndex] >= endCharExclusive) {
-        return endCharExclusive;
+// Follows the same wrapping rules as drawLines. Whether a full screen line
+// continues on the next screen line is only known once the next character
+// comes in, a newline still fits on the full screen line.
+static void screenLineIndexUpdate(U8 ch, U32 index) {
+    if (logicalNewline || (lastScreenLineFull && ch != '\n')) {
+        screenLineAdd(index, lastLogicalLineLen);
+        lastScreenLineGlyphs = 0;
     }
+    logicalNewline = false;
+    lastScreenLineFull = false;
 
-    if (logicalLines[logicalLineIndex] == endCharExclusive) {
-        logicalLineIndex =
-            (U32)ringBufferDecrement(logicalLineIndex, MAX_SCROLLBACK_LINES);
+    switch (ch) {
+    case '\0': {
+        break;
     }
-
-    U32 screenLinesProcessed =
-        toScreenLines(endCharExclusive - logicalLines[logicalLineIndex]);
-
-    while (screenLinesProcessed < screenLinesToProcess &&
-           logicalLineIndex != oldestLogicalLineIndex) {
-        screenLinesProcessed +=
-            toScreenLines(logicalLines[logicalLineIndex] -
-                          logicalLines[ringBufferDecrement(
-                              logicalLineIndex, MAX_SCROLLBACK_LINES)]);
-
-        logicalLineIndex =
-            (U32)ringBufferDecrement(logicalLineIndex, MAX_SCROLLBACK_LINES);
+    case '\n': {
+        logicalNewline = true;
+        lastLogicalLineLen = 0;
+        break;
     }
+    case '\t': {
+        U8 additionalSpace =
+            (U8)(((lastLogicalLineLen + TAB_SIZE_IN_GLYPHS) &
+                  (MAX_VALUE(additionalSpace) - (TAB_SIZE_IN_GLYPHS - 1))) -
+                 lastLogicalLineLen);
+        U16 finalSize = lastScreenLineGlyphs + additionalSpace;
+
+        if (finalSize <= glyphsPerLine) {
+            lastScreenLineGlyphs = finalSize;
+            lastScreenLineFull = finalSize == glyphsPerLine;
+        } else {
+            // The tab overflows into the next screen line, which starts at
+            // the tab and knows that part of it is on the previous line.
+            U8 extraSpacePreviousLine =
+                (U8)(glyphsPerLine - lastScreenLineGlyphs);
+            screenLineAdd(index, lastLogicalLineLen + extraSpacePreviousLine);
+            lastScreenLineGlyphs = additionalSpace - extraSpacePreviousLine;
+        }
+        lastLogicalLineLen += additionalSpace;
 
-    U32 oldestCharToProcess = logicalLines[logicalLineIndex];
-
-    if (endCharExclusive - oldestCharToProcess > maxCharsToProcess) {
-        oldestCharToProcess = endCharExclusive - maxCharsToProcess;
+        break;
     }
-
-    return oldestCharToProcess;
-}
-
-static void toTail() {
-    U16 finalScreenLineEntry = (U16)ringBufferPlus(
-        oldestScreenLineIndex, glyphsPerColumn - lastScreenlineOpen,
-        ringGlyphsPerColumn);
-    U32 firstCharOutsideWindow = screenLines[finalScreenLineEntry];
-    while (firstCharOutsideWindow <= screenLines[oldestScreenLineIndex] &&
-           finalScreenLineEntry != oldestScreenLineIndex) {
-        finalScreenLineEntry =
-            (U16)ringBufferDecrement(finalScreenLineEntry, ringGlyphsPerColumn);
-        firstCharOutsideWindow = screenLines[finalScreenLineEntry];
+    default: {
+        lastScreenLineGlyphs++;
+        lastLogicalLineLen++;
+        lastScreenLineFull = lastScreenLineGlyphs >= glyphsPerLine;
+        break;
     }
-    U32 oldestCharToProcess =
-        MAX(oldestCharToParseGivenScreenLines(charCount, glyphsPerColumn),
-            logicalLines[I8IndexToLogicalLine(firstCharOutsideWindow)]);
-
-    FillResult fillResult = fillScreenLines(
-        oldestCharToProcess, firstCharOutsideWindow, charCount, 0);
-
-    U16 startIndex = (U16)ringBufferMinus(fillResult.currentScreenLineIndex,
-                                          fillResult.realScreenLinesWritten,
-                                          ringGlyphsPerColumn);
-
-    U16 oldScreenLines = glyphsPerColumn - fillResult.realScreenLinesWritten;
-    // You can write 10 new screen lines while your screen originally
-    // displayed the first 40 screen lines, hence the distinction here.
-    U16 originalScreenLines = (U16)ringBufferMinus(
-        finalScreenLineEntry, oldestScreenLineIndex, ringGlyphsPerColumn);
-
-    U16 totalLines = fillResult.realScreenLinesWritten + originalScreenLines;
-    if (totalLines > glyphsPerColumn) {
-        oldestScreenLineIndex = (U16)ringBufferPlus(
-            oldestScreenLineIndex, totalLines - glyphsPerColumn,
-            ringGlyphsPerColumn);
     }
-
-    for (typeof(fillResult.realScreenLinesWritten) i = 0;
-         i <= fillResult.realScreenLinesWritten; i++) {
-        screenLines[ringBufferPlus(oldestScreenLineIndex + oldScreenLines, i,
-                                   ringGlyphsPerColumn)] =
-            screenLinesCopy[ringBufferPlus(startIndex, i, ringGlyphsPerColumn)];
-    }
-
-    if (fillResult.realScreenLinesWritten < glyphsPerColumn) {
-        U32 fromOffset =
-            glyphStartVerticalOffset +
-            (fillResult.realScreenLinesWritten - lastScreenlineOpen) *
-                (dim.window.scanline * font->height);
-
-        memmove(&dim.backingPixels[glyphStartVerticalOffset],
-                &dim.backingPixels[fromOffset],
-                oldScreenLines * (dim.window.scanline * font->height * 4));
-    }
-
-    U16 drawLineStartIndex = (U16)ringBufferPlus(
-        oldestScreenLineIndex, oldScreenLines, ringGlyphsPerColumn);
-    drawLines(drawLineStartIndex, fillResult.realScreenLinesWritten,
-              logicalLineLens[startIndex], oldScreenLines);
-
-    lastScreenlineOpen = !fillResult.lastLineDone;
-
-    switchToScreenDisplay();
 }
 
 void bufferToScreenFlush(U8_a buffer) {
@@ -500,29 +478,19 @@ void bufferToScreenFlush(U8_a buffer) {
         startIndex = buffer.len - FILE_BUF_LEN;
     }
 
-    // TODO: I think we can memcpy this all, and then
-    // TODO: SIMD up in this birch.
     for (typeof(buffer.len) i = startIndex; i < buffer.len; i++) {
-        buf[nextCharInBuf] = buffer.buf[i];
-
-        if (logicalNewline) {
-            logicalLineToWrite = (U32)ringBufferIncrement(logicalLineToWrite,
-                                                          MAX_SCROLLBACK_LINES);
-
-            logicalLines[logicalLineToWrite] = charCount;
-            logicalNewline = false;
+        // Drop the screen lines whose first character is about to be
+        // overwritten.
+        if (charCount >= FILE_BUF_LEN) {
+            while (oldestScreenLine + 1 < screenLinesTotal &&
+                   screenLineStart(oldestScreenLine) <=
+                       charCount - FILE_BUF_LEN) {
+                oldestScreenLine++;
+            }
         }
 
-        U8 ch = buf[nextCharInBuf];
-        switch (ch) {
-        case '\n': {
-            logicalNewline = true;
-            break;
-        }
-        default: {
-            break;
-        }
-        }
+        buf[nextCharInBuf] = buffer.buf[i];
+        screenLineIndexUpdate(buffer.buf[i], charCount);
 
         nextCharInBuf = (U32)ringBufferIncrement(nextCharInBuf, FILE_BUF_LEN);
         charCount++;
@@ -551,138 +519,50 @@ void screenInit(Window *window, Arena *perm) {
     glyphsPerColumn =
         (U16)(dim.window.height - VERTICAL_PIXEL_MARGIN * 2) / (font->height);
 
-    ringGlyphsPerLine = (U16)ceilingPowerOf2(glyphsPerLine);
-    ringGlyphsPerColumn = (U16)ceilingPowerOf2((glyphsPerColumn + 1));
-    if (glyphsPerColumn == ringGlyphsPerColumn) {
-        // Need to make screenLinesCopy a power of 2 larger because of
-        // implementation.
-        ringGlyphsPerColumn <<= 1;
-    }
-    screenLines =
-        NEW(perm, U32, .count = ringGlyphsPerColumn, .flags = ALLOCATOR_ZERO_MEMORY);
-    logicalLineLens =
-        NEW(perm, U32, .count = ringGlyphsPerColumn, .flags = ALLOCATOR_ZERO_MEMORY);
-    screenLinesCopy =
-        NEW(perm, U32, .count = ringGlyphsPerColumn, .flags = ALLOCATOR_ZERO_MEMORY);
-
-    maxGlyphsOnScreen = glyphsPerLine * glyphsPerColumn;
-    maxCharsToProcess = 2 * maxGlyphsOnScreen;
+    screenLineStarts = NEW(perm, U32, .count = FILE_BUF_LEN,
+                           .flags = ALLOCATOR_ZERO_MEMORY);
+    screenLineLogicalLens = NEW(perm, U32, .count = FILE_BUF_LEN,
+                                .flags = ALLOCATOR_ZERO_MEMORY);
+    screenLinesTotal = glyphsPerColumn;
+    drawnScreenLinesEnd = glyphsPerColumn - 1;
+
     glyphStartVerticalOffset = dim.window.scanline * VERTICAL_PIXEL_MARGIN;
+    glyphRowsPixelStart = VERTICAL_PIXEL_MARGIN;
+    glyphRowsPixelEnd = glyphRowsPixelStart + glyphsPerColumn * font->height;
     glyphStartOffset = glyphStartVerticalOffset + HORIZONTAL_PIXEL_MARGIN;
     bytesPerGlyphLine = (U32)ceilingDivide(font->width, BITS_PER_BYTE);
 
-    ASSERT(maxCharsToProcess <= FILE_BUF_LEN);
-
+    glyphLinePixelsInit();
     drawTerminalBox();
 }
 
-static bool isWindowSmallerThanScreen() {
-    return screenLines[oldestScreenLineIndex] >=
-           screenLines[ringBufferPlus(oldestScreenLineIndex, glyphsPerColumn,
-                                      ringGlyphsPerColumn)];
-}
-
 void rewind(U16 numberOfScreenLines) {
-    if (isWindowSmallerThanScreen()) {
-        return;
+    // Rewinding stops once the first line of text is at the top of the screen,
+    // the empty screen lines the index started with are never shown again.
+    U32 oldestFirstScreenLine =
+        MAX(oldestScreenLine, (U32)(glyphsPerColumn - 1));
+    U32 newFirstScreenLine = oldestFirstScreenLine;
+    if (firstScreenLine > oldestFirstScreenLine + numberOfScreenLines) {
+        newFirstScreenLine = firstScreenLine - numberOfScreenLines;
     }
 
-    U32 currentOldestCharInWindow = screenLines[oldestScreenLineIndex];
-    U32 oldestCharToProcess = oldestCharToParseGivenScreenLines(
-        currentOldestCharInWindow, numberOfScreenLines);
-
-    if (oldestCharToProcess == currentOldestCharInWindow) {
+    if (newFirstScreenLine >= firstScreenLine) {
         return;
     }
 
-    FillResult fillResult = fillScreenLines(
-        oldestCharToProcess, oldestCharToProcess, currentOldestCharInWindow, 0);
-
-    U16 newScreenLinesOnTop =
-        MIN(fillResult.realScreenLinesWritten, numberOfScreenLines);
-
-    U16 startIndex =
-        (U16)ringBufferMinus(fillResult.currentScreenLineIndex,
-                             newScreenLinesOnTop, ringGlyphsPerColumn);
-
-    oldestScreenLineIndex = (U16)ringBufferMinus(
-        oldestScreenLineIndex, newScreenLinesOnTop, ringGlyphsPerColumn);
-
-    for (typeof(newScreenLinesOnTop) i = 0; i < newScreenLinesOnTop; i++) {
-        screenLines[ringBufferPlus(oldestScreenLineIndex, i,
-                                   ringGlyphsPerColumn)] =
-            screenLinesCopy[ringBufferPlus(startIndex, i, ringGlyphsPerColumn)];
-    }
-
-    U32 fromOffset = glyphStartVerticalOffset +
-                     newScreenLinesOnTop * (dim.window.scanline * font->height);
-
-    memmove(&dim.backingPixels[fromOffset],
-            &dim.backingPixels[glyphStartVerticalOffset],
-            (glyphsPerColumn - newScreenLinesOnTop) *
-                (dim.window.scanline * font->height * 4));
-
-    drawLines(oldestScreenLineIndex, newScreenLinesOnTop,
-              logicalLineLens[startIndex], 0);
-
     isTailing = false;
-    lastScreenlineOpen = false;
-
-    switchToScreenDisplay();
+    screenLinesShow(newFirstScreenLine);
 }
 
 void prowind(U16 numberOfScreenLines) {
-    if (isWindowSmallerThanScreen()) {
-        return;
-    }
-
-    U32 firstCharOutsideWindow = screenLines[ringBufferPlus(
-        oldestScreenLineIndex, glyphsPerColumn, ringGlyphsPerColumn)];
-
-    if (charCount == firstCharOutsideWindow) {
+    if (firstScreenLine + glyphsPerColumn >= screenLinesTotal) {
         return;
     }
 
-    U32 oldestCharToProcess =
-        oldestCharToParseGivenScreenLines(firstCharOutsideWindow, 0);
+    U32 newFirstScreenLine =
+        MIN(firstScreenLine + numberOfScreenLines,
+            screenLinesTotal - glyphsPerColumn);
 
-    FillResult fillResult =
-        fillScreenLines(oldestCharToProcess, firstCharOutsideWindow, charCount,
-                        numberOfScreenLines);
-    U16 oldScreenLines = glyphsPerColumn - fillResult.realScreenLinesWritten;
-
-    U16 startIndex = (U16)ringBufferMinus(fillResult.currentScreenLineIndex,
-                                          fillResult.realScreenLinesWritten,
-                                          ringGlyphsPerColumn);
-
-    oldestScreenLineIndex = (U16)ringBufferPlus(
-        oldestScreenLineIndex, fillResult.realScreenLinesWritten,
-        ringGlyphsPerColumn);
-
-    for (typeof(fillResult.realScreenLinesWritten) i = 0;
-         i <= fillResult.realScreenLinesWritten; i++) {
-        screenLines[ringBufferPlus(oldestScreenLineIndex + oldScreenLines, i,
-                                   ringGlyphsPerColumn)] =
-            screenLinesCopy[ringBufferPlus(startIndex, i, ringGlyphsPerColumn)];
-    }
-
-    U32 fromOffset =
-        glyphStartVerticalOffset + fillResult.realScreenLinesWritten *
-                                       (dim.window.scanline * font->height);
-
-    memmove(&dim.backingPixels[glyphStartVerticalOffset],
-            &dim.backingPixels[fromOffset],
-            oldScreenLines * (dim.window.scanline * font->height * 4));
-
-    U16 drawLineStartIndex = (U16)ringBufferPlus(
-        oldestScreenLineIndex, oldScreenLines, ringGlyphsPerColumn);
-    drawLines(drawLineStartIndex, fillResult.realScreenLinesWritten,
-              logicalLineLens[startIndex], oldScreenLines);
-
-    isTailing =
-        screenLines[ringBufferPlus(oldestScreenLineIndex, glyphsPerColumn,
-                                   ringGlyphsPerColumn)] == charCount;
-    lastScreenlineOpen = !fillResult.lastLineDone;
-
-    switchToScreenDisplay();
+    isTailing = newFirstScreenLine + glyphsPerColumn >= screenLinesTotal;
+    screenLinesShow(newFirstScreenLine);
 }
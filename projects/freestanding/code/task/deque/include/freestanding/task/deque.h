@@ -0,0 +1,27 @@
+#ifndef FREESTANDING_TASK_DEQUE_H
+#define FREESTANDING_TASK_DEQUE_H
+
+#include "freestanding/task.h"
+#include "shared/types/numeric.h"
+
+// Chase-Lev deque with a fixed capacity. The owner pushes and pops at the
+// bottom without contention, only the last task is raced for with thieves that
+// take from the top.
+typedef struct __attribute__((aligned(64))) {
+    I64 top;
+    // NOTE: On its own cache line, it is written on every push and pop.
+    __attribute__((aligned(64))) I64 bottom;
+    Task *tasks[TASK_DEQUE_CAPACITY];
+} TaskDeque;
+
+void taskDequeInit(TaskDeque *deque);
+
+// NOTE: Only the owner of the deque may push and pop. Returns false if the
+// deque is full.
+[[nodiscard]] bool taskPush(TaskDeque *deque, Task *task);
+[[nodiscard]] Task *taskPop(TaskDeque *deque);
+// Can be called by any processor. Returns nullptr if the deque is empty or
+// the task was taken by someone else first.
+[[nodiscard]] Task *taskSteal(TaskDeque *deque);
+
+#endif
@@ -0,0 +1,64 @@
+#include "freestanding/task/deque.h"
+
+void taskDequeInit(TaskDeque *deque) {
+    deque->top = 0;
+    deque->bottom = 0;
+}
+
+bool taskPush(TaskDeque *deque, Task *task) {
+    I64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    I64 top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    if (bottom - top >= TASK_DEQUE_CAPACITY) {
+        return false;
+    }
+
+    __atomic_store_n(&deque->tasks[bottom & (TASK_DEQUE_CAPACITY - 1)], task,
+                     __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+Task *taskPop(TaskDeque *deque) {
+    I64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    I64 top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+    if (top > bottom) {
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return nullptr;
+    }
+
+    Task *task = __atomic_load_n(
+        &deque->tasks[bottom & (TASK_DEQUE_CAPACITY - 1)], __ATOMIC_RELAXED);
+    if (top == bottom) {
+        // NOTE: The last task, a thief may be taking it at the same time.
+        if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false,
+                                         __ATOMIC_SEQ_CST,
+                                         __ATOMIC_RELAXED)) {
+            task = nullptr;
+        }
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+
+    return task;
+}
+
+Task *taskSteal(TaskDeque *deque) {
+    I64 top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    I64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+    if (top >= bottom) {
+        return nullptr;
+    }
+
+    Task *task = __atomic_load_n(
+        &deque->tasks[top & (TASK_DEQUE_CAPACITY - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return nullptr;
+    }
+
+    return task;
+}
@@ -0,0 +1,193 @@
+#include "abstraction/jmp.h"
+#include "abstraction/log.h"
+#include "freestanding/task.h"
+#include "freestanding/task/deque.h"
+#include "posix/log.h"
+#include "posix/test-framework/test.h"
+#include "shared/log.h"
+#include "shared/macros.h"
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+
+#include <pthread.h>
+
+static constexpr auto THIEVES = 3;
+static constexpr auto TASKS = 1000000;
+
+static TaskDeque deque;
+static Task tasks[TASK_DEQUE_CAPACITY + 1];
+
+static void taskEqual(Task *expected, Task *actual) {
+    if (expected != actual) {
+        TEST_FAILURE {
+            INFO(STRING("Took the wrong task\n"));
+            INFO(STRING("Expected: "));
+            INFO((void *)expected, .flags = NEWLINE);
+            INFO(STRING("Actual: "));
+            INFO((void *)actual, .flags = NEWLINE);
+        }
+    }
+}
+
+static void testPopOrder() {
+    taskDequeInit(&deque);
+    for (U32 i = 0; i < 3; i++) {
+        (void)taskPush(&deque, &tasks[i]);
+    }
+
+    for (U32 i = 3; i > 0; i--) {
+        taskEqual(&tasks[i - 1], taskPop(&deque));
+    }
+    taskEqual(nullptr, taskPop(&deque));
+
+    testSuccess();
+}
+
+static void testStealOrder() {
+    taskDequeInit(&deque);
+    for (U32 i = 0; i < 3; i++) {
+        (void)taskPush(&deque, &tasks[i]);
+    }
+
+    taskEqual(&tasks[0], taskSteal(&deque));
+    taskEqual(&tasks[2], taskPop(&deque));
+    taskEqual(&tasks[1], taskSteal(&deque));
+    taskEqual(nullptr, taskSteal(&deque));
+    taskEqual(nullptr, taskPop(&deque));
+
+    testSuccess();
+}
+
+static void testFull() {
+    taskDequeInit(&deque);
+    for (U32 i = 0; i < TASK_DEQUE_CAPACITY; i++) {
+        if (!taskPush(&deque, &tasks[i])) {
+            TEST_FAILURE {
+                INFO(STRING("Deque is full after "));
+                INFO(i);
+                INFO(STRING(" tasks\n"));
+            }
+        }
+    }
+    if (taskPush(&deque, &tasks[TASK_DEQUE_CAPACITY])) {
+        TEST_FAILURE { INFO(STRING("Pushed onto a full deque\n")); }
+    }
+
+    // NOTE: A steal makes room at the top, the indices wrap around.
+    taskEqual(&tasks[0], taskSteal(&deque));
+    if (!taskPush(&deque, &tasks[TASK_DEQUE_CAPACITY])) {
+        TEST_FAILURE { INFO(STRING("No room after a steal\n")); }
+    }
+    taskEqual(&tasks[TASK_DEQUE_CAPACITY], taskPop(&deque));
+
+    testSuccess();
+}
+
+// NOTE: The tasks are only used as tokens, every one must be taken exactly
+// once by either the owner or one of the thieves.
+static U8 taken[TASKS];
+static Task tokens[TASKS];
+static bool pushingDone;
+
+static void tokenTake(Task *task) {
+    __atomic_fetch_add(&taken[task - tokens], 1, __ATOMIC_RELAXED);
+}
+
+static void *thiefRun(void *argument) {
+    (void)argument;
+    while (1) {
+        Task *task = taskSteal(&deque);
+        if (task) {
+            tokenTake(task);
+            continue;
+        }
+        if (__atomic_load_n(&pushingDone, __ATOMIC_ACQUIRE) &&
+            __atomic_load_n(&deque.top, __ATOMIC_ACQUIRE) >=
+                __atomic_load_n(&deque.bottom, __ATOMIC_ACQUIRE)) {
+            return nullptr;
+        }
+    }
+}
+
+static void testConcurrentSteals() {
+    taskDequeInit(&deque);
+    pushingDone = false;
+
+    pthread_t thieves[THIEVES];
+    for (U32 i = 0; i < THIEVES; i++) {
+        if (pthread_create(&thieves[i], nullptr, thiefRun, nullptr)) {
+            TEST_FAILURE { INFO(STRING("Could not create thread\n")); }
+        }
+    }
+
+    // NOTE: The owner pops every other task itself, so it races the thieves
+    // for the last task as well.
+    for (U32 i = 0; i < TASKS; i++) {
+        while (!taskPush(&deque, &tokens[i])) {
+            Task *task = taskPop(&deque);
+            if (task) {
+                tokenTake(task);
+            }
+        }
+        if (i % 2) {
+            Task *task = taskPop(&deque);
+            if (task) {
+                tokenTake(task);
+            }
+        }
+    }
+    for (Task *task = taskPop(&deque); task; task = taskPop(&deque)) {
+        tokenTake(task);
+    }
+    __atomic_store_n(&pushingDone, true, __ATOMIC_RELEASE);
+
+    for (U32 i = 0; i < THIEVES; i++) {
+        pthread_join(thieves[i], nullptr);
+    }
+
+    for (U32 i = 0; i < TASKS; i++) {
+        if (taken[i] != 1) {
+            TEST_FAILURE {
+                INFO(STRING("Task "));
+                INFO(i);
+                INFO(STRING(" was taken "));
+                INFO(taken[i]);
+                INFO(STRING(" times\n"));
+            }
+        }
+    }
+
+    testSuccess();
+}
+
+static void testDeque() {
+    TEST_TOPIC(STRING("Single processor")) {
+        JumpBuffer failureHandler;
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Pop order"), failureHandler) { testPopOrder(); }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Steal order"), failureHandler) { testStealOrder(); }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Full"), failureHandler) { testFull(); }
+        }
+    }
+
+    TEST_TOPIC(STRING("Multiple processors")) {
+        JumpBuffer failureHandler;
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Concurrent steals"), failureHandler) {
+                testConcurrentSteals();
+            }
+        }
+    }
+}
+
+int main() {
+    testSuiteStart(STRING("Task Deque"));
+
+    testDeque();
+
+    return testSuiteFinish();
+}
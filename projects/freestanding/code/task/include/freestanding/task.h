@@ -0,0 +1,45 @@
+#ifndef FREESTANDING_TASK_H
+#define FREESTANDING_TASK_H
+
+#include "shared/types/numeric.h"
+
+// Every processor has its own deque of tasks. It pushes and pops at the
+// bottom, so it works depth-first on its own tasks, while idle processors
+// steal from the top, i.e., the oldest and usually largest tasks.
+
+typedef void (*TaskFunction)(void *argument);
+
+// Counts the spawned tasks that did not finish yet.
+typedef struct {
+    U32 pending;
+} TaskGroup;
+
+// NOTE: Must stay alive until its group was waited on, putting both on the
+// stack of the spawning function is the intended use.
+typedef struct {
+    TaskFunction function;
+    void *argument;
+    TaskGroup *group;
+} Task;
+
+static constexpr auto TASK_DEQUE_CAPACITY = 256;
+
+// Hands the processors that are not the current one a worker loop that never
+// returns, so they take no other processor work after this. Processors without
+// tasks sleep until new ones are spawned.
+void tasksInit(U32 processorsCount);
+
+// Can be called from any task, the task may already run on another processor
+// by the time this returns. If the deque is full, the task runs right away.
+void taskSpawn(TaskGroup *group, Task *task);
+// Runs other tasks while waiting, so the current processor stays busy.
+void taskGroupWait(TaskGroup *group);
+
+typedef void (*ParallelForFunction)(U64 start, U64 end, void *argument);
+
+// Calls function on disjoint subranges of [start, end) that are at most grain
+// long, in parallel. Returns once all of them are done.
+void taskParallelFor(U64 start, U64 end, U64 grain,
+                     ParallelForFunction function, void *argument);
+
+#endif
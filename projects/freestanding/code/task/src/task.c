@@ -0,0 +1,201 @@
+#include "freestanding/task.h"
+
+#include "abstraction/interrupts.h"
+#include "abstraction/kernel.h"
+#include "abstraction/percpu.h"
+#include "abstraction/thread.h"
+#include "freestanding/task/deque.h"
+#include "shared/maths.h"
+#include "shared/memory/policy.h"
+
+// NOTE: The flag is written by other processors, so it is kept off the cache
+// lines of the deque.
+typedef struct {
+    TaskDeque deque;
+    __attribute__((aligned(64))) bool sleeping;
+} TaskWorker;
+
+static TaskWorker *workers;
+static U32 workersCount;
+
+// NOTE: A thread that is preempted halfway through a push or pop would leave
+// the deque to the next thread on this processor as a second owner. The owner
+// side therefore runs with interrupts disabled, which also keeps it on the
+// deque of the processor it looked up.
+static bool taskOwnPush(Task *task) {
+    bool interruptsWereEnabled = interruptsEnabled();
+    interruptsDisable();
+    bool pushed = taskPush(&workers[PERCPU_GET(id)].deque, task);
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+    return pushed;
+}
+
+static Task *taskOwnPop() {
+    bool interruptsWereEnabled = interruptsEnabled();
+    interruptsDisable();
+    Task *task = taskPop(&workers[PERCPU_GET(id)].deque);
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+    return task;
+}
+
+// NOTE: processorID only spreads the thieves, it may be stale by now.
+static Task *taskFind(U32 processorID) {
+    Task *task = taskOwnPop();
+    if (task) {
+        return task;
+    }
+
+    // NOTE: Start at the next processor so thieves spread over the victims.
+    for (typeof(workersCount) i = 1; i < workersCount; i++) {
+        task = taskSteal(&workers[(processorID + i) % workersCount].deque);
+        if (task) {
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+static void taskRun(Task *task) {
+    // NOTE: The task can be gone as soon as its group is decremented.
+    TaskGroup *group = task->group;
+    task->function(task->argument);
+    __atomic_fetch_sub(&group->pending, 1, __ATOMIC_RELEASE);
+}
+
+static void sleeperWake(U32 processorID) {
+    // NOTE: Pairs with the fence in taskWorkerRun, either the sleeper sees the
+    // new task or this sees it sleeping.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (typeof(workersCount) i = 1; i < workersCount; i++) {
+        U32 other = (processorID + i) % workersCount;
+        if (__atomic_load_n(&workers[other].sleeping, __ATOMIC_RELAXED) &&
+            __atomic_exchange_n(&workers[other].sleeping, false,
+                                __ATOMIC_ACQ_REL)) {
+            processorWake(other);
+            return;
+        }
+    }
+}
+
+static void taskWorkerRun(void *argument) {
+    (void)argument;
+    U32 processorID = PERCPU_GET(id);
+    TaskWorker *worker = &workers[processorID];
+
+    // NOTE: Tasks run with interrupts enabled, so a shootdown sent by another
+    // processor is taken right away instead of after the task.
+    interruptsEnable();
+    while (1) {
+        Task *task = taskFind(processorID);
+        if (task) {
+            taskRun(task);
+            continue;
+        }
+
+        // NOTE: A wake-up that is taken between the last look and the halt
+        // would be slept through, so it stays pending until the halt.
+        interruptsDisable();
+        __atomic_store_n(&worker->sleeping, true, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        // NOTE: A task that was spawned before the flag was visible did not
+        // wake this processor, so look once more.
+        task = taskFind(processorID);
+        if (task) {
+            __atomic_store_n(&worker->sleeping, false, __ATOMIC_RELAXED);
+            interruptsEnable();
+            taskRun(task);
+            continue;
+        }
+
+        processorSleep();
+        __atomic_store_n(&worker->sleeping, false, __ATOMIC_RELAXED);
+        interruptsEnable();
+    }
+}
+
+void tasksInit(U32 processorsCount) {
+    workers = identityMemoryAlloc(
+        ceilingPowerOf2(processorsCount * sizeof(TaskWorker)));
+    workersCount = processorsCount;
+    for (typeof(workersCount) i = 0; i < workersCount; i++) {
+        taskDequeInit(&workers[i].deque);
+        workers[i].sleeping = false;
+    }
+
+    for (typeof(workersCount) i = 1; i < workersCount; i++) {
+        processorWorkRun(i, taskWorkerRun, nullptr);
+    }
+}
+
+void taskSpawn(TaskGroup *group, Task *task) {
+    task->group = group;
+    __atomic_fetch_add(&group->pending, 1, __ATOMIC_RELAXED);
+
+    if (!taskOwnPush(task)) {
+        taskRun(task);
+        return;
+    }
+
+    sleeperWake(PERCPU_GET(id));
+}
+
+void taskGroupWait(TaskGroup *group) {
+    U32 processorID = PERCPU_GET(id);
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE)) {
+        Task *task = taskFind(processorID);
+        if (task) {
+            taskRun(task);
+        } else {
+            spinWaitHint();
+        }
+    }
+}
+
+typedef struct {
+    U64 start;
+    U64 end;
+    U64 grain;
+    ParallelForFunction function;
+    void *argument;
+} ParallelForRange;
+
+// Splits in halves and hands the upper half out, so the first steal already
+// takes half of the work.
+static void parallelForRun(void *argument) {
+    ParallelForRange *range = argument;
+    if (range->end - range->start <= range->grain) {
+        range->function(range->start, range->end, range->argument);
+        return;
+    }
+
+    U64 middle = range->start + ((range->end - range->start) / 2);
+    ParallelForRange upper = *range;
+    upper.start = middle;
+    ParallelForRange lower = *range;
+    lower.end = middle;
+
+    TaskGroup group = {.pending = 0};
+    Task task = {.function = parallelForRun, .argument = &upper};
+    taskSpawn(&group, &task);
+    parallelForRun(&lower);
+    taskGroupWait(&group);
+}
+
+void taskParallelFor(U64 start, U64 end, U64 grain,
+                     ParallelForFunction function, void *argument) {
+    if (start >= end) {
+        return;
+    }
+
+    ParallelForRange range = {.start = start,
+                              .end = end,
+                              .grain = MAX(grain, 1),
+                              .function = function,
+                              .argument = argument};
+    parallelForRun(&range);
+}
@@ -0,0 +1,44 @@
+#ifndef KERNEL_BENCHMARK_H
+#define KERNEL_BENCHMARK_H
+
+#include "shared/prng/biski.h"
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+
+typedef struct {
+    U64 cycles; // Only the part that is measured, not the setup or checks
+    U64 bytes;  // Processed in this round, 0 if that has no meaning
+} BenchmarkRound;
+
+// Runs a single round. Returns false if the round failed its own checks, which
+// stops the benchmark. random is seeded the same for every run of the
+// benchmark, so the rounds get the same inputs every time.
+typedef bool (*BenchmarkFunction)(U64 parameter, BiskiState *random,
+                                  BenchmarkRound *round);
+
+static constexpr auto BENCHMARK_ITERATIONS_MAX = 256;
+
+typedef struct {
+    String name;
+    U64 parameter; // E.g., the page size, part of the results
+    BenchmarkFunction function;
+    U32 warmup;     // Rounds that are run but not measured
+    U32 iterations; // At most BENCHMARK_ITERATIONS_MAX
+} Benchmark;
+
+void benchmarkAdd_(Benchmark benchmark);
+
+#define benchmarkAdd(benchmarkName, benchmarkFunction, ...)                    \
+    benchmarkAdd_((Benchmark){.name = (benchmarkName),                         \
+                              .parameter = 0,                                  \
+                              .function = (benchmarkFunction),                 \
+                              .warmup = 2,                                     \
+                              .iterations = 32,                                \
+                              __VA_ARGS__})
+
+// Runs all benchmarks in the order they were added. Every result is logged and
+// also written to serial as a JSON line, see cmd/benchmark to compare those to
+// a baseline. Returns false if a benchmark failed.
+[[nodiscard]] bool benchmarksRun(U64 seed);
+
+#endif
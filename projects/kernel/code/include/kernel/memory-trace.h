@@ -0,0 +1,16 @@
+#ifndef KERNEL_MEMORY_TRACE_H
+#define KERNEL_MEMORY_TRACE_H
+
+// Records every buddy allocation, free and claim of the physical and virtual
+// buddies, every change to the mapping sizes and every page fault. Only in a
+// MEMORY_TRACE build, otherwise nothing is recorded.
+//
+// Starting reserves the ring and first records the free blocks of both buddies
+// and the current mappings, so a replay can start from empty allocators.
+void memoryTraceStart();
+
+// Writes the records taken since the last export to serial and makes room for
+// new ones. See the replayer in shared/code/memory/allocator/tests.
+void memoryTraceExport();
+
+#endif
@@ -0,0 +1,194 @@
+#include "kernel/benchmark.h"
+
+#include "abstraction/log.h"
+#include "abstraction/text/converter/converter.h"
+#include "abstraction/time.h"
+#include "freestanding/log/init.h"
+#include "kernel/memory-trace.h"
+#include "shared/assert.h"
+#include "shared/log.h"
+#include "shared/maths.h"
+#include "shared/prng/biski.h"
+#include "shared/text/string.h"
+#include "shared/types/array-types.h"
+#include "shared/types/numeric.h"
+
+static constexpr auto BENCHMARKS_MAX = 64;
+
+static Benchmark benchmarks[BENCHMARKS_MAX];
+static U32 benchmarksLen;
+
+void benchmarkAdd_(Benchmark benchmark) {
+    ASSERT(benchmarksLen < BENCHMARKS_MAX);
+    ASSERT(benchmark.iterations > 0 &&
+           benchmark.iterations <= BENCHMARK_ITERATIONS_MAX);
+
+    benchmarks[benchmarksLen] = benchmark;
+    benchmarksLen++;
+}
+
+typedef struct {
+    U64 min;
+    U64 median;
+    U64 p99;
+    U64 mean;
+    U64 standardDeviation;
+    U64 milliCyclesPerByte; // 0 if the benchmark has no bytes
+} BenchmarkResult;
+
+static U64 squareRoot(U64 value) {
+    U64 result = 0;
+    for (U64 bit = 1ULL << 62; bit; bit >>= 2) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+    }
+    return result;
+}
+
+static void cyclesSort(U64 *cycles, U32 len) {
+    for (U32 i = 1; i < len; i++) {
+        U64 current = cycles[i];
+        U32 j = i;
+        for (; j > 0 && cycles[j - 1] > current; j--) {
+            cycles[j] = cycles[j - 1];
+        }
+        cycles[j] = current;
+    }
+}
+
+static BenchmarkResult benchmarkResultGet(U64 *cycles, U32 len, U64 bytes) {
+    cyclesSort(cycles, len);
+
+    U64 sum = 0;
+    for (U32 i = 0; i < len; i++) {
+        sum += cycles[i];
+    }
+    U64 mean = sum / len;
+
+    U64 squaredDeviations = 0;
+    for (U32 i = 0; i < len; i++) {
+        U64 deviation = cycles[i] > mean ? cycles[i] - mean : mean - cycles[i];
+        squaredDeviations += deviation * deviation;
+    }
+
+    return (BenchmarkResult){
+        .min = cycles[0],
+        .median = cycles[len / 2],
+        .p99 = cycles[((len * 99) + 99) / 100 - 1],
+        .mean = mean,
+        .standardDeviation = squareRoot(squaredDeviations / len),
+        .milliCyclesPerByte = bytes ? (sum * 1000) / bytes : 0};
+}
+
+static void benchmarkResultAppend(Benchmark *benchmark,
+                                  BenchmarkResult *result) {
+    INFO(stringWithMinSizeDefault(benchmark->name, 20));
+    INFO(stringWithMinSizeDefault(STRING_CONVERT(benchmark->parameter), 10));
+    INFO(STRING("min: "));
+    INFO(stringWithMinSizeDefault(STRING_CONVERT(result->min), 12));
+    INFO(STRING("median: "));
+    INFO(stringWithMinSizeDefault(STRING_CONVERT(result->median), 12));
+    INFO(STRING("p99: "));
+    INFO(stringWithMinSizeDefault(STRING_CONVERT(result->p99), 12));
+    INFO(STRING("stddev: "));
+    INFO(stringWithMinSizeDefault(STRING_CONVERT(result->standardDeviation),
+                                  12));
+    INFO(STRING("median ns: "));
+    INFO(cyclesToNanos(result->median));
+    if (result->milliCyclesPerByte) {
+        INFO(STRING(" cycles per 1000 bytes: "));
+        INFO(result->milliCyclesPerByte);
+    }
+    INFO(STRING("\n"));
+}
+
+#ifdef SERIAL
+static constexpr auto BENCHMARK_LINE_BYTES = 512;
+
+static void benchmarkFieldAppend(U8_a *line, String field, U64 value) {
+    KLOG_APPEND(line, STRING(",\""));
+    KLOG_APPEND(line, field);
+    KLOG_APPEND(line, STRING("\":"));
+    KLOG_APPEND(line, value);
+}
+
+// NOTE: Written straight to serial, so the screen does not fill up with them.
+static void benchmarkResultSerialWrite(Benchmark *benchmark,
+                                       BenchmarkResult *result) {
+    U8 lineBuffer[BENCHMARK_LINE_BYTES];
+    U8_a line = {.buf = lineBuffer, .len = 0};
+
+    KLOG_APPEND(&line, STRING("{\"benchmark\":\""));
+    KLOG_APPEND(&line, benchmark->name);
+    KLOG_APPEND(&line, STRING("\""));
+    benchmarkFieldAppend(&line, STRING("parameter"), benchmark->parameter);
+    benchmarkFieldAppend(&line, STRING("iterations"), benchmark->iterations);
+    benchmarkFieldAppend(&line, STRING("min"), result->min);
+    benchmarkFieldAppend(&line, STRING("median"), result->median);
+    benchmarkFieldAppend(&line, STRING("p99"), result->p99);
+    benchmarkFieldAppend(&line, STRING("mean"), result->mean);
+    benchmarkFieldAppend(&line, STRING("stddev"), result->standardDeviation);
+    benchmarkFieldAppend(&line, STRING("milliCyclesPerByte"),
+                         result->milliCyclesPerByte);
+    KLOG_APPEND(&line, STRING("}\n"));
+
+    logSerialFlush(line);
+}
+#endif
+
+static bool benchmarkRun(Benchmark *benchmark, U64 seed) {
+    BiskiState random;
+    biskiSeed(&random, seed);
+
+    U64 cycles[BENCHMARK_ITERATIONS_MAX];
+    U64 bytes = 0;
+    for (U32 i = 0; i < benchmark->warmup + benchmark->iterations; i++) {
+        BenchmarkRound round = {.cycles = 0, .bytes = 0};
+        if (!benchmark->function(benchmark->parameter, &random, &round)) {
+            KFLUSH_AFTER {
+                ERROR(STRING("Benchmark failed: "));
+                ERROR(benchmark->name);
+                ERROR(STRING(" "));
+                ERROR(benchmark->parameter, .flags = NEWLINE);
+            }
+            return false;
+        }
+
+        if (i >= benchmark->warmup) {
+            cycles[i - benchmark->warmup] = round.cycles;
+            bytes += round.bytes;
+        }
+    }
+
+    BenchmarkResult result =
+        benchmarkResultGet(cycles, benchmark->iterations, bytes);
+    KFLUSH_AFTER { benchmarkResultAppend(benchmark, &result); }
+#ifdef SERIAL
+    benchmarkResultSerialWrite(benchmark, &result);
+#endif
+
+    return true;
+}
+
+bool benchmarksRun(U64 seed) {
+    KFLUSH_AFTER {
+        INFO(STRING("Running "));
+        INFO(benchmarksLen);
+        INFO(STRING(" benchmarks, all in clockcycles\n"));
+    }
+
+    for (U32 i = 0; i < benchmarksLen; i++) {
+        if (!benchmarkRun(&benchmarks[i], seed)) {
+            return false;
+        }
+#ifdef MEMORY_TRACE
+        // NOTE: A single benchmark fills a good part of the ring already.
+        memoryTraceExport();
+#endif
+    }
+    return true;
+}
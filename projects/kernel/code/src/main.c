@@ -1,16 +1,25 @@
+#include "abstraction/coroutine.h"
 #include "abstraction/interrupts.h" // for setupIDT
 #include "abstraction/kernel.h"
 #include "abstraction/log.h" // for LOG, LOG_CHOOSER_IMPL_1, rewind, pro...
 #include "abstraction/memory/manipulation.h"
 #include "abstraction/memory/virtual/map.h"
 #include "abstraction/memory/virtual/status.h"
+#include "abstraction/percpu.h"
+#include "abstraction/profiler.h"
+#include "abstraction/serial.h"
 #include "abstraction/thread.h"
 #include "abstraction/time.h"
 #include "efi-to-kernel/kernel-parameters.h"  // for KernelParameters
 #include "efi-to-kernel/memory/definitions.h" // for KERNEL_PARAMS_START
 #include "freestanding/log/init.h"
 #include "freestanding/peripheral/screen.h"
+#include "freestanding/task.h"
+#include "kernel/benchmark.h"
+#include "kernel/memory-trace.h"
 #include "shared/assert.h"
+#include "shared/lock/class.h"
+#include "shared/lock/spin.h"
 #include "shared/log.h"
 #include "shared/maths.h"
 #include "shared/memory/allocator/arena.h"
@@ -31,7 +40,9 @@ static constexpr auto MAX_TEST_ENTRIES = TEST_MEMORY_AMOUNT / (sizeof(U64));
 
 static constexpr U64 PRNG_SEED = 15466503514872390148ULL;
 
-static U64 TEST_ITERATIONS = 32;
+#ifdef PROFILING
+static constexpr auto PROFILER_INTERVAL_MICROSECONDS = 100;
+#endif
 
 static void appendMemoryDeltaType(AvailableMemoryState startMemory,
                                   AvailableMemoryState endMemory) {
@@ -66,7 +77,11 @@ static void appendMemoryDelta(AvailableMemoryState startPhysicalMemory,
 static constexpr auto GROWTH_RATE = 2;
 static constexpr auto START_ENTRIES_COUNT = 4096 / sizeof(U64);
 
-typedef enum { IDENTITY_MEMORY, MAPPABLE_MEMORY } MemoryWritableType;
+typedef enum {
+    IDENTITY_MEMORY,
+    MAPPABLE_MEMORY,
+    RESIZABLE_MEMORY
+} MemoryWritableType;
 
 static U64 arrayWritingTest(U64_pow2 pageSize, U64 arrayEntries,
                             MemoryWritableType memoryWritableType,
@@ -78,6 +93,7 @@ static U64 arrayWritingTest(U64_pow2 pageSize, U64 arrayEntries,
 
     U64 *buffer;
     U64 cycles;
+    U64 resizedBytes = TEST_MEMORY_AMOUNT;
     if (memoryWritableType == IDENTITY_MEMORY) {
         buffer = identityMemoryAlloc(
             MAX(pageSizeSmallest(), START_ENTRIES_COUNT * sizeof(U64)));
@@ -105,10 +121,41 @@ static U64 arrayWritingTest(U64_pow2 pageSize, U64 arrayEntries,
 
         buffer = dynamicArray.buf;
 
+        cycles = endCycleCount - startCycleCount;
+    } else if (memoryWritableType == RESIZABLE_MEMORY) {
+        buffer = mappableMemoryAlloc(
+            MAX(pageSize, START_ENTRIES_COUNT * sizeof(U64)), pageSize);
+
+        U64_max_a dynamicArray = {
+            .buf = buffer,
+            .len = 0,
+            .cap = MAX(pageSize, START_ENTRIES_COUNT * sizeof(U64)) /
+                   sizeof(U64)};
+
+        beforePageFaults = PERCPU_GET(pageFaults);
+        U64 startCycleCount = cycleCounterGet(true, false);
+        for (typeof(arrayEntries) i = 0; i < arrayEntries; i++) {
+            if (dynamicArray.len >= dynamicArray.cap) {
+                U64 currentBytes = dynamicArray.cap * sizeof(U64);
+                dynamicArray.buf = mappableMemoryResize(
+                    (Memory){.start = (U64)dynamicArray.buf,
+                             .bytes = currentBytes},
+                    currentBytes * GROWTH_RATE);
+                dynamicArray.cap *= GROWTH_RATE;
+            }
+            dynamicArray.buf[dynamicArray.len] = i;
+            dynamicArray.len++;
+        }
+        U64 endCycleCount = cycleCounterGet(false, true);
+        afterPageFaults = PERCPU_GET(pageFaults);
+
+        buffer = dynamicArray.buf;
+        resizedBytes = dynamicArray.cap * sizeof(U64);
+
         cycles = endCycleCount - startCycleCount;
     } else {
         buffer = mappableMemoryAlloc(TEST_MEMORY_AMOUNT, pageSize);
-        beforePageFaults = pageFaultsCurrent;
+        beforePageFaults = PERCPU_GET(pageFaults);
         U64 startCycleCount = cycleCounterGet(true, false);
 
         for (typeof(arrayEntries) i = 0; i < arrayEntries; i++) {
@@ -116,7 +163,7 @@ static U64 arrayWritingTest(U64_pow2 pageSize, U64 arrayEntries,
         }
 
         U64 endCycleCount = cycleCounterGet(false, true);
-        afterPageFaults = pageFaultsCurrent;
+        afterPageFaults = PERCPU_GET(pageFaults);
 
         cycles = endCycleCount - startCycleCount;
     }
@@ -141,7 +188,7 @@ static U64 arrayWritingTest(U64_pow2 pageSize, U64 arrayEntries,
                      .bytes = ceilingPowerOf2(arrayEntries * alignof(U64))});
     } else {
         mappableMemoryFree(
-            (Memory){.start = (U64)buffer, .bytes = TEST_MEMORY_AMOUNT});
+            (Memory){.start = (U64)buffer, .bytes = resizedBytes});
 
         U64 expectedAfterPageFaults = beforePageFaults + expectedPageFaults;
         if (expectedAfterPageFaults != afterPageFaults) {
@@ -161,200 +208,235 @@ static U64 arrayWritingTest(U64_pow2 pageSize, U64 arrayEntries,
     return cycles;
 }
 
-static bool partialMappingTest(U64_pow2 pageSize) {
-    U64 sum = 0;
-
-    KFLUSH_AFTER {
-        INFO(STRING("Page Size: "));
-        INFO(stringWithMinSizeDefault(STRING_CONVERT(pageSize), 10));
-    }
+static bool fullMappingBenchmark(U64 pageSize, BiskiState *random,
+                                 BenchmarkRound *round) {
+    (void)random;
 
-    BiskiState state;
-    biskiSeed(&state, PRNG_SEED);
-
-    for (typeof(TEST_ITERATIONS) iteration = 0; iteration < TEST_ITERATIONS;
-         iteration++) {
-        U64 entriesToWrite =
-            ringBufferIndex(biskiNext(&state), MAX_TEST_ENTRIES);
-        U64 cycles = arrayWritingTest(
-            pageSize, entriesToWrite, MAPPABLE_MEMORY,
-            ceilingDivide((entriesToWrite * sizeof(U64)), pageSize));
-        if (!cycles) {
-            return false;
-        }
-        sum += cycles;
-    }
+    round->cycles =
+        arrayWritingTest(pageSize, MAX_TEST_ENTRIES, MAPPABLE_MEMORY,
+                         dividePowerOf2(TEST_MEMORY_AMOUNT, pageSize));
+    round->bytes = TEST_MEMORY_AMOUNT;
+    return round->cycles;
+}
 
-    KFLUSH_AFTER {
-        INFO(STRING("\taverage clockcycles: "));
-        INFO(sum / TEST_ITERATIONS, .flags = NEWLINE);
-    }
+static bool partialMappingBenchmark(U64 pageSize, BiskiState *random,
+                                    BenchmarkRound *round) {
+    U64 entriesToWrite = ringBufferIndex(biskiNext(random), MAX_TEST_ENTRIES);
 
-    return true;
+    round->cycles = arrayWritingTest(
+        pageSize, entriesToWrite, MAPPABLE_MEMORY,
+        ceilingDivide((entriesToWrite * sizeof(U64)), pageSize));
+    round->bytes = entriesToWrite * sizeof(U64);
+    return round->cycles;
 }
 
-static bool fullMappingTest(U64_pow2 pageSize) {
-    U64 sum = 0;
+static bool resizingMappingBenchmark(U64 pageSize, BiskiState *random,
+                                     BenchmarkRound *round) {
+    U64 entriesToWrite = ringBufferIndex(biskiNext(random), MAX_TEST_ENTRIES);
 
-    KFLUSH_AFTER {
-        INFO(STRING("Page Size: "));
-        INFO(stringWithMinSizeDefault(STRING_CONVERT(pageSize), 10));
-    }
+    round->cycles = arrayWritingTest(
+        pageSize, entriesToWrite, RESIZABLE_MEMORY,
+        ceilingDivide((entriesToWrite * sizeof(U64)), pageSize));
+    round->bytes = entriesToWrite * sizeof(U64);
+    return round->cycles;
+}
 
-    for (typeof(TEST_ITERATIONS) iteration = 0; iteration < TEST_ITERATIONS;
-         iteration++) {
-        U64 cycles =
-            arrayWritingTest(pageSize, MAX_TEST_ENTRIES, MAPPABLE_MEMORY,
-                             dividePowerOf2(TEST_MEMORY_AMOUNT, pageSize));
-        if (!cycles) {
-            return false;
-        }
-        sum += cycles;
-    }
+static bool fullIdentityBenchmark(U64 parameter, BiskiState *random,
+                                  BenchmarkRound *round) {
+    (void)parameter;
+    (void)random;
 
-    KFLUSH_AFTER {
-        INFO(STRING("\taverage clockcycles: "));
-        INFO(sum / TEST_ITERATIONS, .flags = NEWLINE);
-    }
-
-    return true;
+    round->cycles = arrayWritingTest(alignof(U64), MAX_TEST_ENTRIES,
+                                     IDENTITY_MEMORY, 0);
+    round->bytes = MAX_TEST_ENTRIES * sizeof(U64);
+    return round->cycles;
 }
 
-static void identityTests() {
-    KFLUSH_AFTER {
-        INFO(STRING("Starting identity tests...\n\n"));
-        INFO(STRING("Starting full writing test...\n"));
-    }
+static bool partialIdentityBenchmark(U64 parameter, BiskiState *random,
+                                     BenchmarkRound *round) {
+    (void)parameter;
 
-    U64 sum = 0;
+    U64 entriesToWrite = ringBufferIndex(biskiNext(random), MAX_TEST_ENTRIES);
+    round->cycles =
+        arrayWritingTest(alignof(U64), entriesToWrite, IDENTITY_MEMORY, 0);
+    round->bytes = entriesToWrite * sizeof(U64);
+    return round->cycles;
+}
 
-    for (typeof(TEST_ITERATIONS) iteration = 0; iteration < TEST_ITERATIONS;
-         iteration++) {
-        U64 cycles = arrayWritingTest(alignof(U64), MAX_TEST_ENTRIES,
-                                      IDENTITY_MEMORY, 0);
-        if (!cycles) {
-            return;
-        }
-        sum += cycles;
-    }
+static void baselineWrite(U64 entriesToWrite, BenchmarkRound *round) {
+    U64 *buffer = identityMemoryAlloc(MAX_TEST_ENTRIES * sizeof(U64));
 
-    KFLUSH_AFTER {
-        INFO(STRING("\t\t\t\t\t\taverage clockcycles: "));
-        INFO(sum / TEST_ITERATIONS, .flags = NEWLINE);
+    U64 startCycleCount = cycleCounterGet(true, false);
+    for (typeof(entriesToWrite) i = 0; i < entriesToWrite; i++) {
+        buffer[i] = i;
     }
+    U64 endCycleCount = cycleCounterGet(false, true);
 
-    KFLUSH_AFTER { INFO(STRING("\nStarting partial writing test...\n")); }
+    identityMemoryFree((Memory){.start = (U64)buffer,
+                                .bytes = MAX_TEST_ENTRIES * sizeof(U64)});
 
-    sum = 0;
+    round->cycles = endCycleCount - startCycleCount;
+    round->bytes = entriesToWrite * sizeof(U64);
+}
 
-    BiskiState state;
-    biskiSeed(&state, PRNG_SEED);
+static bool fullBaselineBenchmark(U64 parameter, BiskiState *random,
+                                  BenchmarkRound *round) {
+    (void)parameter;
+    (void)random;
 
-    for (typeof(TEST_ITERATIONS) iteration = 0; iteration < TEST_ITERATIONS;
-         iteration++) {
-        U64 entriesToWrite =
-            ringBufferIndex(biskiNext(&state), MAX_TEST_ENTRIES);
-        U64 cycles =
-            arrayWritingTest(alignof(U64), entriesToWrite, IDENTITY_MEMORY, 0);
-        if (!cycles) {
-            return;
-        }
-        sum += cycles;
-    }
+    baselineWrite(MAX_TEST_ENTRIES, round);
+    return true;
+}
 
-    KFLUSH_AFTER {
-        INFO(STRING("\t\t\t\t\t\taverage clockcycles: "));
-        INFO(sum / TEST_ITERATIONS, .flags = NEWLINE);
-    }
+static bool partialBaselineBenchmark(U64 parameter, BiskiState *random,
+                                     BenchmarkRound *round) {
+    (void)parameter;
 
-    KFLUSH_AFTER { INFO(STRING("\n")); }
+    baselineWrite(ringBufferIndex(biskiNext(random), MAX_TEST_ENTRIES), round);
+    return true;
 }
 
-static void baselineTest() {
-    KFLUSH_AFTER {
-        INFO(STRING("Starting baseline test...\n"));
-        INFO(STRING("full writing test...\n"));
+static void entriesWrite(U64 start, U64 end, void *argument) {
+    U64 *buffer = argument;
+    for (typeof(start) i = start; i < end; i++) {
+        buffer[i] = i;
     }
+}
 
-    U64 sum = 0;
+// NOTE: The same writes as the full baseline, split over all processors in
+// ranges of at most grain entries.
+static bool parallelBaselineBenchmark(U64 grain, BiskiState *random,
+                                      BenchmarkRound *round) {
+    (void)random;
 
-    for (typeof(TEST_ITERATIONS) iteration = 0; iteration < TEST_ITERATIONS;
-         iteration++) {
-        U64 *buffer = identityMemoryAlloc(MAX_TEST_ENTRIES * sizeof(U64));
+    U64 *buffer = identityMemoryAlloc(MAX_TEST_ENTRIES * sizeof(U64));
 
-        U64 startCycleCount = cycleCounterGet(true, false);
+    U64 startCycleCount = cycleCounterGet(true, false);
+    taskParallelFor(0, MAX_TEST_ENTRIES, grain, entriesWrite, buffer);
+    U64 endCycleCount = cycleCounterGet(false, true);
 
-        for (typeof_unqual(MAX_TEST_ENTRIES) i = 0; i < MAX_TEST_ENTRIES; i++) {
-            buffer[i] = i;
+    bool written = true;
+    for (U64 i = 0; i < MAX_TEST_ENTRIES; i++) {
+        if (buffer[i] != i) {
+            written = false;
+            break;
         }
-        U64 endCycleCount = cycleCounterGet(false, true);
+    }
 
-        identityMemoryFree((Memory){.start = (U64)buffer,
-                                    .bytes = MAX_TEST_ENTRIES * sizeof(U64)});
+    identityMemoryFree((Memory){.start = (U64)buffer,
+                                .bytes = MAX_TEST_ENTRIES * sizeof(U64)});
 
-        U64 cycles = endCycleCount - startCycleCount;
-        sum += cycles;
-    }
+    round->cycles = endCycleCount - startCycleCount;
+    round->bytes = MAX_TEST_ENTRIES * sizeof(U64);
+    return written;
+}
 
-    KFLUSH_AFTER {
-        INFO(STRING("\t\t\t\t\t\taverage clockcycles: "));
-        INFO(sum / TEST_ITERATIONS, .flags = NEWLINE);
+// NOTE: The framebuffer memory type is decided by pageFlagsScreenMemory, so
+// compare the output of this benchmark between builds to see its effect.
+static bool screenBlitBenchmark(U64 parameter, BiskiState *random,
+                                BenchmarkRound *round) {
+    (void)parameter;
+    (void)random;
+
+    // NOTE: The drainer writes the log to the screen at the same time.
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&logRing.drainLock);
+    U64 startCycleCount = cycleCounterGet(true, false);
+    round->bytes = screenBlit();
+    U64 endCycleCount = cycleCounterGet(false, true);
+    spinLockReleaseInterruptsRestore(&logRing.drainLock,
+                                     interruptsWereEnabled);
+
+    round->cycles = endCycleCount - startCycleCount;
+    return true;
+}
+
+static constexpr auto COROUTINE_SWITCHES = 1024;
+
+static void coroutineYielding(Coroutine *self, void *argument) {
+    (void)argument;
+    for (U32 i = 0; i < COROUTINE_SWITCHES; i++) {
+        coroutineYield(self);
     }
+}
 
-    KFLUSH_AFTER { INFO(STRING("partial writing test...\n")); }
+static bool serialReadyCompleted(void *argument) {
+    (void)argument;
+    return serialReady();
+}
 
-    sum = 0;
+// NOTE: What a coroutine that writes to serial pays per byte on top of the
+// port itself.
+static void coroutineSerialAwaiting(Coroutine *self, void *argument) {
+    (void)argument;
+    for (U32 i = 0; i < COROUTINE_SWITCHES; i++) {
+        coroutineAwait(self, serialReadyCompleted, nullptr);
+    }
+}
 
-    BiskiState state;
-    biskiSeed(&state, PRNG_SEED);
+static void coroutineRoundRun(CoroutineFunction function,
+                              BenchmarkRound *round) {
+    Coroutine *coroutine = coroutineCreate(function, nullptr);
 
-    for (typeof(TEST_ITERATIONS) iteration = 0; iteration < TEST_ITERATIONS;
-         iteration++) {
-        U64 *buffer = identityMemoryAlloc(MAX_TEST_ENTRIES * sizeof(U64));
-        U64 entriesToWrite =
-            ringBufferIndex(biskiNext(&state), MAX_TEST_ENTRIES);
+    U64 startCycleCount = cycleCounterGet(true, false);
+    while (coroutineResume(coroutine)) {
+    }
+    U64 endCycleCount = cycleCounterGet(false, true);
 
-        U64 startCycleCount = cycleCounterGet(true, false);
+    coroutineDestroy(coroutine);
+    round->cycles = endCycleCount - startCycleCount;
+}
 
-        for (typeof(entriesToWrite) i = 0; i < entriesToWrite; i++) {
-            buffer[i] = i;
-        }
-        U64 endCycleCount = cycleCounterGet(false, true);
+static bool coroutineYieldBenchmark(U64 parameter, BiskiState *random,
+                                    BenchmarkRound *round) {
+    (void)parameter;
+    (void)random;
 
-        identityMemoryFree((Memory){.start = (U64)buffer,
-                                    .bytes = MAX_TEST_ENTRIES * sizeof(U64)});
+    coroutineRoundRun(coroutineYielding, round);
+    return true;
+}
 
-        U64 cycles = endCycleCount - startCycleCount;
-        sum += cycles;
-    }
+static bool coroutineSerialAwaitBenchmark(U64 parameter, BiskiState *random,
+                                          BenchmarkRound *round) {
+    (void)parameter;
+    (void)random;
 
-    KFLUSH_AFTER {
-        INFO(STRING("\t\t\t\t\t\taverage clockcycles: "));
-        INFO(sum / TEST_ITERATIONS, .flags = NEWLINE);
-    }
+    coroutineRoundRun(coroutineSerialAwaiting, round);
+    return true;
 }
 
-static void mappingTests() {
-    KFLUSH_AFTER {
-        INFO(STRING("Starting mapping tests\n\n"));
-        INFO(STRING("Starting full mapping test...\n"));
-    }
+static void benchmarksAdd() {
+    benchmarkAdd(STRING("screen/blit"), screenBlitBenchmark, .iterations = 16);
 
     for (U64_pow2 pageSize = 4 * KiB; pageSize <= (2 * MiB); pageSize *= 2) {
-        if (!fullMappingTest(pageSize)) {
-            return;
-        }
+        benchmarkAdd(STRING("mapping/full"), fullMappingBenchmark,
+                     .parameter = pageSize);
+    }
+    for (U64_pow2 pageSize = 4 * KiB; pageSize <= (2 * MiB); pageSize *= 2) {
+        benchmarkAdd(STRING("mapping/partial"), partialMappingBenchmark,
+                     .parameter = pageSize);
+    }
+    for (U64_pow2 pageSize = 4 * KiB; pageSize <= (2 * MiB); pageSize *= 2) {
+        benchmarkAdd(STRING("mapping/resizing"), resizingMappingBenchmark,
+                     .parameter = pageSize);
     }
 
-    KFLUSH_AFTER { INFO(STRING("\nStarting partial mapping test...\n")); }
+    benchmarkAdd(STRING("identity/full"), fullIdentityBenchmark);
+    benchmarkAdd(STRING("identity/partial"), partialIdentityBenchmark);
 
-    for (U64 pageSize = 4 * KiB; pageSize <= (2 * MiB); pageSize <<= 1) {
-        if (!partialMappingTest(pageSize)) {
-            return;
-        }
+    benchmarkAdd(STRING("baseline/full"), fullBaselineBenchmark);
+    benchmarkAdd(STRING("baseline/partial"), partialBaselineBenchmark);
+    for (U64 grain = (4 * KiB) / sizeof(U64); grain <= MAX_TEST_ENTRIES;
+         grain *= 8) {
+        benchmarkAdd(STRING("baseline/parallel"), parallelBaselineBenchmark,
+                     .parameter = grain);
     }
 
-    KFLUSH_AFTER { INFO(STRING("\n")); }
+    benchmarkAdd(STRING("coroutine/yield"), coroutineYieldBenchmark,
+                 .parameter = COROUTINE_SWITCHES);
+    benchmarkAdd(STRING("coroutine/serial-await"),
+                 coroutineSerialAwaitBenchmark,
+                 .parameter = COROUTINE_SWITCHES);
 }
 
 __attribute__((section("kernel-start"))) int
@@ -393,114 +475,56 @@ kernelMain(struct KernelParameters *kernelParams) {
     identityMemoryNotBlockSizeFree((Memory){.start = kernelParams->self.start,
                                             .bytes = kernelParams->self.bytes});
 
+    U32 processorsRunning = processorsStart();
+    KFLUSH_AFTER {
+        INFO(STRING("Processors running: "));
+        INFO(processorsRunning, .flags = NEWLINE);
+    }
+    tasksInit(processorsRunning);
+    threadsInit();
+    logDrainerStart();
+
     // NOTE: from here, everything is initialized
 
+#ifdef PROFILING
+    profilerStart(PROFILER_INTERVAL_MICROSECONDS);
+#endif
+
     KFLUSH_AFTER { INFO(STRING("\n\n")); }
 
-    for (U32 i = 0; i < 2; i++) {
-        BiskiState state;
-        biskiSeed(&state, PRNG_SEED);
-
-        KFLUSH_AFTER {
-            memoryManagementStatusAppend();
-            memoryVirtualMappingStatusAppend();
-
-            INFO(STRING("Iterations per test: "));
-            INFO(TEST_ITERATIONS, .flags = NEWLINE);
-            INFO(STRING("Max memory per test: "));
-            INFO((U64)TEST_MEMORY_AMOUNT, .flags = NEWLINE);
-            INFO(STRING("Max array entries used: "));
-            INFO((U64)MAX_TEST_ENTRIES, .flags = NEWLINE);
-            INFO(STRING("Random array entries used: "));
-            for (typeof(TEST_ITERATIONS) i = 0; i < TEST_ITERATIONS; i++) {
-                INFO((U64)ringBufferIndex(biskiNext(&state), MAX_TEST_ENTRIES));
-                INFO(STRING(" "));
-            }
-            INFO(STRING("\n"));
-        }
+    KFLUSH_AFTER {
+        memoryManagementStatusAppend();
+        memoryVirtualMappingStatusAppend();
+
+        INFO(STRING("Max memory per test: "));
+        INFO((U64)TEST_MEMORY_AMOUNT, .flags = NEWLINE);
+        INFO(STRING("Max array entries used: "));
+        INFO((U64)MAX_TEST_ENTRIES, .flags = NEWLINE);
+    }
 
-        mappingTests();
-        identityTests();
-        baselineTest();
+    benchmarksAdd();
+#ifdef MEMORY_TRACE
+    memoryTraceStart();
+#endif
+    if (!benchmarksRun(PRNG_SEED)) {
+        KFLUSH_AFTER { ERROR(STRING("Benchmarks did not complete\n")); }
     }
 
+    KFLUSH_AFTER {
+        memoryManagementStatusAppend();
+        memoryVirtualMappingStatusAppend();
+    }
+
+    KFLUSH_AFTER { interruptLatenciesStatusAppend(); }
+    KFLUSH_AFTER { lockClassesLog(); }
+
+#ifdef PROFILING
+    profilerDump();
+#endif
+
     KFLUSH_AFTER { KLOG(STRING("TESTING IS OVER MY DUDES\n")); }
 
     while (1) {
         ;
     }
 }
-
-// void appendDescriptionHeaders(RSDPResult rsdp);
-
-// typedef enum { RSDT, XSDT, NUM_DESCRIPTION_TABLES }
-// DescriptionTableVersion; static USize entrySizes[NUM_DESCRIPTION_TABLES]
-// = {
-//     sizeof(U32),
-//     sizeof(U64),
-// };
-//
-// void appendDescriptionHeaders(RSDPResult rsdp) {
-//     CAcpiSDT *sdt = nullptr;
-//     USize entrySize = 0;
-//
-//     switch (rsdp.revision) {
-//     case RSDP_REVISION_1: {
-//         sdt = (CAcpiSDT *)rsdp.rsdp->v1.rsdt_addr;
-//         entrySize = entrySizes[RSDT];
-//         break;
-//     }
-//     case RSDP_REVISION_2: {
-//         sdt = (CAcpiSDT *)rsdp.rsdp->v2.xsdt_addr;
-//         entrySize = entrySizes[XSDT];
-//         break;
-//     }
-//     }
-//
-//     I8 **descriptionHeaders = (I8 **)&sdt->descriptionHeaders;
-//     for (U64 i = 0; i < sdt->header.length - sizeof(CAcpiSDT);
-//          i += entrySize) {
-//         CAcpiDescriptionTableHeader *header = nullptr;
-//         memcpy(&header, descriptionHeaders, entrySize);
-//
-//         LOG(STRING_LEN(header->signature,
-//         ACPI_DESCRIPTION_TABLE_SIGNATURE_LEN),
-//             .flags = NEWLINE);
-//
-//         ACPITable tableType =
-//             ACPITablesToEnum(STRING_LEN(header->signature, 4));
-//
-//         switch (tableType) {
-//         case MULTIPLE_APIC_DESCRIPTION_TABLE: {
-//             MADT *madt = (MADT *)header;
-//
-//             LOG(STRING("printing the structures of the MADT:"), .flags =
-//             NEWLINE);
-//
-//             InterruptControllerStructure *interruptStructures =
-//                 madt->interruptStructures;
-//             for (U64 j = 0;
-//                  j < madt->madt.header.length - sizeof(ConstantMADT);
-//                  j += interruptStructures->totalLength) {
-//                 LOG(STRING("Type: "));
-//                 LOG(interruptStructures->type);
-//                 LOG(STRING("Length: "));
-//                 LOG(interruptStructures->totalLength, .flags = NEWLINE);
-//
-//                 interruptStructures = (InterruptControllerStructure
-//                                            *)((I8 *)interruptStructures +
-//                                               interruptStructures->totalLength);
-//             }
-//
-//             break;
-//         }
-//         default: {
-//             LOG(STRING("Did not implement anything for this yet"),
-//             .flags = NEWLINE);
-//         }
-//         }
-//
-//         descriptionHeaders = (I8 **)((I8 *)descriptionHeaders +
-//         entrySize);
-//     }
-// }
@@ -0,0 +1,103 @@
+#include "kernel/memory-trace.h"
+
+#include "freestanding/log/init.h"
+#include "shared/log.h"
+#include "shared/maths.h"
+#include "shared/memory/allocator/buddy.h"
+#include "shared/memory/allocator/trace.h"
+#include "shared/memory/management/management.h"
+#include "shared/memory/management/page.h"
+#include "shared/memory/policy.h"
+#include "shared/text/string.h"
+#include "shared/trees/red-black/common.h"
+#include "shared/types/array-types.h"
+#include "shared/types/numeric.h"
+
+static constexpr U64_pow2 MEMORY_TRACE_RECORDS = 1 << 20;
+
+// NOTE: Free blocks of an order are recorded in the order they are stored, so
+// the replayed buddy hands them out in the same order.
+static void buddyFreeBlocksRecord(Buddy *buddy) {
+    for (Exponent order = 0; order < buddyOrderCount(buddy); order++) {
+        U64_a *blocks = &buddy->data.blocks[order];
+        for (typeof(blocks->len) i = 0; i < blocks->len; i++) {
+            memoryTraceRecord(
+                (MemoryTraceEvent)(buddy->traceEvents +
+                                   MEMORY_TRACE_BUDDY_FREE),
+                (Memory){.start = blocks->buf[i],
+                         .bytes = buddyBlockSize(buddy, order)},
+                0);
+        }
+    }
+}
+
+static void mappingsRecord(VMMNode *node) {
+    if (!node) {
+        return;
+    }
+
+    mappingsRecord((VMMNode *)node->basic.children[RB_TREE_LEFT]);
+    memoryTraceRecord(
+        MEMORY_TRACE_MAPPING_ADD,
+        (Memory){.start = node->basic.value, .bytes = node->bytes},
+        node->mappingSize);
+    mappingsRecord((VMMNode *)node->basic.children[RB_TREE_RIGHT]);
+}
+
+void memoryTraceStart() {
+    memoryTraceInit(identityMemoryAlloc(MEMORY_TRACE_RECORDS *
+                                        sizeof(MemoryTraceRecord)),
+                    MEMORY_TRACE_RECORDS);
+
+    buddyFreeBlocksRecord(&buddyPhysical);
+    buddyFreeBlocksRecord(&buddyVirtual);
+    mappingsRecord(memoryMapperSizes.tree);
+}
+
+static constexpr auto MEMORY_TRACE_LINE_BYTES = 128;
+
+static void recordHexAppend(U8_a *line, MemoryTraceRecord *record) {
+    static constexpr U8 HEX_DIGITS[] = "0123456789abcdef";
+
+    U8 hex[2 * sizeof(MemoryTraceRecord)];
+    U8 *bytes = (U8 *)record;
+    for (U64 i = 0; i < sizeof(MemoryTraceRecord); i++) {
+        hex[2 * i] = HEX_DIGITS[bytes[i] >> 4];
+        hex[(2 * i) + 1] = HEX_DIGITS[bytes[i] & 0xF];
+    }
+
+    KLOG_APPEND(line, STRING_LEN(hex, sizeof(hex)));
+    KLOG_APPEND(line, STRING("\n"));
+}
+
+// Every record is written as its own line of hex, byte by byte as it is in
+// memory. The begin line holds the index of the first record, the number of
+// records that follow, and the number of records dropped so far.
+void memoryTraceExport() {
+    U8 lineBuffer[MEMORY_TRACE_LINE_BYTES];
+    U8_a line = {.buf = lineBuffer, .len = 0};
+
+    U64 records = memoryTrace.recorded - memoryTrace.exported;
+
+    KLOG_APPEND(&line, STRING("MEMORY TRACE BEGIN "));
+    KLOG_APPEND(&line, memoryTrace.exported);
+    KLOG_APPEND(&line, STRING(" "));
+    KLOG_APPEND(&line, records);
+    KLOG_APPEND(&line, STRING(" "));
+    KLOG_APPEND(&line, memoryTrace.dropped);
+    KLOG_APPEND(&line, STRING("\n"));
+    logSerialFlush(line);
+    line.len = 0;
+
+    for (U64 i = 0; i < records; i++) {
+        recordHexAppend(
+            &line, &memoryTrace.records[ringBufferIndex(
+                       memoryTrace.exported + i, memoryTrace.capacity)]);
+        logSerialFlush(line);
+        line.len = 0;
+    }
+    memoryTrace.exported += records;
+
+    KLOG_APPEND(&line, STRING("MEMORY TRACE END\n"));
+    logSerialFlush(line);
+}
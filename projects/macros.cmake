@@ -49,3 +49,14 @@ macro(add_header_for_target project)
         )
     endif()
 endmacro()
+
+# NOTE: For code that runs in interrupt handlers that do not save the vector
+# state, see x86/kernel/code/idt/src/isr.S.
+macro(general_registers_only)
+    if(${ENVIRONMENT} STREQUAL "FREESTANDING")
+        target_compile_options(
+            ${PROJECT_NAME}
+            PRIVATE $<$<COMPILE_LANGUAGE:C>:-mgeneral-regs-only>
+        )
+    endif()
+endmacro()
@@ -6,7 +6,6 @@
 #include "abstraction/thread.h"
 #include "efi-to-kernel/kernel-parameters.h"  // for KernelParameters
 #include "efi-to-kernel/memory/definitions.h" // for STACK_SIZE
-#include "efi/acpi/rdsp.h"                    // for RSDPGet, RSDP...
 #include "efi/error.h"
 #include "efi/firmware/base.h" // for PhysicalAddress
 #include "efi/firmware/block-io.h"
@@ -184,8 +183,10 @@ Status efi_main(Handle handle, SystemTable *systemtable) {
     }
 
     KFLUSH_AFTER { INFO(STRING("Setting up thread stack...\n")); }
-    StackResult stackResult =
-        stackCreateAndMap(virtualForKernel, KERNEL_STACK_SIZE, true);
+    // NOTE: Backed fully, a fault to grow this stack could otherwise land
+    // inside the memory managers while they hold their locks.
+    StackResult stackResult = stackCreateAndMap(
+        virtualForKernel, KERNEL_STACK_SIZE, KERNEL_STACK_SIZE, true);
     virtualForKernel = stackResult.virtualMemoryFirstAvailable;
 
     KFLUSH_AFTER { INFO(STRING("Setting up kernel parameters...\n")); }
@@ -209,13 +210,9 @@ Status efi_main(Handle handle, SystemTable *systemtable) {
                  .scanline = gop->mode->info->pixelsPerScanLine};
 
     KFLUSH_AFTER { INFO(STRING("Filling specific arch params...\n")); }
-    archParamsFill(kernelParams->archParams, virtualForKernel);
-
-    RSDPResult rsdp = RSDPGet(globals.st->number_of_table_entries,
-                              globals.st->configuration_table);
-    if (!rsdp.rsdp) {
-        EXIT_WITH_MESSAGE { ERROR(STRING("Could not find an RSDP!\n")); }
-    }
+    virtualForKernel =
+        archParamsFill(kernelParams->archParams, virtualForKernel,
+                       stackResult.stackVirtualTop);
 
     if (virtualForKernel >= endVirtualForKernel) {
         EXIT_WITH_MESSAGE {
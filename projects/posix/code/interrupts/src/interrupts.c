@@ -0,0 +1,9 @@
+#include "abstraction/interrupts.h"
+
+// NOTE: User space cannot change the interrupt flag and nothing interrupts the
+// hosted code the way the kernel is interrupted, so there is nothing to mask.
+void interruptsEnable() {}
+
+void interruptsDisable() {}
+
+bool interruptsEnabled() { return false; }
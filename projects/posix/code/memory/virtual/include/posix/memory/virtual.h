@@ -0,0 +1,37 @@
+#ifndef POSIX_MEMORY_VIRTUAL_H
+#define POSIX_MEMORY_VIRTUAL_H
+
+#include "shared/types/numeric.h"
+
+// Runs the memory management of the kernel inside a normal process. Physical
+// memory is a shared memory file that is mapped once as identity memory.
+// Virtual memory is a reserved range of the process that only becomes
+// accessible where the simulated page table maps it, onto the same file. So,
+// the data in mapped memory behaves the same as in the kernel.
+typedef struct {
+    int file;
+    U64 physicalStart;
+    U64 physicalBytes;
+    U64 virtualStart;
+    U64 virtualBytes;
+
+    U64 pageFaults;
+    U64 pagesMapped;
+    U64 pagesUnmapped;
+    U64 pageCacheEntriesFlushed;
+    U64 pageCacheFullFlushes;
+} HostedMemory;
+
+extern HostedMemory hostedMemory;
+
+// Sets up the physical and virtual buddies, the virtual ranges and the mapping
+// sizes through memoryManagersInit, and installs the page fault driver. Both
+// sizes are rounded up to a GiB. Returns false if the host refused the memory.
+[[nodiscard]] bool hostedMemoryInit(U64 physicalBytes, U64 virtualBytes);
+
+// Turns segmentation faults in the virtual range into calls to
+// pageFaultHandle, like the page fault interrupt does in the kernel. Faults
+// anywhere else, or in a guard page, still crash the process.
+[[nodiscard]] bool hostedPageFaultsInstall();
+
+#endif
@@ -0,0 +1,36 @@
+#include "posix/memory/virtual.h"
+
+#include "shared/memory/management/page.h"
+#include "shared/types/numeric.h"
+
+#include <signal.h>
+
+static void pageFaultHostedHandle(int signalNumber, siginfo_t *info,
+                                  void *context) {
+    (void)context;
+
+    U64 faultingAddress = (U64)info->si_addr;
+    if (faultingAddress >= hostedMemory.virtualStart &&
+        faultingAddress <
+            hostedMemory.virtualStart + hostedMemory.virtualBytes) {
+        hostedMemory.pageFaults++;
+        if (pageFaultHandle(faultingAddress) != GUARD_PAGE_SIZE) {
+            return;
+        }
+    }
+
+    // NOTE: Returning retries the access, which now faults with the default
+    // handler in place.
+    signal(signalNumber, SIG_DFL);
+}
+
+// NOTE: Like the interrupt, a fault while handling a fault has to reach the
+// handler again instead of killing the process.
+bool hostedPageFaultsInstall() {
+    struct sigaction action = {0};
+    action.sa_sigaction = pageFaultHostedHandle;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+
+    return !sigaction(SIGSEGV, &action, nullptr);
+}
@@ -0,0 +1,269 @@
+#define _GNU_SOURCE // Required for memfd_create
+
+#include "posix/memory/virtual.h"
+
+#include "abstraction/jmp.h"
+#include "abstraction/memory/manipulation.h"
+#include "abstraction/memory/virtual/converter.h"
+#include "abstraction/memory/virtual/map.h"
+#include "efi-to-kernel/kernel-parameters.h"
+#include "shared/assert.h"
+#include "shared/maths.h"
+#include "shared/memory/allocator/buddy.h"
+#include "shared/memory/allocator/node.h"
+#include "shared/memory/management/definitions.h"
+#include "shared/memory/management/init.h"
+#include "shared/memory/management/management.h"
+#include "shared/memory/policy.h"
+#include "shared/memory/sizes.h"
+#include "shared/types/numeric.h"
+
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+HostedMemory hostedMemory;
+
+static constexpr auto PAGE_TABLE_ENTRIES = 512;
+static constexpr U64_pow2 PAGE_ROOT_ENTRY_SIZE = 512 * GiB;
+// NOTE: Lower tables are page aligned, so the lowest bit tells a mapped entry
+// apart from a lower table.
+static constexpr U64 PAGE_ENTRY_MAPPED = 1;
+
+typedef struct {
+    U64 entries[PAGE_TABLE_ENTRIES];
+} SimulatedPageTable;
+static_assert(sizeof(SimulatedPageTable) == 4 * KiB);
+
+static SimulatedPageTable *simulatedPageTableRoot;
+
+// NOTE: Tables come from identity memory, like on real hardware, but are not
+// given back when they become empty.
+static SimulatedPageTable *pageTableZeroedGet() {
+    SimulatedPageTable *result =
+        identityMemoryAlloc(sizeof(SimulatedPageTable));
+    memset(result, 0, sizeof(SimulatedPageTable));
+    return result;
+}
+
+static U16 calculateTableIndex(U64 virt, U64_pow2 entrySize) {
+    return (U16)ringBufferIndex(dividePowerOf2(virt, entrySize),
+                                PAGE_TABLE_ENTRIES);
+}
+
+static void hostMap(U64 virt, U64 physical, U64 bytes) {
+    void *result = mmap((void *)virt, bytes, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_FIXED, hostedMemory.file,
+                        (off_t)(physical - hostedMemory.physicalStart));
+    ASSERT(result != MAP_FAILED);
+    (void)result;
+}
+
+static void hostUnmap(U64 virt, U64 bytes) {
+    void *result =
+        mmap((void *)virt, bytes, PROT_NONE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+    ASSERT(result != MAP_FAILED);
+    (void)result;
+}
+
+// NOTE: Flags are not simulated, the host maps everything read-write.
+void pageMap_(U64 virt, U64 physical, U64_pow2 mappingSize, U64 flags) {
+    ASSERT(simulatedPageTableRoot);
+    ASSERT(!(ringBufferIndex(physical, mappingSize)));
+    ASSERT(mappingSize & pageSizesAvailableMask());
+    ASSERT(virt >= hostedMemory.virtualStart &&
+           virt + mappingSize <=
+               hostedMemory.virtualStart + hostedMemory.virtualBytes);
+    (void)flags;
+
+    SimulatedPageTable *pageTable = simulatedPageTableRoot;
+    for (U64_pow2 entrySize = PAGE_ROOT_ENTRY_SIZE; entrySize >= mappingSize;
+         entrySize /= PAGE_TABLE_ENTRIES) {
+        U64 *entry = &pageTable->entries[calculateTableIndex(virt, entrySize)];
+        if (entrySize == mappingSize) {
+            *entry = physical | PAGE_ENTRY_MAPPED;
+            break;
+        }
+
+        if (!(*entry)) {
+            *entry = (U64)pageTableZeroedGet();
+        }
+        pageTable = (SimulatedPageTable *)*entry;
+    }
+
+    hostMap(virt, physical, mappingSize);
+    hostedMemory.pagesMapped++;
+}
+
+Memory pageUnmap(U64 virt) {
+    ASSERT(simulatedPageTableRoot);
+
+    SimulatedPageTable *pageTable = simulatedPageTableRoot;
+    for (U64_pow2 entrySize = PAGE_ROOT_ENTRY_SIZE;
+         entrySize >= pageSizeSmallest(); entrySize /= PAGE_TABLE_ENTRIES) {
+        U64 *entry = &pageTable->entries[calculateTableIndex(virt, entrySize)];
+        if (!(*entry)) {
+            return (Memory){.start = 0, .bytes = entrySize};
+        }
+
+        if (*entry & PAGE_ENTRY_MAPPED) {
+            U64 physical = *entry & ~PAGE_ENTRY_MAPPED;
+            *entry = 0;
+
+            hostUnmap(alignDown(virt, entrySize), entrySize);
+            hostedMemory.pagesUnmapped++;
+
+            return (Memory){.start = physical, .bytes = entrySize};
+        }
+
+        pageTable = (SimulatedPageTable *)*entry;
+    }
+
+    __builtin_unreachable();
+}
+
+bool pageMapped(U64 virt) {
+    ASSERT(simulatedPageTableRoot);
+
+    SimulatedPageTable *pageTable = simulatedPageTableRoot;
+    for (U64_pow2 entrySize = PAGE_ROOT_ENTRY_SIZE;
+         entrySize >= pageSizeSmallest(); entrySize /= PAGE_TABLE_ENTRIES) {
+        U64 entry = pageTable->entries[calculateTableIndex(virt, entrySize)];
+        if (!entry) {
+            return false;
+        }
+
+        if (entry & PAGE_ENTRY_MAPPED) {
+            return true;
+        }
+
+        pageTable = (SimulatedPageTable *)entry;
+    }
+
+    __builtin_unreachable();
+}
+
+// NOTE: The host mapping is already gone once pageUnmap returns, so flushing
+// only counts what the kernel would have flushed.
+void pageCacheEntryFlush(U64 virt) {
+    (void)virt;
+    hostedMemory.pageCacheEntriesFlushed++;
+}
+
+void pageCacheFlush() { hostedMemory.pageCacheFullFlushes++; }
+
+void pageCacheEntriesShootdown(U64 *virts, U32 len) {
+    if (len >= PAGE_CACHE_FLUSH_THRESHOLD) {
+        pageCacheShootdown();
+        return;
+    }
+
+    for (typeof(len) i = 0; i < len; i++) {
+        pageCacheEntryFlush(virts[i]);
+    }
+}
+
+void pageCacheShootdown() { pageCacheFlush(); }
+
+// Reserves a GiB more than asked, so the start can be aligned to a GiB and
+// the largest pages can be used.
+static U64 hostRegionReserve(U64 bytes) {
+    void *reserved =
+        mmap(nullptr, bytes + 1 * GiB, PROT_NONE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reserved == MAP_FAILED) {
+        return 0;
+    }
+    return alignUp((U64)reserved, 1 * GiB);
+}
+
+static bool buddyDataCreate(BuddyData *data, Exponent blockSizeLargest,
+                            Memory memory) {
+    Exponent orderCount = buddyOrderCountOnLargestPageSize(blockSizeLargest);
+    U64 *backingBuffer = calloc(
+        orderCount * BUDDY_BLOCKS_CAPACITY_PER_ORDER_DEFAULT, sizeof(U64));
+    if (!backingBuffer) {
+        return false;
+    }
+
+    Buddy buddy;
+    buddyInit(&buddy, backingBuffer, BUDDY_BLOCKS_CAPACITY_PER_ORDER_DEFAULT,
+              orderCount);
+    if (setjmp(buddy.backingBufferExhausted)) {
+        return false;
+    }
+    buddyFree(&buddy, memory);
+
+    *data = buddy.data;
+    return true;
+}
+
+static constexpr auto INITIAL_VIRTUAL_MAPPING_SIZES = 1024;
+
+bool hostedMemoryInit(U64 physicalBytes, U64 virtualBytes) {
+    physicalBytes = alignUp(physicalBytes, 1 * GiB);
+    virtualBytes = alignUp(virtualBytes, 1 * GiB);
+
+    int file = memfd_create("physical", 0);
+    if (file < 0 || ftruncate(file, (off_t)physicalBytes)) {
+        return false;
+    }
+
+    U64 physicalStart = hostRegionReserve(physicalBytes);
+    U64 virtualStart = hostRegionReserve(virtualBytes);
+    if (!physicalStart || !virtualStart ||
+        mmap((void *)physicalStart, physicalBytes, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, file, 0) == MAP_FAILED) {
+        return false;
+    }
+
+    hostedMemory = (HostedMemory){.file = file,
+                                  .physicalStart = physicalStart,
+                                  .physicalBytes = physicalBytes,
+                                  .virtualStart = virtualStart,
+                                  .virtualBytes = virtualBytes};
+    if (!hostedPageFaultsInstall()) {
+        return false;
+    }
+
+    // NOTE: The root is taken before the physical buddy exists, because
+    // memoryManagersInit already maps memory.
+    physicalBytes -= sizeof(SimulatedPageTable);
+    simulatedPageTableRoot =
+        (SimulatedPageTable *)(physicalStart + physicalBytes);
+    memset(simulatedPageTableRoot, 0, sizeof(SimulatedPageTable));
+
+    KernelMemory kernelMemory = {.physicalMemoryTotal = physicalBytes};
+    if (!buddyDataCreate(
+            &kernelMemory.buddyPhysical, BUDDY_PHYSICAL_PAGE_SIZE_MAX,
+            (Memory){.start = physicalStart, .bytes = physicalBytes}) ||
+        !buddyDataCreate(
+            &kernelMemory.buddyVirtual, BUDDY_VIRTUAL_PAGE_SIZE_MAX,
+            (Memory){.start = virtualStart, .bytes = virtualBytes})) {
+        return false;
+    }
+
+    void *nodes = calloc(INITIAL_VIRTUAL_MAPPING_SIZES,
+                         sizeof(*kernelMemory.memoryMapperSizes.tree));
+    void *nodesFreeList =
+        calloc(INITIAL_VIRTUAL_MAPPING_SIZES, sizeof(void *));
+    if (!nodes || !nodesFreeList) {
+        return false;
+    }
+
+    kernelMemory.memoryMapperSizes.tree = nullptr;
+    nodeAllocatorInit(
+        &kernelMemory.memoryMapperSizes.nodeAllocator,
+        (void_a){.buf = nodes,
+                 .len = INITIAL_VIRTUAL_MAPPING_SIZES *
+                        sizeof(*kernelMemory.memoryMapperSizes.tree)},
+        (void_a){.buf = nodesFreeList,
+                 .len = INITIAL_VIRTUAL_MAPPING_SIZES * sizeof(void *)},
+        sizeof(*kernelMemory.memoryMapperSizes.tree),
+        alignof(*kernelMemory.memoryMapperSizes.tree));
+
+    memoryManagersInit(&kernelMemory);
+
+    return true;
+}
@@ -7,6 +7,7 @@
 #include "shared/log.h"
 #include "shared/macros.h"      // for MACRO_VAR
 #include "shared/text/string.h" // for string
+#include "shared/types/numeric.h"
 
 void testSuiteStart(String mainTopic);
 [[nodiscard]] int testSuiteFinish();
@@ -23,6 +24,9 @@ void cleanupHandler();
 void testFailureStartAppend();
 void testFailureFinishAppend();
 
+// Fails the current test if the counts differ, counted names what was counted.
+void testCountEqual(String counted, U64 expected, U64 actual);
+
 #define TEST_FAILURE                                                           \
     for (auto MACRO_VAR(i) = (testFailure(), testFailureStartAppend(), 0);     \
          MACRO_VAR(i) < 1;                                                     \
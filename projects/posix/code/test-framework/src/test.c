@@ -146,3 +146,16 @@ void testFailureFinishAppend() {
     PLOG((STRING("----------------------------------------------------"
                  "----------------------------\n")));
 }
+
+void testCountEqual(String counted, U64 expected, U64 actual) {
+    if (expected != actual) {
+        TEST_FAILURE {
+            INFO(STRING("Incorrect number of "));
+            INFO(counted, .flags = NEWLINE);
+            INFO(STRING("Expected: "));
+            INFO(expected, .flags = NEWLINE);
+            INFO(STRING("Actual: "));
+            INFO(actual, .flags = NEWLINE);
+        }
+    }
+}
@@ -25,6 +25,13 @@ else()
     add_compile_definitions(NO_SERIAL)
 endif()
 
+option(MEMORY_TRACE "Turn on/off recording allocations and page faults" OFF)
+if(${MEMORY_TRACE})
+    add_compile_definitions(MEMORY_TRACE)
+else()
+    add_compile_definitions(NO_MEMORY_TRACE)
+endif()
+
 set(VALID_BUILDS "UNIT_TEST" "PROJECT")
 list(FIND VALID_BUILDS ${BUILD} BUILD_INDEX)
 if(BUILD_INDEX EQUAL -1)
@@ -94,7 +101,7 @@ if(CMAKE_BUILD_TYPE STREQUAL "FUZZING" OR CMAKE_BUILD_TYPE STREQUAL "DEBUG")
     add_compile_definitions(DEBUG)
 endif()
 if(CMAKE_BUILD_TYPE STREQUAL "PROFILING")
-    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -pg -O2 -pg")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -pg -O2 -pg -fno-omit-frame-pointer")
     add_compile_definitions(PROFILING)
 endif()
 if(CMAKE_BUILD_TYPE STREQUAL "RELEASE")
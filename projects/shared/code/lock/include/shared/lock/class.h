@@ -0,0 +1,42 @@
+#ifndef SHARED_LOCK_CLASS_H
+#define SHARED_LOCK_CLASS_H
+
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+
+// Locks that protect the same kind of structure share a class. In DEBUG
+// builds, every acquire is accounted to its class so it is visible which
+// structure serialises the processors. The numbers are in cycles.
+typedef struct LockClass {
+    String name;
+    U64 acquires;
+    U64 contended; // Acquires that did not get the lock at the first attempt
+    U64 spinCycles;
+    U64 holdCycles;
+    struct LockClass *next;
+    bool registered;
+} LockClass;
+
+#define LOCK_CLASS(nameLiteral) ((LockClass){.name = STRING(nameLiteral)})
+
+// NOTE: The statistics are only kept in DEBUG builds, so the fields and the
+// accounting cost nothing otherwise.
+#ifdef DEBUG
+#define LOCK_STATISTICS                                                        \
+    LockClass *lockClass;                                                      \
+    U64 acquiredCycles;
+#else
+#define LOCK_STATISTICS
+#endif
+
+void lockClassRegister(LockClass *lockClass);
+
+[[nodiscard]] U64 lockSpinStart();
+void lockAcquired(LockClass *lockClass, U64 spinStart, bool contended,
+                  U64 *acquiredCycles);
+void lockReleased(LockClass *lockClass, U64 acquiredCycles);
+
+// NOTE: Does nothing outside of DEBUG builds.
+void lockClassesLog();
+
+#endif
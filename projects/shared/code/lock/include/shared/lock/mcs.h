@@ -0,0 +1,34 @@
+#ifndef SHARED_LOCK_MCS_H
+#define SHARED_LOCK_MCS_H
+
+#include "shared/lock/class.h"
+#include "shared/types/numeric.h"
+
+// Queue lock where every waiter spins on its own node, so a release only
+// touches the cache line of the next waiter. Fair like the TicketLock, but
+// the caller provides a node that must stay alive until the release.
+typedef struct __attribute__((aligned(64))) MCSNode {
+    struct MCSNode *next;
+    U32 waiting;
+} MCSNode;
+
+typedef struct {
+    MCSNode *tail;
+    LOCK_STATISTICS
+} MCSLock;
+
+void MCSLockInit(MCSLock *queueLock, LockClass *lockClass);
+
+void MCSLockAcquire(MCSLock *queueLock, MCSNode *node);
+[[nodiscard]] bool MCSLockTryAcquire(MCSLock *queueLock, MCSNode *node);
+// NOTE: Pass the same node that was used to acquire the lock.
+void MCSLockRelease(MCSLock *queueLock, MCSNode *node);
+
+// NOTE: For locks that are also taken in interrupt handlers. Pass the returned
+// value to the release.
+[[nodiscard]] bool MCSLockAcquireInterruptsDisable(MCSLock *queueLock,
+                                                   MCSNode *node);
+void MCSLockReleaseInterruptsRestore(MCSLock *queueLock, MCSNode *node,
+                                     bool interruptsWereEnabled);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef SHARED_LOCK_SPIN_H
+#define SHARED_LOCK_SPIN_H
+
+#include "shared/lock/class.h"
+#include "shared/types/numeric.h"
+
+// Test-and-test-and-set lock. Waiters spin on a plain load so the cache line
+// is only written when the lock looks free. Not fair, use a TicketLock if
+// waiters may starve.
+typedef struct {
+    U32 locked;
+    LOCK_STATISTICS
+} SpinLock;
+
+void spinLockInit(SpinLock *spinLock, LockClass *lockClass);
+
+void spinLockAcquire(SpinLock *spinLock);
+[[nodiscard]] bool spinLockTryAcquire(SpinLock *spinLock);
+void spinLockRelease(SpinLock *spinLock);
+
+// NOTE: For locks that are also taken in interrupt handlers. Pass the returned
+// value to the release.
+[[nodiscard]] bool spinLockAcquireInterruptsDisable(SpinLock *spinLock);
+void spinLockReleaseInterruptsRestore(SpinLock *spinLock,
+                                      bool interruptsWereEnabled);
+
+#endif
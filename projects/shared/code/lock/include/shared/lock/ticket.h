@@ -0,0 +1,28 @@
+#ifndef SHARED_LOCK_TICKET_H
+#define SHARED_LOCK_TICKET_H
+
+#include "shared/lock/class.h"
+#include "shared/types/numeric.h"
+
+// Fair lock, processors get the lock in the order they asked for it. All
+// waiters spin on the same cache line, so prefer an MCSLock for locks that are
+// heavily contended by many processors.
+typedef struct {
+    U32 next;
+    U32 serving;
+    LOCK_STATISTICS
+} TicketLock;
+
+void ticketLockInit(TicketLock *ticketLock, LockClass *lockClass);
+
+void ticketLockAcquire(TicketLock *ticketLock);
+[[nodiscard]] bool ticketLockTryAcquire(TicketLock *ticketLock);
+void ticketLockRelease(TicketLock *ticketLock);
+
+// NOTE: For locks that are also taken in interrupt handlers. Pass the returned
+// value to the release.
+[[nodiscard]] bool ticketLockAcquireInterruptsDisable(TicketLock *ticketLock);
+void ticketLockReleaseInterruptsRestore(TicketLock *ticketLock,
+                                        bool interruptsWereEnabled);
+
+#endif
@@ -0,0 +1,60 @@
+#include "shared/lock/class.h"
+
+#include "abstraction/time.h"
+#include "shared/log.h"
+
+static LockClass *lockClasses = nullptr;
+
+void lockClassRegister(LockClass *lockClass) {
+    if (__atomic_exchange_n(&lockClass->registered, true, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    lockClass->next = __atomic_load_n(&lockClasses, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&lockClasses, &lockClass->next,
+                                        lockClass, true, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED)) {
+        ;
+    }
+}
+
+U64 lockSpinStart() { return cycleCounterGet(false, false); }
+
+// NOTE: Different locks of the same class can be held by different processors
+// at the same time, so the counters are updated atomically.
+void lockAcquired(LockClass *lockClass, U64 spinStart, bool contended,
+                  U64 *acquiredCycles) {
+    *acquiredCycles = cycleCounterGet(false, false);
+
+    __atomic_fetch_add(&lockClass->acquires, 1, __ATOMIC_RELAXED);
+    if (contended) {
+        __atomic_fetch_add(&lockClass->contended, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&lockClass->spinCycles, *acquiredCycles - spinStart,
+                           __ATOMIC_RELAXED);
+    }
+}
+
+void lockReleased(LockClass *lockClass, U64 acquiredCycles) {
+    __atomic_fetch_add(&lockClass->holdCycles,
+                       cycleCounterGet(false, false) - acquiredCycles,
+                       __ATOMIC_RELAXED);
+}
+
+void lockClassesLog() {
+#ifdef DEBUG
+    for (LockClass *lockClass =
+             __atomic_load_n(&lockClasses, __ATOMIC_ACQUIRE);
+         lockClass; lockClass = lockClass->next) {
+        INFO(lockClass->name);
+        INFO(STRING(" acquires: "));
+        INFO(__atomic_load_n(&lockClass->acquires, __ATOMIC_RELAXED));
+        INFO(STRING(" contended: "));
+        INFO(__atomic_load_n(&lockClass->contended, __ATOMIC_RELAXED));
+        INFO(STRING(" spin cycles: "));
+        INFO(__atomic_load_n(&lockClass->spinCycles, __ATOMIC_RELAXED));
+        INFO(STRING(" hold cycles: "));
+        INFO(__atomic_load_n(&lockClass->holdCycles, __ATOMIC_RELAXED),
+             .flags = NEWLINE);
+    }
+#endif
+}
@@ -0,0 +1,94 @@
+#include "shared/lock/mcs.h"
+
+#include "abstraction/interrupts.h"
+#include "abstraction/thread.h"
+
+void MCSLockInit(MCSLock *queueLock, LockClass *lockClass) {
+    queueLock->tail = nullptr;
+#ifdef DEBUG
+    lockClassRegister(lockClass);
+    queueLock->lockClass = lockClass;
+    queueLock->acquiredCycles = 0;
+#else
+    (void)lockClass;
+#endif
+}
+
+void MCSLockAcquire(MCSLock *queueLock, MCSNode *node) {
+#ifdef DEBUG
+    U64 spinStart = lockSpinStart();
+#endif
+
+    node->next = nullptr;
+    node->waiting = 1;
+
+    MCSNode *previous = __atomic_exchange_n(&queueLock->tail, node,
+                                            __ATOMIC_ACQ_REL);
+    bool contended = previous != nullptr;
+    if (contended) {
+        __atomic_store_n(&previous->next, node, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&node->waiting, __ATOMIC_ACQUIRE)) {
+            spinWaitHint();
+        }
+    }
+
+#ifdef DEBUG
+    lockAcquired(queueLock->lockClass, spinStart, contended,
+                 &queueLock->acquiredCycles);
+#endif
+}
+
+bool MCSLockTryAcquire(MCSLock *queueLock, MCSNode *node) {
+    node->next = nullptr;
+    node->waiting = 0;
+
+    MCSNode *expected = nullptr;
+    if (!__atomic_compare_exchange_n(&queueLock->tail, &expected, node, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return false;
+    }
+
+#ifdef DEBUG
+    lockAcquired(queueLock->lockClass, 0, false, &queueLock->acquiredCycles);
+#endif
+    return true;
+}
+
+void MCSLockRelease(MCSLock *queueLock, MCSNode *node) {
+#ifdef DEBUG
+    lockReleased(queueLock->lockClass, queueLock->acquiredCycles);
+#endif
+
+    MCSNode *next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    if (!next) {
+        MCSNode *expected = node;
+        if (__atomic_compare_exchange_n(&queueLock->tail, &expected, nullptr,
+                                        false, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED)) {
+            return;
+        }
+
+        // NOTE: A waiter swapped itself in as the tail but did not link
+        // itself to this node yet.
+        while (!(next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE))) {
+            spinWaitHint();
+        }
+    }
+
+    __atomic_store_n(&next->waiting, 0, __ATOMIC_RELEASE);
+}
+
+bool MCSLockAcquireInterruptsDisable(MCSLock *queueLock, MCSNode *node) {
+    bool interruptsWereEnabled = interruptsEnabled();
+    interruptsDisable();
+    MCSLockAcquire(queueLock, node);
+    return interruptsWereEnabled;
+}
+
+void MCSLockReleaseInterruptsRestore(MCSLock *queueLock, MCSNode *node,
+                                     bool interruptsWereEnabled) {
+    MCSLockRelease(queueLock, node);
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+}
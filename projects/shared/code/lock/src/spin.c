@@ -0,0 +1,98 @@
+#include "shared/lock/spin.h"
+
+#include "abstraction/interrupts.h"
+#include "abstraction/thread.h"
+
+void spinLockInit(SpinLock *spinLock, LockClass *lockClass) {
+    spinLock->locked = 0;
+#ifdef DEBUG
+    lockClassRegister(lockClass);
+    spinLock->lockClass = lockClass;
+    spinLock->acquiredCycles = 0;
+#else
+    (void)lockClass;
+#endif
+}
+
+static bool spinLockAttempt(SpinLock *spinLock) {
+    return !__atomic_exchange_n(&spinLock->locked, 1, __ATOMIC_ACQUIRE);
+}
+
+void spinLockAcquire(SpinLock *spinLock) {
+#ifdef DEBUG
+    U64 spinStart = lockSpinStart();
+#endif
+
+    bool contended = false;
+    while (!spinLockAttempt(spinLock)) {
+        contended = true;
+        while (__atomic_load_n(&spinLock->locked, __ATOMIC_RELAXED)) {
+            spinWaitHint();
+        }
+    }
+
+#ifdef DEBUG
+    lockAcquired(spinLock->lockClass, spinStart, contended,
+                 &spinLock->acquiredCycles);
+#else
+    (void)contended;
+#endif
+}
+
+bool spinLockTryAcquire(SpinLock *spinLock) {
+    if (__atomic_load_n(&spinLock->locked, __ATOMIC_RELAXED) ||
+        !spinLockAttempt(spinLock)) {
+        return false;
+    }
+
+#ifdef DEBUG
+    lockAcquired(spinLock->lockClass, 0, false, &spinLock->acquiredCycles);
+#endif
+    return true;
+}
+
+void spinLockRelease(SpinLock *spinLock) {
+#ifdef DEBUG
+    lockReleased(spinLock->lockClass, spinLock->acquiredCycles);
+#endif
+    __atomic_store_n(&spinLock->locked, 0, __ATOMIC_RELEASE);
+}
+
+// NOTE: Waits with interrupts as they were, only the holder has them disabled.
+// The holder may be waiting on this processor, e.g., for a page cache
+// shootdown, which it could otherwise never take.
+bool spinLockAcquireInterruptsDisable(SpinLock *spinLock) {
+    bool interruptsWereEnabled = interruptsEnabled();
+#ifdef DEBUG
+    U64 spinStart = lockSpinStart();
+#endif
+
+    bool contended = false;
+    interruptsDisable();
+    while (!spinLockAttempt(spinLock)) {
+        contended = true;
+        if (interruptsWereEnabled) {
+            interruptsEnable();
+        }
+        while (__atomic_load_n(&spinLock->locked, __ATOMIC_RELAXED)) {
+            spinWaitHint();
+        }
+        interruptsDisable();
+    }
+
+#ifdef DEBUG
+    lockAcquired(spinLock->lockClass, spinStart, contended,
+                 &spinLock->acquiredCycles);
+#else
+    (void)contended;
+#endif
+    return interruptsWereEnabled;
+}
+
+void spinLockReleaseInterruptsRestore(SpinLock *spinLock,
+                                      bool interruptsWereEnabled) {
+    spinLockRelease(spinLock);
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+}
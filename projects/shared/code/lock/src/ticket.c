@@ -0,0 +1,77 @@
+#include "shared/lock/ticket.h"
+
+#include "abstraction/interrupts.h"
+#include "abstraction/thread.h"
+
+void ticketLockInit(TicketLock *ticketLock, LockClass *lockClass) {
+    ticketLock->next = 0;
+    ticketLock->serving = 0;
+#ifdef DEBUG
+    lockClassRegister(lockClass);
+    ticketLock->lockClass = lockClass;
+    ticketLock->acquiredCycles = 0;
+#else
+    (void)lockClass;
+#endif
+}
+
+void ticketLockAcquire(TicketLock *ticketLock) {
+#ifdef DEBUG
+    U64 spinStart = lockSpinStart();
+#endif
+
+    U32 ticket = __atomic_fetch_add(&ticketLock->next, 1, __ATOMIC_RELAXED);
+
+    bool contended = false;
+    while (__atomic_load_n(&ticketLock->serving, __ATOMIC_ACQUIRE) != ticket) {
+        contended = true;
+        spinWaitHint();
+    }
+
+#ifdef DEBUG
+    lockAcquired(ticketLock->lockClass, spinStart, contended,
+                 &ticketLock->acquiredCycles);
+#else
+    (void)contended;
+#endif
+}
+
+bool ticketLockTryAcquire(TicketLock *ticketLock) {
+    U32 serving = __atomic_load_n(&ticketLock->serving, __ATOMIC_RELAXED);
+    U32 expected = serving;
+    // NOTE: Only take a ticket if it is the one being served right now.
+    if (!__atomic_compare_exchange_n(&ticketLock->next, &expected, serving + 1,
+                                     false, __ATOMIC_ACQUIRE,
+                                     __ATOMIC_RELAXED)) {
+        return false;
+    }
+
+#ifdef DEBUG
+    lockAcquired(ticketLock->lockClass, 0, false, &ticketLock->acquiredCycles);
+#endif
+    return true;
+}
+
+void ticketLockRelease(TicketLock *ticketLock) {
+#ifdef DEBUG
+    lockReleased(ticketLock->lockClass, ticketLock->acquiredCycles);
+#endif
+    // NOTE: Only the holder writes serving, so no read-modify-write is needed.
+    __atomic_store_n(&ticketLock->serving, ticketLock->serving + 1,
+                     __ATOMIC_RELEASE);
+}
+
+bool ticketLockAcquireInterruptsDisable(TicketLock *ticketLock) {
+    bool interruptsWereEnabled = interruptsEnabled();
+    interruptsDisable();
+    ticketLockAcquire(ticketLock);
+    return interruptsWereEnabled;
+}
+
+void ticketLockReleaseInterruptsRestore(TicketLock *ticketLock,
+                                        bool interruptsWereEnabled) {
+    ticketLockRelease(ticketLock);
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+}
@@ -0,0 +1,209 @@
+#include "abstraction/jmp.h"
+#include "abstraction/log.h"
+#include "posix/log.h"
+#include "posix/test-framework/test.h"
+#include "shared/lock/class.h"
+#include "shared/lock/mcs.h"
+#include "shared/lock/spin.h"
+#include "shared/lock/ticket.h"
+#include "shared/log.h"
+#include "shared/macros.h"
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+
+#include <pthread.h>
+
+static constexpr auto THREADS = 4;
+static constexpr auto INCREMENTS_PER_THREAD = 100000;
+
+static LockClass spinLockClass = LOCK_CLASS("spin test");
+static LockClass ticketLockClass = LOCK_CLASS("ticket test");
+static LockClass MCSLockClass = LOCK_CLASS("MCS test");
+
+static SpinLock spinLock;
+static TicketLock ticketLock;
+static MCSLock queueLock;
+
+// NOTE: Not atomic on purpose, only the lock keeps the increments from being
+// lost.
+static volatile U64 counter;
+
+static void *spinLockIncrement(void *argument) {
+    (void)argument;
+    for (U32 i = 0; i < INCREMENTS_PER_THREAD; i++) {
+        spinLockAcquire(&spinLock);
+        counter = counter + 1;
+        spinLockRelease(&spinLock);
+    }
+    return nullptr;
+}
+
+// NOTE: Interrupts are not masked in a hosted process, so this only checks
+// the way it waits.
+static void *spinLockInterruptsDisableIncrement(void *argument) {
+    (void)argument;
+    for (U32 i = 0; i < INCREMENTS_PER_THREAD; i++) {
+        bool interruptsWereEnabled =
+            spinLockAcquireInterruptsDisable(&spinLock);
+        counter = counter + 1;
+        spinLockReleaseInterruptsRestore(&spinLock, interruptsWereEnabled);
+    }
+    return nullptr;
+}
+
+static void *ticketLockIncrement(void *argument) {
+    (void)argument;
+    for (U32 i = 0; i < INCREMENTS_PER_THREAD; i++) {
+        ticketLockAcquire(&ticketLock);
+        counter = counter + 1;
+        ticketLockRelease(&ticketLock);
+    }
+    return nullptr;
+}
+
+static void *MCSLockIncrement(void *argument) {
+    (void)argument;
+    MCSNode node;
+    for (U32 i = 0; i < INCREMENTS_PER_THREAD; i++) {
+        MCSLockAcquire(&queueLock, &node);
+        counter = counter + 1;
+        MCSLockRelease(&queueLock, &node);
+    }
+    return nullptr;
+}
+
+static void testMutualExclusion(void *(*increment)(void *),
+                                LockClass *lockClass) {
+    counter = 0;
+#ifdef DEBUG
+    U64 acquiresBefore = lockClass->acquires;
+#endif
+
+    pthread_t threads[THREADS];
+    for (U32 i = 0; i < THREADS; i++) {
+        if (pthread_create(&threads[i], nullptr, increment, nullptr)) {
+            TEST_FAILURE { INFO(STRING("Could not create thread\n")); }
+        }
+    }
+    for (U32 i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], nullptr);
+    }
+
+    testCountEqual(STRING("increments"), THREADS * INCREMENTS_PER_THREAD,
+                   counter);
+#ifdef DEBUG
+    testCountEqual(STRING("acquires in the lock class"),
+                   THREADS * INCREMENTS_PER_THREAD,
+                   lockClass->acquires - acquiresBefore);
+#else
+    (void)lockClass;
+#endif
+
+    testSuccess();
+}
+
+static void tryAcquireFail(bool acquired) {
+    if (acquired) {
+        TEST_FAILURE { INFO(STRING("Acquired a lock that was held\n")); }
+    }
+}
+
+static void tryAcquireSucceed(bool acquired) {
+    if (!acquired) {
+        TEST_FAILURE { INFO(STRING("Could not acquire a free lock\n")); }
+    }
+}
+
+static void testSpinLockTryAcquire() {
+    spinLockAcquire(&spinLock);
+    tryAcquireFail(spinLockTryAcquire(&spinLock));
+    spinLockRelease(&spinLock);
+
+    tryAcquireSucceed(spinLockTryAcquire(&spinLock));
+    spinLockRelease(&spinLock);
+
+    testSuccess();
+}
+
+static void testTicketLockTryAcquire() {
+    ticketLockAcquire(&ticketLock);
+    tryAcquireFail(ticketLockTryAcquire(&ticketLock));
+    ticketLockRelease(&ticketLock);
+
+    tryAcquireSucceed(ticketLockTryAcquire(&ticketLock));
+    ticketLockRelease(&ticketLock);
+
+    testSuccess();
+}
+
+static void testMCSLockTryAcquire() {
+    MCSNode holder;
+    MCSNode other;
+    MCSLockAcquire(&queueLock, &holder);
+    tryAcquireFail(MCSLockTryAcquire(&queueLock, &other));
+    MCSLockRelease(&queueLock, &holder);
+
+    tryAcquireSucceed(MCSLockTryAcquire(&queueLock, &other));
+    MCSLockRelease(&queueLock, &other);
+
+    testSuccess();
+}
+
+static void testLocks() {
+    spinLockInit(&spinLock, &spinLockClass);
+    ticketLockInit(&ticketLock, &ticketLockClass);
+    MCSLockInit(&queueLock, &MCSLockClass);
+
+    TEST_TOPIC(STRING("Mutual exclusion")) {
+        JumpBuffer failureHandler;
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Spin lock"), failureHandler) {
+                testMutualExclusion(spinLockIncrement, &spinLockClass);
+            }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Spin lock with interrupts disabled"),
+                 failureHandler) {
+                testMutualExclusion(spinLockInterruptsDisableIncrement,
+                                    &spinLockClass);
+            }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Ticket lock"), failureHandler) {
+                testMutualExclusion(ticketLockIncrement, &ticketLockClass);
+            }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("MCS lock"), failureHandler) {
+                testMutualExclusion(MCSLockIncrement, &MCSLockClass);
+            }
+        }
+    }
+
+    TEST_TOPIC(STRING("Try acquire")) {
+        JumpBuffer failureHandler;
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Spin lock"), failureHandler) {
+                testSpinLockTryAcquire();
+            }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Ticket lock"), failureHandler) {
+                testTicketLockTryAcquire();
+            }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("MCS lock"), failureHandler) {
+                testMCSLockTryAcquire();
+            }
+        }
+    }
+}
+
+int main() {
+    testSuiteStart(STRING("Locks"));
+
+    testLocks();
+
+    return testSuiteFinish();
+}
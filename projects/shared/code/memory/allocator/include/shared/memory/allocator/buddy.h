@@ -3,6 +3,7 @@
 
 #include "shared/memory/allocator/arena.h"
 #include "shared/memory/allocator/node.h"
+#include "shared/memory/allocator/trace.h"
 #include "shared/trees/red-black/basic.h"
 #include "shared/types/array-types.h"
 
@@ -22,6 +23,7 @@ typedef struct {
     JumpBuffer memoryExhausted;
     JumpBuffer backingBufferExhausted;
     BuddyData data;
+    MemoryTraceEvent traceEvents; // MEMORY_TRACE_NONE if not traced
 } Buddy;
 
 [[nodiscard]] Exponent
@@ -41,4 +43,9 @@ buddyAllocate(Buddy *buddy, U64_pow2 blockSize);
 // size size! addressStart up and addressEndExclusive down
 void buddyFree(Buddy *buddy, Memory memory);
 
+// Takes exactly the given range out of the free blocks, splitting larger blocks
+// where necessary. Returns false, without changing the buddy, if any part of
+// the range is not free. Same alignment requirements as buddyFree.
+[[nodiscard]] bool buddyRangeClaim(Buddy *buddy, Memory memory);
+
 #endif
@@ -0,0 +1,62 @@
+#ifndef SHARED_MEMORY_ALLOCATOR_RANGE_H
+#define SHARED_MEMORY_ALLOCATOR_RANGE_H
+
+#include "abstraction/jmp.h"
+#include "abstraction/memory/virtual/converter.h"
+#include "shared/macros.h"
+#include "shared/memory/allocator/buddy.h"
+#include "shared/memory/management/definitions.h"
+#include "shared/memory/sizes.h"
+#include "shared/types/numeric.h"
+
+// Hands out exact-size ranges that are carved from larger blocks taken from a
+// buddy allocator. This way, many medium-sized allocations can be packed
+// tightly instead of each one taking a power-of-2 block from the buddy.
+//
+// Freed ranges are not reusable immediately. Their pages may still be in the
+// TLB, so they are collected and only made available again after a single
+// flush once enough of them have accumulated.
+typedef struct {
+    Buddy *buddy;
+    Memory_max_a free;    // Sorted on start address, neighbours are coalesced
+    Memory_max_a pending; // Freed, but can still be in the TLB
+    U64 pendingBytes;
+    U64_pow2 chunkBytes; // Minimum size of blocks taken from the buddy
+    JumpBuffer backingBufferExhausted;
+} RangeAllocator;
+
+static constexpr auto RANGE_PENDING_FLUSH_BYTES_THRESHOLD = 64 * MiB;
+
+void rangeAllocatorInit(RangeAllocator *rangeAllocator, Buddy *buddy,
+                        Memory_a freeBuffer, Memory_a pendingBuffer,
+                        U64_pow2 chunkBytes);
+
+typedef struct {
+    U64_pow2 align;
+    U64 guardBytes; // Unusable gap kept directly below the returned range
+} RangeParams;
+
+[[nodiscard]] void *rangeAllocate_(RangeAllocator *rangeAllocator, U64 bytes,
+                                   RangeParams params);
+void rangeFree_(RangeAllocator *rangeAllocator, Memory memory,
+                RangeParams params);
+
+#define rangeAllocate(rangeAllocator, bytes, ...)                              \
+    ({                                                                         \
+        RangeParams MACRO_VAR(rangeParams) = (RangeParams){                    \
+            .align = pageSizeSmallest(), .guardBytes = 0, __VA_ARGS__};        \
+        rangeAllocate_(rangeAllocator, bytes, MACRO_VAR(rangeParams));         \
+    })
+
+// NOTE: Pass the same guardBytes that were used when allocating.
+#define rangeFree(rangeAllocator, memory, ...)                                 \
+    ({                                                                         \
+        RangeParams MACRO_VAR(rangeParams) = (RangeParams){                    \
+            .align = pageSizeSmallest(), .guardBytes = 0, __VA_ARGS__};        \
+        rangeFree_(rangeAllocator, memory, MACRO_VAR(rangeParams));            \
+    })
+
+// Makes all pending ranges available again after flushing the TLB.
+void rangePendingFlush(RangeAllocator *rangeAllocator);
+
+#endif
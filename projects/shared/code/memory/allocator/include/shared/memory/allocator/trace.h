@@ -0,0 +1,60 @@
+#ifndef SHARED_MEMORY_ALLOCATOR_TRACE_H
+#define SHARED_MEMORY_ALLOCATOR_TRACE_H
+
+#include "shared/memory/management/definitions.h"
+#include "shared/types/numeric.h"
+
+// Every traced buddy has its own allocate, free and claim event, in this order,
+// starting from its first event.
+static constexpr auto MEMORY_TRACE_BUDDY_ALLOCATE = 0;
+static constexpr auto MEMORY_TRACE_BUDDY_FREE = 1;
+static constexpr auto MEMORY_TRACE_BUDDY_CLAIM = 2;
+static constexpr auto MEMORY_TRACE_BUDDY_EVENTS = 3;
+
+typedef enum : U8 {
+    MEMORY_TRACE_NONE = 0,
+    MEMORY_TRACE_PHYSICAL,
+    MEMORY_TRACE_VIRTUAL = MEMORY_TRACE_PHYSICAL + MEMORY_TRACE_BUDDY_EVENTS,
+    MEMORY_TRACE_MAPPING_ADD = MEMORY_TRACE_VIRTUAL + MEMORY_TRACE_BUDDY_EVENTS,
+    MEMORY_TRACE_MAPPING_RESIZE,
+    MEMORY_TRACE_MAPPING_REMOVE,
+    MEMORY_TRACE_PAGE_FAULT,
+} MemoryTraceEvent;
+
+// The bytes are stored as a number of the smallest pages. The page size is only
+// set for mappings and page faults, as an exponent where 0 is a guard page.
+typedef struct {
+    U64 address;
+    U64 pages : 48;
+    U64 pageSizeExponent : 8;
+    U64 event : 8;
+} MemoryTraceRecord;
+static_assert(sizeof(MemoryTraceRecord) == 16);
+
+// Exporting makes room in the ring again. Once a record does not fit, all
+// later ones are dropped too, so the exported records always form an unbroken
+// sequence that can be replayed.
+typedef struct {
+    MemoryTraceRecord *records;
+    U64_pow2 capacity;
+    U64 recorded;
+    U64 exported;
+    U64 dropped;
+} MemoryTrace;
+
+extern MemoryTrace memoryTrace;
+
+// Starts recording into the given ring, capacity has to be a power of 2.
+void memoryTraceInit(MemoryTraceRecord *records, U64_pow2 capacity);
+void memoryTraceRecord(MemoryTraceEvent event, Memory memory,
+                       U64_pow2 pageSize);
+
+#ifdef MEMORY_TRACE
+#define MEMORY_TRACE_RECORD(event, memory, pageSize)                           \
+    memoryTraceRecord(event, memory, pageSize)
+#else
+#define MEMORY_TRACE_RECORD(event, memory, pageSize)                           \
+    ((void)(event), (void)(memory), (void)(pageSize))
+#endif
+
+#endif
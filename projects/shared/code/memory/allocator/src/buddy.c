@@ -1,10 +1,12 @@
 #include "shared/memory/allocator/buddy.h"
 #include "abstraction/memory/virtual/converter.h"
 #include "shared/assert.h"
+#include "shared/macros.h"
 #include "shared/maths.h"
 #include "shared/memory/allocator/arena.h"
 #include "shared/memory/allocator/macros.h"
 #include "shared/memory/allocator/node.h"
+#include "shared/memory/allocator/trace.h"
 #include "shared/memory/management/definitions.h"
 
 static Exponent smallestPageSizeExponent() {
@@ -49,6 +51,13 @@ static bool buddyBlockRemoveTry(Exponent order, U64 buddyAddress,
     return false;
 }
 
+static void buddyTraceRecord(Buddy *buddy, U8 operation, Memory memory) {
+    if (buddy->traceEvents) {
+        MEMORY_TRACE_RECORD(
+            (MemoryTraceEvent)(buddy->traceEvents + operation), memory, 0);
+    }
+}
+
 static U64 getBuddyAddress(U64 address, U64_pow2 blockSize) {
     return (address ^ (blockSize));
 }
@@ -87,33 +96,41 @@ void *buddyAllocate(Buddy *buddy, U64_pow2 blockSize) {
         blocks->len++;
     }
 
+    buddyTraceRecord(buddy, MEMORY_TRACE_BUDDY_ALLOCATE,
+                     (Memory){.start = address, .bytes = blockSize});
     return (void *)address;
 }
 
+// Largest block that fits the remaining range given the alignment constraints
+static Exponent buddyChunkOrder(Buddy *buddy, U64 memoryAddress,
+                                U64 memoryEnd) {
+    Exponent maxOrder = buddyOrderMax(buddy);
+    Exponent bias = maxOrder + ((sizeof(U64) * BITS_PER_BYTE) -
+                                (buddy->data.blockSizeLargest) - 1);
+
+    Exponent result = MIN(
+        maxOrder,
+        (Exponent)(bias - (__builtin_clzll(memoryEnd - memoryAddress))));
+    if (memoryAddress) {
+        result = MIN(result, (Exponent)__builtin_ctzll(memoryAddress) -
+                                 buddy->data.blockSizeSmallest);
+    }
+
+    return result;
+}
+
 void buddyFree(Buddy *buddy, Memory memory) {
     ASSERT(memory.start ==
            alignUp(memory.start, 1 << buddy->data.blockSizeSmallest));
     ASSERT(aligned(memory.bytes, 1 << buddy->data.blockSizeSmallest));
 
-    Exponent maxOrder = buddyOrderMax(buddy);
-    Exponent bias = maxOrder + ((sizeof(U64) * BITS_PER_BYTE) -
-                                (buddy->data.blockSizeLargest) - 1);
+    buddyTraceRecord(buddy, MEMORY_TRACE_BUDDY_FREE, memory);
 
     U64 memoryAddress = memory.start;
     U64 memoryEnd = memory.start + memory.bytes;
 
     while (memoryAddress < memoryEnd) {
-        // block size given the size of the region to add
-        Exponent orderToAdd = MIN(
-            maxOrder,
-            (Exponent)(bias - (__builtin_clzll(memoryEnd - memoryAddress))));
-
-        // block size given the alignment constraints
-        if (memoryAddress) {
-            orderToAdd =
-                MIN(orderToAdd, (Exponent)__builtin_ctzll(memoryAddress) -
-                                    buddy->data.blockSizeSmallest);
-        }
+        Exponent orderToAdd = buddyChunkOrder(buddy, memoryAddress, memoryEnd);
 
         U64_pow2 blockSize = buddyBlockSize(buddy, orderToAdd);
         U64 buddyAddress = getBuddyAddress(memoryAddress, blockSize);
@@ -143,6 +160,101 @@ void buddyFree(Buddy *buddy, Memory memory) {
     }
 }
 
+// Returns the order of the free block that contains the address, starting the
+// search at the given order. Returns BUDDY_ORDERS_MAX if there is none.
+static Exponent buddyBlockContainingFind(Buddy *buddy, U64 address,
+                                         Exponent orderStart, U32 *index) {
+    Exponent orderMax = buddyOrderMax(buddy);
+    for (Exponent order = orderStart; order <= orderMax; order++) {
+        U64 blockAddress = alignDown(address, buddyBlockSize(buddy, order));
+        U64_a *blocks = &buddy->data.blocks[order];
+        for (typeof(blocks->len) i = 0; i < blocks->len; i++) {
+            if (blocks->buf[i] == blockAddress) {
+                *index = i;
+                return order;
+            }
+        }
+    }
+
+    return BUDDY_ORDERS_MAX;
+}
+
+// Walks the free blocks that contain the range. Each one is taken out and the
+// parts of it outside the range are handed back as the largest aligned blocks
+// that fit. Only the given lens are counted, unless commit is set.
+static bool buddyRangeClaimWalk(Buddy *buddy, Memory memory, U32 *lens,
+                                bool commit) {
+    U64 memoryEnd = memory.start + memory.bytes;
+
+    for (U64 memoryAddress = memory.start; memoryAddress < memoryEnd;) {
+        U32 index;
+        Exponent orderFound = buddyBlockContainingFind(
+            buddy, memoryAddress,
+            buddyChunkOrder(buddy, memoryAddress, memoryEnd), &index);
+        if (orderFound == BUDDY_ORDERS_MAX) {
+            return false;
+        }
+
+        U64 *blockBuf = buddy->data.blocks[orderFound].buf;
+        U64 blockStart = blockBuf[index];
+        U64 blockEnd = blockStart + buddyBlockSize(buddy, orderFound);
+        lens[orderFound]--;
+        if (commit) {
+            blockBuf[index] = blockBuf[lens[orderFound]];
+            buddy->data.blocks[orderFound].len = lens[orderFound];
+        }
+
+        Memory remainders[] = {
+            {.start = blockStart, .bytes = memoryAddress - blockStart},
+            {.start = MIN(blockEnd, memoryEnd),
+             .bytes = blockEnd - MIN(blockEnd, memoryEnd)}};
+        for (U32 i = 0; i < COUNTOF(remainders); i++) {
+            U64 remainderEnd = remainders[i].start + remainders[i].bytes;
+            for (U64 address = remainders[i].start; address < remainderEnd;) {
+                Exponent order = buddyChunkOrder(buddy, address, remainderEnd);
+                if (lens[order] == buddy->data.blocksCapacityPerOrder) {
+                    longjmp(buddy->backingBufferExhausted, 1);
+                }
+                lens[order]++;
+                if (commit) {
+                    buddy->data.blocks[order].buf[lens[order] - 1] = address;
+                    buddy->data.blocks[order].len = lens[order];
+                }
+                address += buddyBlockSize(buddy, order);
+            }
+        }
+
+        memoryAddress = MIN(blockEnd, memoryEnd);
+    }
+
+    return true;
+}
+
+bool buddyRangeClaim(Buddy *buddy, Memory memory) {
+    ASSERT(memory.start ==
+           alignUp(memory.start, 1 << buddy->data.blockSizeSmallest));
+    ASSERT(aligned(memory.bytes, 1 << buddy->data.blockSizeSmallest));
+
+    U32 lens[BUDDY_ORDERS_MAX];
+    for (Exponent order = 0; order < buddyOrderCount(buddy); order++) {
+        lens[order] = buddy->data.blocks[order].len;
+    }
+
+    // NOTE: First walk the range without touching the blocks, so a range that
+    // is not free or a full backing buffer leaves the buddy untouched.
+    if (!buddyRangeClaimWalk(buddy, memory, lens, false)) {
+        return false;
+    }
+
+    for (Exponent order = 0; order < buddyOrderCount(buddy); order++) {
+        lens[order] = buddy->data.blocks[order].len;
+    }
+    (void)buddyRangeClaimWalk(buddy, memory, lens, true);
+
+    buddyTraceRecord(buddy, MEMORY_TRACE_BUDDY_CLAIM, memory);
+    return true;
+}
+
 void buddyInit(Buddy *buddy, U64 *backingBuffer, U32 blocksCapacity,
                Exponent orderCount) {
     ASSERT(orderCount <= BUDDY_ORDERS_MAX);
@@ -157,4 +269,5 @@ void buddyInit(Buddy *buddy, U64 *backingBuffer, U32 blocksCapacity,
     }
 
     buddy->data.blocksCapacityPerOrder = blocksCapacity;
+    buddy->traceEvents = MEMORY_TRACE_NONE;
 }
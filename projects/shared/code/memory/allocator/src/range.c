@@ -0,0 +1,190 @@
+#include "shared/memory/allocator/range.h"
+
+#include "abstraction/memory/manipulation.h"
+#include "abstraction/memory/virtual/map.h"
+#include "shared/assert.h"
+#include "shared/maths.h"
+
+void rangeAllocatorInit(RangeAllocator *rangeAllocator, Buddy *buddy,
+                        Memory_a freeBuffer, Memory_a pendingBuffer,
+                        U64_pow2 chunkBytes) {
+    rangeAllocator->buddy = buddy;
+    rangeAllocator->free =
+        (Memory_max_a){.buf = freeBuffer.buf, .len = 0, .cap = freeBuffer.len};
+    rangeAllocator->pending = (Memory_max_a){
+        .buf = pendingBuffer.buf, .len = 0, .cap = pendingBuffer.len};
+    rangeAllocator->pendingBytes = 0;
+    rangeAllocator->chunkBytes = chunkBytes;
+}
+
+// Returns the index of the first free range that starts after the address.
+static U32 freeRangeIndexAfter(Memory_max_a *free, U64 address) {
+    U32 low = 0;
+    U32 high = free->len;
+    while (low < high) {
+        U32 middle = low + ((high - low) / 2);
+        if (free->buf[middle].start <= address) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static void freeRangeInsert(RangeAllocator *rangeAllocator, Memory memory) {
+    Memory_max_a *free = &rangeAllocator->free;
+    U32 index = freeRangeIndexAfter(free, memory.start);
+
+    bool mergesPrevious =
+        index > 0 && free->buf[index - 1].start + free->buf[index - 1].bytes ==
+                         memory.start;
+    bool mergesNext = index < free->len &&
+                      memory.start + memory.bytes == free->buf[index].start;
+
+    if (mergesPrevious && mergesNext) {
+        free->buf[index - 1].bytes += memory.bytes + free->buf[index].bytes;
+        memmove(&free->buf[index], &free->buf[index + 1],
+                (free->len - index - 1) * sizeof(*free->buf));
+        free->len--;
+    } else if (mergesPrevious) {
+        free->buf[index - 1].bytes += memory.bytes;
+    } else if (mergesNext) {
+        free->buf[index].start = memory.start;
+        free->buf[index].bytes += memory.bytes;
+    } else {
+        if (free->len == free->cap) {
+            longjmp(rangeAllocator->backingBufferExhausted, 1);
+        }
+        memmove(&free->buf[index + 1], &free->buf[index],
+                (free->len - index) * sizeof(*free->buf));
+        free->buf[index] = memory;
+        free->len++;
+    }
+}
+
+void rangePendingFlush(RangeAllocator *rangeAllocator) {
+    if (!rangeAllocator->pending.len) {
+        return;
+    }
+
+    pageCacheShootdown();
+
+    for (typeof(rangeAllocator->pending.len) i = 0;
+         i < rangeAllocator->pending.len; i++) {
+        freeRangeInsert(rangeAllocator, rangeAllocator->pending.buf[i]);
+    }
+    rangeAllocator->pending.len = 0;
+    rangeAllocator->pendingBytes = 0;
+}
+
+// Best fit: the smallest free range that can hold the aligned allocation
+// including its guard.
+static bool freeRangeBestFitTake(RangeAllocator *rangeAllocator, U64 bytes,
+                                 RangeParams params, U64 *result) {
+    Memory_max_a *free = &rangeAllocator->free;
+
+    U32 bestIndex = free->len;
+    U64 bestStart = 0;
+    for (typeof(free->len) i = 0; i < free->len; i++) {
+        U64 start =
+            alignUp(free->buf[i].start + params.guardBytes, params.align);
+        if (start + bytes > free->buf[i].start + free->buf[i].bytes) {
+            continue;
+        }
+
+        if (bestIndex == free->len ||
+            free->buf[i].bytes < free->buf[bestIndex].bytes) {
+            bestIndex = i;
+            bestStart = start;
+            if (free->buf[i].bytes == bytes + params.guardBytes) {
+                break;
+            }
+        }
+    }
+
+    if (bestIndex == free->len) {
+        return false;
+    }
+
+    Memory found = free->buf[bestIndex];
+    Memory before = {.start = found.start,
+                     .bytes = bestStart - params.guardBytes - found.start};
+    Memory after = {.start = bestStart + bytes,
+                    .bytes = found.start + found.bytes - (bestStart + bytes)};
+
+    if (before.bytes && after.bytes) {
+        if (free->len == free->cap) {
+            longjmp(rangeAllocator->backingBufferExhausted, 1);
+        }
+        memmove(&free->buf[bestIndex + 2], &free->buf[bestIndex + 1],
+                (free->len - bestIndex - 1) * sizeof(*free->buf));
+        free->buf[bestIndex] = before;
+        free->buf[bestIndex + 1] = after;
+        free->len++;
+    } else if (before.bytes) {
+        free->buf[bestIndex] = before;
+    } else if (after.bytes) {
+        free->buf[bestIndex] = after;
+    } else {
+        memmove(&free->buf[bestIndex], &free->buf[bestIndex + 1],
+                (free->len - bestIndex - 1) * sizeof(*free->buf));
+        free->len--;
+    }
+
+    *result = bestStart;
+    return true;
+}
+
+void *rangeAllocate_(RangeAllocator *rangeAllocator, U64 bytes,
+                     RangeParams params) {
+    ASSERT(powerOf2(params.align));
+    ASSERT(aligned(bytes, pageSizeSmallest()));
+    ASSERT(aligned(params.guardBytes, pageSizeSmallest()));
+
+    U64 result;
+    if (freeRangeBestFitTake(rangeAllocator, bytes, params, &result)) {
+        return (void *)result;
+    }
+
+    if (rangeAllocator->pending.len) {
+        rangePendingFlush(rangeAllocator);
+        if (freeRangeBestFitTake(rangeAllocator, bytes, params, &result)) {
+            return (void *)result;
+        }
+    }
+
+    // NOTE: Worst case the guard and alignment padding come on top of the
+    // requested bytes. The buddy will longjmp if it cannot provide this.
+    U64_pow2 chunkBytes = MAX(
+        rangeAllocator->chunkBytes,
+        ceilingPowerOf2(bytes + params.guardBytes + params.align - 1));
+    void *chunk = buddyAllocate(rangeAllocator->buddy, chunkBytes);
+    freeRangeInsert(rangeAllocator,
+                    (Memory){.start = (U64)chunk, .bytes = chunkBytes});
+
+    if (!freeRangeBestFitTake(rangeAllocator, bytes, params, &result)) {
+        __builtin_unreachable();
+    }
+    return (void *)result;
+}
+
+void rangeFree_(RangeAllocator *rangeAllocator, Memory memory,
+                RangeParams params) {
+    ASSERT(aligned(memory.start, pageSizeSmallest()));
+    ASSERT(aligned(memory.bytes, pageSizeSmallest()));
+
+    if (rangeAllocator->pending.len == rangeAllocator->pending.cap) {
+        rangePendingFlush(rangeAllocator);
+    }
+
+    Memory reserved = {.start = memory.start - params.guardBytes,
+                       .bytes = memory.bytes + params.guardBytes};
+    rangeAllocator->pending.buf[rangeAllocator->pending.len] = reserved;
+    rangeAllocator->pending.len++;
+    rangeAllocator->pendingBytes += reserved.bytes;
+
+    if (rangeAllocator->pendingBytes >= RANGE_PENDING_FLUSH_BYTES_THRESHOLD) {
+        rangePendingFlush(rangeAllocator);
+    }
+}
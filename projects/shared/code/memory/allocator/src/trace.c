@@ -0,0 +1,36 @@
+#include "shared/memory/allocator/trace.h"
+
+#include "abstraction/memory/virtual/converter.h"
+#include "shared/assert.h"
+#include "shared/maths.h"
+
+MemoryTrace memoryTrace;
+
+void memoryTraceInit(MemoryTraceRecord *records, U64_pow2 capacity) {
+    ASSERT(powerOf2(capacity));
+
+    memoryTrace = (MemoryTrace){.records = records, .capacity = capacity};
+}
+
+void memoryTraceRecord(MemoryTraceEvent event, Memory memory,
+                       U64_pow2 pageSize) {
+    if (!memoryTrace.records) {
+        return;
+    }
+
+    if (memoryTrace.dropped ||
+        memoryTrace.recorded - memoryTrace.exported == memoryTrace.capacity) {
+        memoryTrace.dropped++;
+        return;
+    }
+
+    memoryTrace.records[ringBufferIndex(memoryTrace.recorded,
+                                        memoryTrace.capacity)] =
+        (MemoryTraceRecord){
+            .address = memory.start,
+            .pages = dividePowerOf2(memory.bytes, pageSizeSmallest()),
+            .pageSizeExponent =
+                pageSize ? (U64)__builtin_ctzll(pageSize) : 0,
+            .event = event};
+    memoryTrace.recorded++;
+}
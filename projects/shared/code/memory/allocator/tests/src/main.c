@@ -5,6 +5,7 @@
 #include "shared/memory/allocator/arena.h"
 #include "shared/memory/allocator/buddy.h"
 #include "shared/memory/allocator/node.h"
+#include "shared/memory/allocator/range.h"
 #include "shared/memory/allocator/status/buddy.h"
 #include "shared/memory/allocator/status/node.h"
 #include "shared/memory/management/management.h"
@@ -84,4 +85,63 @@ int main() {
         buddyStatusAppend(&myBuddy);
         INFO(STRING("--------------\n"));
     }
+
+    if (!buddyRangeClaim(&myBuddy,
+                         (Memory){.start = 3 * 4096, .bytes = 5 * 4096})) {
+        PFLUSH_AFTER(STDOUT) { ERROR(STRING("Could not claim free range!\n")); }
+        return 1;
+    }
+
+    PFLUSH_AFTER(STDOUT) {
+        buddyStatusAppend(&myBuddy);
+        INFO(STRING("--------------\n"));
+    }
+
+    if (buddyRangeClaim(&myBuddy,
+                        (Memory){.start = 4 * 4096, .bytes = 4096})) {
+        PFLUSH_AFTER(STDOUT) {
+            ERROR(STRING("Claimed a range that was already taken!\n"));
+        }
+        return 1;
+    }
+
+    buddyFree(&myBuddy, (Memory){.start = 3 * 4096, .bytes = 5 * 4096});
+
+    PFLUSH_AFTER(STDOUT) {
+        buddyStatusAppend(&myBuddy);
+        INFO(STRING("--------------\n"));
+    }
+
+    U32 rangesCapacity = 64;
+    RangeAllocator ranges;
+    rangeAllocatorInit(
+        &ranges, &myBuddy,
+        (Memory_a){.buf = NEW(&arena, Memory, .count = rangesCapacity),
+                   .len = rangesCapacity},
+        (Memory_a){.buf = NEW(&arena, Memory, .count = rangesCapacity),
+                   .len = rangesCapacity},
+        2 * MiB);
+    if (setjmp(ranges.backingBufferExhausted)) {
+        PFLUSH_AFTER(STDOUT) {
+            ERROR(STRING("Range backing buffer is exhausted!\n"));
+        }
+        return 1;
+    }
+
+    U64 first = (U64)rangeAllocate(&ranges, 3 * 4096);
+    U64 second = (U64)rangeAllocate(&ranges, 5 * 4096, .guardBytes = 4096);
+    U64 third = (U64)rangeAllocate(&ranges, 4096, .align = 64 * KiB);
+    if (second != first + 4 * 4096 || third != first + 16 * 4096) {
+        PFLUSH_AFTER(STDOUT) {
+            ERROR(STRING("Ranges are not packed tightly!\n"));
+        }
+        return 1;
+    }
+
+    PFLUSH_AFTER(STDOUT) {
+        INFO(STRING("Ranges left: "));
+        INFO(ranges.free.len, .flags = NEWLINE);
+        buddyStatusAppend(&myBuddy);
+        INFO(STRING("--------------\n"));
+    }
 }
@@ -0,0 +1,456 @@
+#include "abstraction/jmp.h"
+#include "abstraction/log.h"
+#include "abstraction/memory/virtual/converter.h"
+#include "abstraction/text/converter/converter.h"
+#include "abstraction/time.h"
+#include "posix/log.h"
+#include "shared/log.h"
+#include "shared/maths.h"
+#include "shared/memory/allocator/buddy.h"
+#include "shared/memory/allocator/node.h"
+#include "shared/memory/allocator/trace.h"
+#include "shared/memory/management/management.h"
+#include "shared/text/string.h"
+#include "shared/trees/red-black/virtual-mapping-manager.h"
+#include "shared/types/array.h"
+#include "shared/types/numeric.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Replays a memory trace that the kernel wrote to serial, see
+// kernel/memory-trace.h, into fresh buddies and a fresh mapping sizes tree.
+// Every allocation has to end up at the same address as in the kernel, so a
+// change to the allocators that changes their decisions shows up here as a
+// divergence. The time spent per event is printed, so the same trace can be
+// used to compare allocator changes.
+
+// NOTE: Larger than the kernel's, a replay should not fail on a full order.
+static constexpr auto REPLAY_BLOCKS_CAPACITY_PER_ORDER = 4096;
+
+static constexpr auto HEX_RECORD_LEN = 2 * sizeof(MemoryTraceRecord);
+
+static String TRACE_BEGIN = STRING("MEMORY TRACE BEGIN ");
+static String TRACE_END = STRING("MEMORY TRACE END");
+
+static String eventToString[MEMORY_TRACE_PAGE_FAULT + 1] = {
+    [MEMORY_TRACE_NONE] = STRING("none"),
+    [MEMORY_TRACE_PHYSICAL + MEMORY_TRACE_BUDDY_ALLOCATE] =
+        STRING("physical allocate"),
+    [MEMORY_TRACE_PHYSICAL + MEMORY_TRACE_BUDDY_FREE] = STRING("physical free"),
+    [MEMORY_TRACE_PHYSICAL + MEMORY_TRACE_BUDDY_CLAIM] =
+        STRING("physical claim"),
+    [MEMORY_TRACE_VIRTUAL + MEMORY_TRACE_BUDDY_ALLOCATE] =
+        STRING("virtual allocate"),
+    [MEMORY_TRACE_VIRTUAL + MEMORY_TRACE_BUDDY_FREE] = STRING("virtual free"),
+    [MEMORY_TRACE_VIRTUAL + MEMORY_TRACE_BUDDY_CLAIM] = STRING("virtual claim"),
+    [MEMORY_TRACE_MAPPING_ADD] = STRING("mapping add"),
+    [MEMORY_TRACE_MAPPING_RESIZE] = STRING("mapping resize"),
+    [MEMORY_TRACE_MAPPING_REMOVE] = STRING("mapping remove"),
+    [MEMORY_TRACE_PAGE_FAULT] = STRING("page fault"),
+};
+
+typedef ARRAY_MAX_LENGTH(MemoryTraceRecord) MemoryTraceRecord_max_a;
+
+typedef struct {
+    U64 count;
+    U64 cycles;
+} EventStatistics;
+
+typedef struct {
+    Buddy buddyPhysical;
+    Buddy buddyVirtual;
+    VMMNode *tree;
+    NodeAllocator nodeAllocator;
+    EventStatistics statistics[MEMORY_TRACE_PAGE_FAULT + 1];
+} Replay;
+
+static U8 hexValue(U8 ch) {
+    if (ch >= '0' && ch <= '9') {
+        return (U8)(ch - '0');
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return (U8)(ch - 'a' + 10);
+    }
+    return U8_MAX;
+}
+
+static bool recordFromHex(String line, MemoryTraceRecord *record) {
+    if (line.len != HEX_RECORD_LEN) {
+        return false;
+    }
+
+    U8 *bytes = (U8 *)record;
+    for (U64 i = 0; i < sizeof(MemoryTraceRecord); i++) {
+        U8 high = hexValue(line.buf[2 * i]);
+        U8 low = hexValue(line.buf[(2 * i) + 1]);
+        if (high == U8_MAX || low == U8_MAX) {
+            return false;
+        }
+        bytes[i] = (U8)(high << 4) | low;
+    }
+    return true;
+}
+
+// Returns the number at the start of the string and moves past it and the
+// space that follows.
+static U64 numberTake(String *string) {
+    U64 result = 0;
+    while (string->len && string->buf[0] >= '0' && string->buf[0] <= '9') {
+        result = (result * 10) + (U64)(string->buf[0] - '0');
+        string->buf++;
+        string->len--;
+    }
+    if (string->len && string->buf[0] == ' ') {
+        string->buf++;
+        string->len--;
+    }
+    return result;
+}
+
+static bool stringStartsWith(String string, String prefix) {
+    return string.len >= prefix.len &&
+           !memcmp(string.buf, prefix.buf, prefix.len);
+}
+
+static String lineTake(String *data) {
+    String result = {.buf = data->buf, .len = 0};
+    while (result.len < data->len && data->buf[result.len] != '\n') {
+        result.len++;
+    }
+
+    U32 consumed = result.len < data->len ? result.len + 1 : result.len;
+    data->buf += consumed;
+    data->len -= consumed;
+    return result;
+}
+
+static void parseError(String message, U64 lineNumber) {
+    PFLUSH_AFTER(STDERR) {
+        ERROR(message);
+        ERROR(STRING(" on line "));
+        ERROR(lineNumber, .flags = NEWLINE);
+    }
+}
+
+// Collects the records of all exports in the serial output, other lines are
+// skipped. Every export has to continue where the previous one stopped.
+static bool recordsParse(String data, MemoryTraceRecord_max_a *records) {
+    bool inTrace = false;
+    U64 expected = 0;
+    U64 dropped = 0;
+    for (U64 lineNumber = 1; data.len; lineNumber++) {
+        String line = lineTake(&data);
+
+        if (!inTrace) {
+            if (stringStartsWith(line, TRACE_BEGIN)) {
+                String numbers = {.buf = line.buf + TRACE_BEGIN.len,
+                                  .len = line.len - TRACE_BEGIN.len};
+                if (numberTake(&numbers) != records->len) {
+                    parseError(STRING("Export does not continue the trace"),
+                               lineNumber);
+                    return false;
+                }
+                expected = records->len + numberTake(&numbers);
+                dropped = numberTake(&numbers);
+                inTrace = true;
+            }
+            continue;
+        }
+
+        if (stringStartsWith(line, TRACE_END)) {
+            if (records->len != expected) {
+                parseError(STRING("Export is missing records"), lineNumber);
+                return false;
+            }
+            inTrace = false;
+            continue;
+        }
+
+        if (records->len == records->cap ||
+            !recordFromHex(line, &records->buf[records->len])) {
+            parseError(STRING("Malformed record"), lineNumber);
+            return false;
+        }
+        records->len++;
+    }
+
+    if (dropped) {
+        PFLUSH_AFTER(STDOUT) {
+            INFO(STRING("NOTE: The kernel dropped "));
+            INFO(dropped);
+            INFO(STRING(" records at the end of the trace\n"));
+        }
+    }
+
+    return true;
+}
+
+static bool buddyCreate(Buddy *buddy, Exponent blockSizeLargest) {
+    Exponent orderCount = buddyOrderCountOnLargestPageSize(blockSizeLargest);
+    U64 *backingBuffer =
+        calloc(orderCount * REPLAY_BLOCKS_CAPACITY_PER_ORDER, sizeof(U64));
+    if (!backingBuffer) {
+        return false;
+    }
+
+    buddyInit(buddy, backingBuffer, REPLAY_BLOCKS_CAPACITY_PER_ORDER,
+              orderCount);
+    return true;
+}
+
+static bool replayCreate(Replay *replay, MemoryTraceRecord_max_a records) {
+    if (!buddyCreate(&replay->buddyPhysical, BUDDY_PHYSICAL_PAGE_SIZE_MAX) ||
+        !buddyCreate(&replay->buddyVirtual, BUDDY_VIRTUAL_PAGE_SIZE_MAX)) {
+        return false;
+    }
+
+    U64 mappings = 0;
+    for (U64 i = 0; i < records.len; i++) {
+        if (records.buf[i].event == MEMORY_TRACE_MAPPING_ADD) {
+            mappings++;
+        }
+    }
+    mappings = MAX(mappings, 1);
+
+    void *nodes = calloc(mappings, sizeof(VMMNode));
+    void *nodesFreeList = calloc(mappings, sizeof(void *));
+    if (!nodes || !nodesFreeList) {
+        return false;
+    }
+
+    replay->tree = nullptr;
+    nodeAllocatorInit(
+        &replay->nodeAllocator,
+        (void_a){.buf = nodes, .len = (U32)(mappings * sizeof(VMMNode))},
+        (void_a){.buf = nodesFreeList,
+                 .len = (U32)(mappings * sizeof(void *))},
+        sizeof(VMMNode), alignof(VMMNode));
+
+    return true;
+}
+
+static U64_pow2 pageSizeFromTree(Replay *replay, U64 address) {
+    VMMNode *result =
+        VMMNodeFindGreatestBelowOrEqual(&replay->tree, address);
+    if (result && result->basic.value + result->bytes > address) {
+        return result->mappingSize;
+    }
+
+    return pageSizeSmallest();
+}
+
+static U64_pow2 pageSizeFromRecord(MemoryTraceRecord *record) {
+    return record->pageSizeExponent ? 1ULL << record->pageSizeExponent : 0;
+}
+
+// Returns false if the replay made a different decision than the kernel.
+static bool recordReplay(Replay *replay, MemoryTraceRecord *record) {
+    Memory memory = {.start = record->address,
+                     .bytes = record->pages * pageSizeSmallest()};
+
+    if (record->event < MEMORY_TRACE_MAPPING_ADD) {
+        Buddy *buddy = record->event < MEMORY_TRACE_VIRTUAL
+                           ? &replay->buddyPhysical
+                           : &replay->buddyVirtual;
+        switch ((record->event - MEMORY_TRACE_PHYSICAL) %
+                MEMORY_TRACE_BUDDY_EVENTS) {
+        case MEMORY_TRACE_BUDDY_ALLOCATE: {
+            return (U64)buddyAllocate(buddy, memory.bytes) == memory.start;
+        }
+        case MEMORY_TRACE_BUDDY_FREE: {
+            buddyFree(buddy, memory);
+            return true;
+        }
+        default: {
+            return buddyRangeClaim(buddy, memory);
+        }
+        }
+    }
+
+    switch (record->event) {
+    case MEMORY_TRACE_MAPPING_ADD: {
+        VMMNode *node = nodeAllocatorGet(&replay->nodeAllocator);
+        node->basic.value = memory.start;
+        node->bytes = memory.bytes;
+        node->mappingSize = pageSizeFromRecord(record);
+        VMMNodeInsert(&replay->tree, node);
+        return true;
+    }
+    case MEMORY_TRACE_MAPPING_RESIZE: {
+        VMMNode *node =
+            VMMNodeFindGreatestBelowOrEqual(&replay->tree, memory.start);
+        if (!node || node->basic.value != memory.start) {
+            return false;
+        }
+        node->bytes = memory.bytes;
+        return true;
+    }
+    case MEMORY_TRACE_MAPPING_REMOVE: {
+        VMMNode *deleted = VMMNodeDelete(&replay->tree, memory.start);
+        if (!deleted) {
+            return false;
+        }
+        nodeAllocatorFree(&replay->nodeAllocator, deleted);
+        return true;
+    }
+    default: {
+        return pageSizeFromTree(replay, memory.start) ==
+               pageSizeFromRecord(record);
+    }
+    }
+}
+
+static void divergenceAppend(U64 index, MemoryTraceRecord *record) {
+    ERROR(STRING("Replay diverged at record "));
+    ERROR(index);
+    ERROR(STRING(": "));
+    ERROR(record->event <= MEMORY_TRACE_PAGE_FAULT
+              ? eventToString[record->event]
+              : STRING("unknown event"));
+    ERROR(STRING(" of "));
+    ERROR((void *)record->address);
+    ERROR(STRING(" with "));
+    ERROR((U64)record->pages);
+    ERROR(STRING(" pages\n"));
+}
+
+static bool replayRun(Replay *replay, MemoryTraceRecord_max_a records) {
+    for (U64 i = 0; i < records.len; i++) {
+        MemoryTraceRecord *record = &records.buf[i];
+        if (!record->event || record->event > MEMORY_TRACE_PAGE_FAULT) {
+            PFLUSH_AFTER(STDERR) { divergenceAppend(i, record); }
+            return false;
+        }
+
+        bool replayed = false;
+        U64 cycles = 0;
+        BENCHMARK(cycles) { replayed = recordReplay(replay, record); }
+        if (!replayed) {
+            PFLUSH_AFTER(STDERR) { divergenceAppend(i, record); }
+            return false;
+        }
+
+        replay->statistics[record->event].count++;
+        replay->statistics[record->event].cycles += cycles;
+    }
+
+    return true;
+}
+
+static void statisticsAppend(Replay *replay) {
+    for (U64 event = MEMORY_TRACE_PHYSICAL; event <= MEMORY_TRACE_PAGE_FAULT;
+         event++) {
+        EventStatistics *statistics = &replay->statistics[event];
+        if (!statistics->count) {
+            continue;
+        }
+
+        INFO(stringWithMinSizeDefault(eventToString[event], 20));
+        INFO(STRING("count: "));
+        INFO(stringWithMinSizeDefault(STRING_CONVERT(statistics->count), 12));
+        INFO(STRING("cycles: "));
+        INFO(stringWithMinSizeDefault(STRING_CONVERT(statistics->cycles), 16));
+        INFO(STRING("per event: "));
+        INFO(statistics->cycles / statistics->count, .flags = NEWLINE);
+    }
+}
+
+static int buddyFailure(String message) {
+    PFLUSH_AFTER(STDERR) { ERROR(message); }
+    return 1;
+}
+
+static String fileMap(char *name) {
+    int file = open(name, O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return EMPTY_STRING;
+    }
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) || !fileStat.st_size) {
+        close(file);
+        return EMPTY_STRING;
+    }
+
+    void *data =
+        mmap(nullptr, (U64)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return EMPTY_STRING;
+    }
+
+    return (String){.buf = data, .len = (U32)fileStat.st_size};
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        PFLUSH_AFTER(STDERR) {
+            ERROR(STRING("Usage: shared-memory-allocator-replay "
+                         "<serial output with a memory trace>\n"));
+        }
+        return 1;
+    }
+
+    String data = fileMap(argv[1]);
+    if (!data.len) {
+        PFLUSH_AFTER(STDERR) {
+            ERROR(STRING("Could not read "));
+            ERROR(STRING_LEN(argv[1], (U32)strlen(argv[1])));
+            ERROR(STRING(", error message: "));
+            ERROR(STRING_LEN(strerror(errno), (U32)strlen(strerror(errno))),
+                  .flags = NEWLINE);
+        }
+        return 1;
+    }
+
+    // NOTE: Every record takes at least HEX_RECORD_LEN bytes of the output.
+    U32 recordsCapacity = (U32)(data.len / HEX_RECORD_LEN);
+    MemoryTraceRecord_max_a records = {
+        .buf = calloc(recordsCapacity + 1, sizeof(MemoryTraceRecord)),
+        .len = 0,
+        .cap = recordsCapacity};
+    if (!records.buf || !recordsParse(data, &records)) {
+        return 1;
+    }
+
+    Replay replay = {0};
+    if (!replayCreate(&replay, records)) {
+        PFLUSH_AFTER(STDERR) {
+            ERROR(STRING("Failed to allocate the replay!\n"));
+        }
+        return 1;
+    }
+
+    if (setjmp(replay.buddyPhysical.memoryExhausted)) {
+        return buddyFailure(STRING("Physical buddy is empty!\n"));
+    }
+    if (setjmp(replay.buddyPhysical.backingBufferExhausted)) {
+        return buddyFailure(
+            STRING("Physical buddy's backing buffer is exhausted!\n"));
+    }
+    if (setjmp(replay.buddyVirtual.memoryExhausted)) {
+        return buddyFailure(STRING("Virtual buddy is empty!\n"));
+    }
+    if (setjmp(replay.buddyVirtual.backingBufferExhausted)) {
+        return buddyFailure(
+            STRING("Virtual buddy's backing buffer is exhausted!\n"));
+    }
+
+    PFLUSH_AFTER(STDOUT) {
+        INFO(STRING("Replaying "));
+        INFO(records.len);
+        INFO(STRING(" records, all in clockcycles\n"));
+    }
+
+    bool completed = replayRun(&replay, records);
+
+    PFLUSH_AFTER(STDOUT) { statisticsAppend(&replay); }
+
+    return completed ? 0 : 1;
+}
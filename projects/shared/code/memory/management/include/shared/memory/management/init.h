@@ -3,5 +3,7 @@
 
 #include "efi-to-kernel/kernel-parameters.h"
 void memoryManagersInit(KernelMemory *kernelMemory);
+// NOTE: Already done by memoryManagersInit.
+void memoryLocksInit();
 
 #endif
@@ -3,6 +3,8 @@
 
 #include "shared/memory/allocator/buddy.h"
 #include "shared/memory/allocator/node.h"
+#include "shared/memory/allocator/range.h"
+#include "shared/memory/sizes.h"
 
 static constexpr auto BUDDY_BLOCKS_CAPACITY_PER_ORDER_DEFAULT = 512;
 
@@ -12,8 +14,20 @@ static constexpr auto BUDDY_PHYSICAL_PAGE_SIZE_MAX = 30;
 extern Buddy buddyVirtual;
 static constexpr auto BUDDY_VIRTUAL_PAGE_SIZE_MAX = 57;
 
+// NOTE: Takes its chunks from buddyVirtual.
+extern RangeAllocator virtualRanges;
+static constexpr auto VIRTUAL_RANGES_CAPACITY = 512;
+static constexpr auto VIRTUAL_RANGES_CHUNK_SIZE = 1 * GiB;
+
+// NOTE: These take the lock of their allocator.
 [[nodiscard]] void *virtualMemoryAlloc(U64_pow2 blockSize);
 void virtualMemoryFree(Memory memory);
+// Claims the given range of buddyVirtual, see buddyRangeClaim.
+[[nodiscard]] bool virtualMemoryClaim(Memory memory);
+
+[[nodiscard]] void *virtualRangeAlloc(U64 bytes, U64_pow2 align,
+                                      U64 guardBytes);
+void virtualRangeFree(Memory memory, U64 guardBytes);
 
 [[nodiscard]] void *physicalMemoryAlloc(U64_pow2 blockSize);
 void physicalMemoryFree(Memory memory);
@@ -1,6 +1,7 @@
 #ifndef SHARED_MEMORY_MANAGEMENT_PAGE_H
 #define SHARED_MEMORY_MANAGEMENT_PAGE_H
 
+#include "shared/lock/spin.h"
 #include "shared/memory/allocator/node.h"
 #include "shared/trees/red-black/virtual-mapping-manager.h"
 #include "shared/types/numeric.h"
@@ -12,16 +13,26 @@ typedef struct {
 
 extern VMMTreeWithFreeList memoryMapperSizes;
 
-typedef enum {
-    PAGE_FAULT_RESULT_MAPPED,
-    PAGE_FAULT_RESULT_STACK_OVERFLOW
-} PageFaultResult;
-
-[[nodiscard]] PageFaultResult pageFaultHandle(U64 faultingAddress);
+// NOTE: Taken with interrupts disabled, like all the memory locks. Held across
+// pageMap and pageUnmap. Lock order: memory mappings, page tables, physical
+// memory.
+extern SpinLock pageTablesLock;
+void pageLocksInit();
 
 static constexpr U64_pow2 GUARD_PAGE_SIZE = 0;
 
+// Returns the page size the faulting address is now mapped with, or
+// GUARD_PAGE_SIZE if it lies in a guard page, i.e., a stack overflow.
+[[nodiscard]] U64_pow2 pageFaultHandle(U64 faultingAddress);
+
 void pageMappingAdd(Memory memory, U64_pow2 pageSize);
 void pageMappingRemove(U64 address);
+// NOTE: For the mapping that starts at address.
+[[nodiscard]] U64_pow2 pageMappingSize(U64 address);
+void pageMappingResize(U64 address, U64 bytes);
+
+// To be called once the node arrays of memoryMapperSizes are moved to mappable
+// memory.
+void pageMappingNodesMappable();
 
 #endif
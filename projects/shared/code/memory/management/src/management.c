@@ -5,26 +5,88 @@
 #include "abstraction/memory/manipulation.h"
 #include "abstraction/memory/virtual/converter.h"
 #include "efi-to-kernel/kernel-parameters.h"
+#include "shared/lock/spin.h"
 #include "shared/log.h"
 #include "shared/maths.h"
 #include "shared/memory/allocator/arena.h"
+#include "shared/memory/allocator/trace.h"
 #include "shared/memory/management/init.h"
 #include "shared/memory/management/page.h"
 #include "shared/memory/sizes.h"
 
 Buddy buddyPhysical;
 Buddy buddyVirtual;
+RangeAllocator virtualRanges;
 
-void virtualMemoryFree(Memory memory) { buddyFree(&buddyVirtual, memory); }
+static SpinLock physicalMemoryLock;
+static LockClass physicalMemoryLockClass = LOCK_CLASS("physical memory");
 
-void physicalMemoryFree(Memory memory) { buddyFree(&buddyPhysical, memory); }
+static SpinLock virtualMemoryLock; // Also for virtualRanges
+static LockClass virtualMemoryLockClass = LOCK_CLASS("virtual memory");
+
+void memoryLocksInit() {
+    spinLockInit(&physicalMemoryLock, &physicalMemoryLockClass);
+    spinLockInit(&virtualMemoryLock, &virtualMemoryLockClass);
+    pageLocksInit();
+}
+
+void virtualMemoryFree(Memory memory) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&virtualMemoryLock);
+    buddyFree(&buddyVirtual, memory);
+    spinLockReleaseInterruptsRestore(&virtualMemoryLock, interruptsWereEnabled);
+}
+
+void physicalMemoryFree(Memory memory) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&physicalMemoryLock);
+    buddyFree(&buddyPhysical, memory);
+    spinLockReleaseInterruptsRestore(&physicalMemoryLock,
+                                     interruptsWereEnabled);
+}
 
 void *virtualMemoryAlloc(U64_pow2 blockSize) {
-    return buddyAllocate(&buddyVirtual, blockSize);
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&virtualMemoryLock);
+    void *result = buddyAllocate(&buddyVirtual, blockSize);
+    spinLockReleaseInterruptsRestore(&virtualMemoryLock, interruptsWereEnabled);
+    return result;
 }
 
 void *physicalMemoryAlloc(U64_pow2 blockSize) {
-    return buddyAllocate(&buddyPhysical, blockSize);
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&physicalMemoryLock);
+    void *result = buddyAllocate(&buddyPhysical, blockSize);
+    spinLockReleaseInterruptsRestore(&physicalMemoryLock,
+                                     interruptsWereEnabled);
+    return result;
+}
+
+bool virtualMemoryClaim(Memory memory) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&virtualMemoryLock);
+    bool result = buddyRangeClaim(&buddyVirtual, memory);
+    spinLockReleaseInterruptsRestore(&virtualMemoryLock, interruptsWereEnabled);
+    return result;
+}
+
+// NOTE: The range allocator can shoot down the page cache while the lock is
+// held, so it must only be taken with interrupts enabled. See
+// spinLockAcquireInterruptsDisable.
+void *virtualRangeAlloc(U64 bytes, U64_pow2 align, U64 guardBytes) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&virtualMemoryLock);
+    void *result = rangeAllocate(&virtualRanges, bytes, .align = align,
+                                 .guardBytes = guardBytes);
+    spinLockReleaseInterruptsRestore(&virtualMemoryLock, interruptsWereEnabled);
+    return result;
+}
+
+void virtualRangeFree(Memory memory, U64 guardBytes) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&virtualMemoryLock);
+    rangeFree(&virtualRanges, memory, .guardBytes = guardBytes);
+    spinLockReleaseInterruptsRestore(&virtualMemoryLock, interruptsWereEnabled);
 }
 
 static void identityArrayToMappable(void_max_a *array, U32 elementSizeBytes,
@@ -97,7 +159,10 @@ static void treeWithFreeListToMappable(NodeAllocator *nodeAllocator,
 }
 
 void memoryManagersInit(KernelMemory *kernelMemory) {
+    memoryLocksInit();
+
     buddyPhysical.data = kernelMemory->buddyPhysical;
+    buddyPhysical.traceEvents = MEMORY_TRACE_PHYSICAL;
     if (setjmp(buddyPhysical.memoryExhausted)) {
         interruptPhysicalMemory();
     }
@@ -106,6 +171,7 @@ void memoryManagersInit(KernelMemory *kernelMemory) {
     }
 
     buddyVirtual.data = kernelMemory->buddyVirtual;
+    buddyVirtual.traceEvents = MEMORY_TRACE_VIRTUAL;
     if (setjmp(buddyVirtual.memoryExhausted)) {
         interruptVirtualMemory();
     }
@@ -113,7 +179,20 @@ void memoryManagersInit(KernelMemory *kernelMemory) {
         interruptBuffer();
     }
 
+    U64 rangesBytes = ceilingPowerOf2(VIRTUAL_RANGES_CAPACITY * sizeof(Memory));
+    rangeAllocatorInit(
+        &virtualRanges, &buddyVirtual,
+        (Memory_a){.buf = physicalMemoryAlloc(rangesBytes),
+                   .len = VIRTUAL_RANGES_CAPACITY},
+        (Memory_a){.buf = physicalMemoryAlloc(rangesBytes),
+                   .len = VIRTUAL_RANGES_CAPACITY},
+        VIRTUAL_RANGES_CHUNK_SIZE);
+    if (setjmp(virtualRanges.backingBufferExhausted)) {
+        interruptBuffer();
+    }
+
     memoryMapperSizes = kernelMemory->memoryMapperSizes;
     treeWithFreeListToMappable(&memoryMapperSizes.nodeAllocator,
                                (void **)&memoryMapperSizes.tree);
+    pageMappingNodesMappable();
 }
@@ -4,14 +4,77 @@
 #include "abstraction/memory/virtual/converter.h"
 #include "abstraction/memory/virtual/map.h"
 #include "abstraction/thread.h"
+#include "shared/assert.h"
+#include "shared/lock/spin.h"
 #include "shared/log.h"
 #include "shared/maths.h"
+#include "shared/memory/allocator/trace.h"
 #include "shared/memory/converter.h"
 #include "shared/memory/management/management.h"
 #include "shared/memory/sizes.h"
 
 VMMTreeWithFreeList memoryMapperSizes = {0};
 
+static SpinLock memoryMappingsLock;
+static LockClass memoryMappingsLockClass = LOCK_CLASS("memory mappings");
+
+SpinLock pageTablesLock;
+static LockClass pageTablesLockClass = LOCK_CLASS("page tables");
+
+// NOTE: Once the node arrays are mappable, they are only backed up to here. A
+// fault on them while the mappings lock is held cannot be handled, so the
+// pages of the next slot are backed before it is touched. 0 while the arrays
+// are still identity memory.
+static U64 nodesBackedEnd;
+static U64 nodesFreeListBackedEnd;
+
+void pageLocksInit() {
+    spinLockInit(&memoryMappingsLock, &memoryMappingsLockClass);
+    spinLockInit(&pageTablesLock, &pageTablesLockClass);
+}
+
+// NOTE: Another processor can have mapped the page while this one waited for
+// the lock.
+static void pageBack(U64 address, U64_pow2 pageSize) {
+    U64 startingMap = alignDown(address, pageSize);
+    U64_pow2 pageSizeToUse = pageSizeFitting(pageSize);
+
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&pageTablesLock);
+    if (!pageMapped(startingMap)) {
+        U32_pow2 mapsToDo = (U32)dividePowerOf2(pageSize, pageSizeToUse);
+        for (U32 i = 0; i < mapsToDo; i++) {
+            U8 *physical = physicalMemoryAlloc(pageSizeToUse);
+            pageMap(startingMap + (i * pageSizeToUse), (U64)physical,
+                    pageSizeToUse);
+        }
+    }
+    spinLockReleaseInterruptsRestore(&pageTablesLock, interruptsWereEnabled);
+}
+
+static void nodesBack(U64 *backedEnd, U64 slotEnd) {
+    if (!*backedEnd) {
+        return;
+    }
+
+    while (*backedEnd < slotEnd) {
+        pageBack(*backedEnd, pageSizeSmallest());
+        *backedEnd += pageSizeSmallest();
+    }
+}
+
+void pageMappingNodesMappable() {
+    NodeAllocator *nodeAllocator = &memoryMapperSizes.nodeAllocator;
+    nodesBackedEnd = alignUp((U64)nodeAllocator->nodes.buf +
+                                 (nodeAllocator->nodes.len *
+                                  nodeAllocator->elementSizeBytes),
+                             pageSizeSmallest());
+    nodesFreeListBackedEnd =
+        alignUp((U64)(nodeAllocator->nodesFreeList.buf +
+                      nodeAllocator->nodesFreeList.len),
+                pageSizeSmallest());
+}
+
 static U64_pow2 pageSizeFromVMM(U64 faultingAddress) {
     VMMNode *result = VMMNodeFindGreatestBelowOrEqual(&memoryMapperSizes.tree,
                                                       faultingAddress);
@@ -22,13 +85,43 @@ static U64_pow2 pageSizeFromVMM(U64 faultingAddress) {
     return pageSizeSmallest();
 }
 
+static VMMNode *mappingGet(U64 address) {
+    VMMNode *node =
+        VMMNodeFindGreatestBelowOrEqual(&memoryMapperSizes.tree, address);
+    ASSERT(node && node->basic.value == address);
+    return node;
+}
+
 void pageMappingRemove(U64 address) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&memoryMappingsLock);
+    NodeAllocator *nodeAllocator = &memoryMapperSizes.nodeAllocator;
+    nodesBack(&nodesFreeListBackedEnd,
+              (U64)&nodeAllocator->nodesFreeList
+                  .buf[nodeAllocator->nodesFreeList.len + 1]);
+
     VMMNode *deleted = VMMNodeDelete(&memoryMapperSizes.tree, address);
-    nodeAllocatorFree(&memoryMapperSizes.nodeAllocator, deleted);
+    MEMORY_TRACE_RECORD(MEMORY_TRACE_MAPPING_REMOVE,
+                        ((Memory){.start = address, .bytes = deleted->bytes}),
+                        deleted->mappingSize);
+    nodeAllocatorFree(nodeAllocator, deleted);
+    spinLockReleaseInterruptsRestore(&memoryMappingsLock,
+                                     interruptsWereEnabled);
 }
 
 void pageMappingAdd(Memory memory, U64_pow2 pageSize) {
-    VMMNode *newNode = nodeAllocatorGet(&memoryMapperSizes.nodeAllocator);
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&memoryMappingsLock);
+    NodeAllocator *nodeAllocator = &memoryMapperSizes.nodeAllocator;
+    if (!nodeAllocator->nodesFreeList.len &&
+        nodeAllocator->nodes.len < nodeAllocator->nodes.cap) {
+        nodesBack(&nodesBackedEnd,
+                  (U64)nodeAllocator->nodes.buf +
+                      ((nodeAllocator->nodes.len + 1) *
+                       nodeAllocator->elementSizeBytes));
+    }
+
+    VMMNode *newNode = nodeAllocatorGet(nodeAllocator);
     if (!newNode) {
         interruptVirtualMemoryMapper();
     }
@@ -37,28 +130,47 @@ void pageMappingAdd(Memory memory, U64_pow2 pageSize) {
     newNode->mappingSize = pageSize;
 
     VMMNodeInsert(&memoryMapperSizes.tree, newNode);
+    MEMORY_TRACE_RECORD(MEMORY_TRACE_MAPPING_ADD, memory, pageSize);
+    spinLockReleaseInterruptsRestore(&memoryMappingsLock,
+                                     interruptsWereEnabled);
 }
 
-PageFaultResult pageFaultHandle(U64 faultingAddress) {
-    U64_pow2 pageSizeForFault = pageSizeFromVMM(faultingAddress);
-    if (pageSizeForFault == GUARD_PAGE_SIZE) {
-        return PAGE_FAULT_RESULT_STACK_OVERFLOW;
-    }
+U64_pow2 pageMappingSize(U64 address) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&memoryMappingsLock);
+    U64_pow2 result = mappingGet(address)->mappingSize;
+    spinLockReleaseInterruptsRestore(&memoryMappingsLock,
+                                     interruptsWereEnabled);
+    return result;
+}
 
-    U64 startingMap = alignDown(faultingAddress, pageSizeForFault);
-    U64_pow2 pageSizeToUse = pageSizeFitting(pageSizeForFault);
+void pageMappingResize(U64 address, U64 bytes) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&memoryMappingsLock);
+    VMMNode *node = mappingGet(address);
+    node->bytes = bytes;
+    MEMORY_TRACE_RECORD(MEMORY_TRACE_MAPPING_RESIZE,
+                        ((Memory){.start = address, .bytes = bytes}),
+                        node->mappingSize);
+    spinLockReleaseInterruptsRestore(&memoryMappingsLock,
+                                     interruptsWereEnabled);
+}
 
-    // NOTE: when starting to use SMP, I should first check if this memory
-    // is now mapped before doing this.
-    // In the context of mapping and unmapping. It may be interesting to
-    // mark which cores have accessed which memory so we can limit the
-    // flushPage calls to all cores.
+U64_pow2 pageFaultHandle(U64 faultingAddress) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&memoryMappingsLock);
+    U64_pow2 pageSizeForFault = pageSizeFromVMM(faultingAddress);
+    spinLockReleaseInterruptsRestore(&memoryMappingsLock,
+                                     interruptsWereEnabled);
 
-    U32_pow2 mapsToDo = (U32)dividePowerOf2(pageSizeForFault, pageSizeToUse);
-    for (U32 i = 0; i < mapsToDo; i++) {
-        U8 *address = physicalMemoryAlloc(pageSizeToUse);
-        pageMap(startingMap + (i * pageSizeToUse), (U64)address, pageSizeToUse);
+    MEMORY_TRACE_RECORD(MEMORY_TRACE_PAGE_FAULT,
+                        ((Memory){.start = faultingAddress, .bytes = 0}),
+                        pageSizeForFault);
+    if (pageSizeForFault == GUARD_PAGE_SIZE) {
+        return GUARD_PAGE_SIZE;
     }
 
-    return PAGE_FAULT_RESULT_MAPPED;
+    pageBack(faultingAddress, pageSizeForFault);
+
+    return pageSizeForFault;
 }
@@ -2,6 +2,7 @@
 #define SHARED_MEMORY_POLICY_H
 
 #include "shared/memory/management/definitions.h"
+#include "shared/memory/sizes.h"
 #include "shared/types/numeric.h"
 
 [[nodiscard]] __attribute__((malloc, alloc_align(1))) void *
@@ -14,5 +15,25 @@ void identityMemoryNotBlockSizeFree(Memory memory);
 [[nodiscard]] __attribute__((malloc, alloc_align(1))) void *
 mappableMemoryAlloc(U64_pow2 blockSize, U64_pow2 mappingSize);
 void mappableMemoryFree(Memory memory);
+// Grows or shrinks mappable memory without copying its data. Growing happens in
+// place if the adjacent virtual memory is free, otherwise the page table
+// entries are moved to a new virtual range. Returns the (possibly new) start.
+[[nodiscard]] void *mappableMemoryResize(Memory memory, U64_pow2 newBytes);
+
+// Exact-size alternative to mappableMemoryAlloc that packs many medium-sized
+// mappings together. If guardBytes is set, that many bytes directly below the
+// result are reserved and fault as a stack overflow when touched.
+[[nodiscard]] __attribute__((malloc)) void *
+mappableRangeAlloc(U64 bytes, U64_pow2 mappingSize, U64 guardBytes);
+void mappableRangeFree(Memory memory, U64 guardBytes);
+
+// NOTE: Large enough that a big stack frame does not jump over it.
+static constexpr auto STACK_GUARD_BYTES = 64 * KiB;
+
+// Stacks are reserved virtually, with a guard below them. The top bytesBacked
+// bytes are backed right away, the rest on demand by the page fault handler as
+// the stack grows.
+[[nodiscard]] Memory mappableStackAlloc(U64 bytes, U64 bytesBacked);
+void mappableStackFree(Memory stack);
 
 #endif
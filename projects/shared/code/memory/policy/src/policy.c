@@ -4,6 +4,7 @@
 #include "abstraction/memory/virtual/converter.h"
 #include "abstraction/memory/virtual/map.h"
 #include "shared/assert.h"
+#include "shared/lock/spin.h"
 #include "shared/maths.h"
 #include "shared/memory/management/management.h"
 #include "shared/memory/management/page.h"
@@ -42,13 +43,27 @@ void *mappableMemoryAlloc(U64_pow2 blockSize, U64_pow2 mappingSize) {
     return result;
 }
 
-void mappableMemoryFree(Memory memory) {
-    ASSERT(aligned(memory.start, pageSizeSmallest()));
-    ASSERT(aligned(memory.bytes, pageSizeSmallest()));
-
+typedef struct {
     U64 virtualAddresses[PAGE_CACHE_FLUSH_THRESHOLD];
-    U32 virtualAddressesLen = 0;
+    U32 len;
+} PageCacheFlushBatch;
+
+static void pageCacheFlushBatchAdd(PageCacheFlushBatch *batch, U64 virt) {
+    if (batch->len < PAGE_CACHE_FLUSH_THRESHOLD) {
+        batch->virtualAddresses[batch->len] = virt;
+        batch->len++;
+    }
+}
+
+static void pageCacheFlushBatchExecute(PageCacheFlushBatch *batch) {
+    pageCacheEntriesShootdown(batch->virtualAddresses, batch->len);
+}
 
+// NOTE: The batch is only shot down after the page tables lock is released,
+// other processors may wait on the lock with interrupts disabled.
+static void mappedMemoryRelease(Memory memory, PageCacheFlushBatch *batch) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&pageTablesLock);
     Memory toFreePhysical = {0};
     Memory mapped;
     for (U64 virtualPageStartAddress = memory.start,
@@ -68,24 +83,146 @@ void mappableMemoryFree(Memory memory) {
             }
         }
 
-        if (virtualAddressesLen < PAGE_CACHE_FLUSH_THRESHOLD) {
-            virtualAddresses[virtualAddressesLen] = virtualPageStartAddress;
-            virtualAddressesLen++;
-        }
+        pageCacheFlushBatchAdd(batch, virtualPageStartAddress);
     }
 
     if (toFreePhysical.start) {
         physicalMemoryFree(toFreePhysical);
     }
+    spinLockReleaseInterruptsRestore(&pageTablesLock, interruptsWereEnabled);
+}
+
+void mappableMemoryFree(Memory memory) {
+    ASSERT(aligned(memory.start, pageSizeSmallest()));
+    ASSERT(aligned(memory.bytes, pageSizeSmallest()));
 
-    if (virtualAddressesLen < PAGE_CACHE_FLUSH_THRESHOLD) {
-        for (typeof(virtualAddressesLen) i = 0; i < virtualAddressesLen; i++) {
-            pageCacheEntryFlush(virtualAddresses[i]);
+    PageCacheFlushBatch batch = {0};
+    mappedMemoryRelease(memory, &batch);
+    pageCacheFlushBatchExecute(&batch);
+
+    pageMappingRemove(memory.start);
+    virtualMemoryFree(memory);
+}
+
+// Moves the page table entries of the old range to the new range. The
+// physical memory stays where it is, so no data is copied.
+static void mappedMemoryMove(Memory memory, U64 newStart,
+                             PageCacheFlushBatch *batch) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&pageTablesLock);
+    Memory mapped;
+    for (U64 offset = 0; offset < memory.bytes; offset += mapped.bytes) {
+        U64 virtualPageStartAddress = memory.start + offset;
+        mapped = pageUnmap(virtualPageStartAddress);
+        if (mapped.start) {
+            pageMap(newStart + offset, mapped.start, mapped.bytes);
+            pageCacheFlushBatchAdd(batch, virtualPageStartAddress);
+        } else {
+            // NOTE: An empty entry can be larger than what is left of the
+            // range or not aligned to it, so skip to its end.
+            mapped.bytes = alignUp(virtualPageStartAddress + 1, mapped.bytes) -
+                           virtualPageStartAddress;
         }
-    } else {
-        pageCacheFlush();
+    }
+    spinLockReleaseInterruptsRestore(&pageTablesLock, interruptsWereEnabled);
+}
+
+void *mappableMemoryResize(Memory memory, U64_pow2 newBytes) {
+    ASSERT(aligned(memory.start, pageSizeSmallest()));
+    ASSERT(powerOf2(memory.bytes));
+    ASSERT(powerOf2(newBytes));
+    ASSERT(newBytes >= pageSizeSmallest());
+
+    U64_pow2 mappingSize = pageMappingSize(memory.start);
+    ASSERT(newBytes >= mappingSize);
+
+    if (newBytes == memory.bytes) {
+        return (void *)memory.start;
+    }
+
+    if (newBytes < memory.bytes) {
+        Memory tail = {.start = memory.start + newBytes,
+                       .bytes = memory.bytes - newBytes};
+
+        PageCacheFlushBatch batch = {0};
+        mappedMemoryRelease(tail, &batch);
+        pageCacheFlushBatchExecute(&batch);
+
+        virtualMemoryFree(tail);
+        pageMappingResize(memory.start, newBytes);
+        return (void *)memory.start;
     }
 
+    if (virtualMemoryClaim((Memory){.start = memory.start + memory.bytes,
+                                    .bytes = newBytes - memory.bytes})) {
+        pageMappingResize(memory.start, newBytes);
+        return (void *)memory.start;
+    }
+
+    void *result = virtualMemoryAlloc(newBytes);
+
+    PageCacheFlushBatch batch = {0};
+    mappedMemoryMove(memory, (U64)result, &batch);
+    pageCacheFlushBatchExecute(&batch);
+
     pageMappingRemove(memory.start);
+    pageMappingAdd((Memory){.start = (U64)result, .bytes = newBytes},
+                   mappingSize);
     virtualMemoryFree(memory);
+
+    return result;
+}
+
+void *mappableRangeAlloc(U64 bytes, U64_pow2 mappingSize, U64 guardBytes) {
+    ASSERT(aligned(bytes, mappingSize));
+    ASSERT(powerOf2(mappingSize));
+    ASSERT(mappingSize >= pageSizeSmallest());
+
+    void *result = virtualRangeAlloc(bytes, mappingSize, guardBytes);
+    pageMappingAdd((Memory){.start = (U64)result, .bytes = bytes},
+                   mappingSize);
+    if (guardBytes) {
+        pageMappingAdd(
+            (Memory){.start = (U64)result - guardBytes, .bytes = guardBytes},
+            GUARD_PAGE_SIZE);
+    }
+
+    return result;
+}
+
+void mappableRangeFree(Memory memory, U64 guardBytes) {
+    ASSERT(aligned(memory.start, pageSizeSmallest()));
+    ASSERT(aligned(memory.bytes, pageSizeSmallest()));
+
+    // NOTE: The TLB is flushed lazily by the range allocator before the range
+    // is handed out again.
+    PageCacheFlushBatch batch = {0};
+    mappedMemoryRelease(memory, &batch);
+
+    pageMappingRemove(memory.start);
+    if (guardBytes) {
+        pageMappingRemove(memory.start - guardBytes);
+    }
+    virtualRangeFree(memory, guardBytes);
+}
+
+Memory mappableStackAlloc(U64 bytes, U64 bytesBacked) {
+    ASSERT(bytesBacked <= bytes);
+
+    Memory stack = {.start = (U64)mappableRangeAlloc(bytes, pageSizeSmallest(),
+                                                     STACK_GUARD_BYTES),
+                    .bytes = bytes};
+
+    // NOTE: Backed from the top, that is where the stack starts growing.
+    U64 stackTop = stack.start + stack.bytes;
+    for (U64 address = stackTop - alignUp(bytesBacked, pageSizeSmallest());
+         address < stackTop; address += pageSizeSmallest()) {
+        (void)pageFaultHandle(address);
+    }
+
+    return stack;
+}
+
+void mappableStackFree(Memory stack) {
+    mappableRangeFree(stack, STACK_GUARD_BYTES);
 }
@@ -0,0 +1,167 @@
+#include "abstraction/jmp.h"
+#include "abstraction/log.h"
+#include "abstraction/text/converter/base.h"
+#include "posix/log.h"
+#include "posix/memory/virtual.h"
+#include "posix/test-framework/test.h"
+#include "shared/log.h"
+#include "shared/macros.h"
+#include "shared/maths.h"
+#include "shared/memory/management/definitions.h"
+#include "shared/memory/policy.h"
+#include "shared/memory/policy/status.h"
+#include "shared/memory/sizes.h"
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+
+// NOTE: Runs the same stack as the kernel, only the page table and the page
+// faults are simulated, see posix/memory/virtual.h. So this can be profiled as
+// a normal process, e.g., with perf.
+static constexpr auto PHYSICAL_MEMORY = 1 * GiB;
+static constexpr auto VIRTUAL_MEMORY = 64 * GiB;
+
+static constexpr auto TEST_MEMORY_AMOUNT = 32 * MiB;
+static constexpr auto MAX_TEST_ENTRIES = TEST_MEMORY_AMOUNT / sizeof(U64);
+
+static void entriesWrite(U64 *buffer, U64 from, U64 to) {
+    for (U64 i = from; i < to; i++) {
+        buffer[i] = i;
+    }
+}
+
+static void entriesCheck(U64 *buffer, U64 entries) {
+    for (U64 i = 0; i < entries; i++) {
+        if (buffer[i] != i) {
+            TEST_FAILURE {
+                INFO(STRING("Arithmetic error at i="));
+                INFO(i);
+                INFO(STRING(", actual="));
+                INFO(buffer[i], .flags = NEWLINE);
+            }
+        }
+    }
+}
+
+static void virtualMemoryReturned(AvailableMemoryState start) {
+    AvailableMemoryState end = virtualMemoryAvailableGet();
+    if (end.memory != start.memory || end.addresses != start.addresses) {
+        TEST_FAILURE {
+            INFO(STRING("Virtual memory was not given back\n"));
+            INFO(STRING("Expected memory: "));
+            INFO(start.memory);
+            INFO(STRING(" addresses: "));
+            INFO(start.addresses, .flags = NEWLINE);
+            INFO(STRING("Actual memory: "));
+            INFO(end.memory);
+            INFO(STRING(" addresses: "));
+            INFO(end.addresses, .flags = NEWLINE);
+        }
+    }
+}
+
+static void testMappableMemory(U64_pow2 mappingSize) {
+    AvailableMemoryState startVirtualMemory = virtualMemoryAvailableGet();
+
+    U64 *buffer = mappableMemoryAlloc(TEST_MEMORY_AMOUNT, mappingSize);
+
+    U64 startPageFaults = hostedMemory.pageFaults;
+    U64 startPagesMapped = hostedMemory.pagesMapped;
+    entriesWrite(buffer, 0, MAX_TEST_ENTRIES);
+    U64 pagesMapped = hostedMemory.pagesMapped - startPagesMapped;
+
+    testCountEqual(STRING("page faults"),
+                   dividePowerOf2(TEST_MEMORY_AMOUNT, mappingSize),
+                   hostedMemory.pageFaults - startPageFaults);
+    entriesCheck(buffer, MAX_TEST_ENTRIES);
+
+    U64 startPagesUnmapped = hostedMemory.pagesUnmapped;
+    U64 startFlushes = hostedMemory.pageCacheEntriesFlushed +
+                       hostedMemory.pageCacheFullFlushes;
+    mappableMemoryFree(
+        (Memory){.start = (U64)buffer, .bytes = TEST_MEMORY_AMOUNT});
+
+    testCountEqual(STRING("pages unmapped"), pagesMapped,
+                   hostedMemory.pagesUnmapped - startPagesUnmapped);
+    if (hostedMemory.pageCacheEntriesFlushed +
+            hostedMemory.pageCacheFullFlushes ==
+        startFlushes) {
+        TEST_FAILURE { INFO(STRING("Page cache was not flushed\n")); }
+    }
+    virtualMemoryReturned(startVirtualMemory);
+
+    testSuccess();
+}
+
+static void testMappableMemoryResize(U64_pow2 mappingSize) {
+    AvailableMemoryState startVirtualMemory = virtualMemoryAvailableGet();
+
+    U64 startBytes = MAX(mappingSize, 16 * KiB);
+    U64 startEntries = startBytes / sizeof(U64);
+    U64 *buffer = mappableMemoryAlloc(startBytes, mappingSize);
+    entriesWrite(buffer, 0, startEntries);
+
+    // NOTE: Usually takes the range right after the buffer, so growing has to
+    // move the page table entries instead.
+    void *blocker = mappableMemoryAlloc(startBytes, mappingSize);
+
+    U64 startPageFaults = hostedMemory.pageFaults;
+    buffer = mappableMemoryResize(
+        (Memory){.start = (U64)buffer, .bytes = startBytes},
+        TEST_MEMORY_AMOUNT);
+    entriesCheck(buffer, startEntries);
+    testCountEqual(STRING("page faults after moving"), 0,
+                   hostedMemory.pageFaults - startPageFaults);
+
+    entriesWrite(buffer, startEntries, MAX_TEST_ENTRIES);
+    entriesCheck(buffer, MAX_TEST_ENTRIES);
+
+    mappableMemoryFree(
+        (Memory){.start = (U64)buffer, .bytes = TEST_MEMORY_AMOUNT});
+    mappableMemoryFree((Memory){.start = (U64)blocker, .bytes = startBytes});
+    virtualMemoryReturned(startVirtualMemory);
+
+    testSuccess();
+}
+
+static U64_pow2 mappingSizes[] = {4 * KiB, 16 * KiB, 2 * MiB};
+
+static void testPolicy() {
+    TEST_TOPIC(STRING("Mappable memory")) {
+        JumpBuffer failureHandler;
+        for (U64 i = 0; i < COUNTOF(mappingSizes); i++) {
+            if (setjmp(failureHandler)) {
+                continue;
+            }
+            TEST(U64ToStringDefault(mappingSizes[i]), failureHandler) {
+                testMappableMemory(mappingSizes[i]);
+            }
+        }
+    }
+
+    TEST_TOPIC(STRING("Mappable memory resize")) {
+        JumpBuffer failureHandler;
+        for (U64 i = 0; i < COUNTOF(mappingSizes); i++) {
+            if (setjmp(failureHandler)) {
+                continue;
+            }
+            TEST(U64ToStringDefault(mappingSizes[i]), failureHandler) {
+                testMappableMemoryResize(mappingSizes[i]);
+            }
+        }
+    }
+}
+
+int main() {
+    if (!hostedMemoryInit(PHYSICAL_MEMORY, VIRTUAL_MEMORY)) {
+        PFLUSH_AFTER(STDERR) {
+            ERROR(STRING("Failed to set up hosted memory!\n"));
+        }
+        return -1;
+    }
+
+    testSuiteStart(STRING("Memory Policy"));
+
+    testPolicy();
+
+    return testSuiteFinish();
+}
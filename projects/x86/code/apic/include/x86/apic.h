@@ -0,0 +1,65 @@
+#ifndef X86_APIC_H
+#define X86_APIC_H
+
+#include "shared/types/numeric.h"
+
+// NOTE: Offsets from the start of the memory mapped local APIC registers.
+static constexpr U32 APIC_ID_REGISTER = 0x20;
+static constexpr U32 APIC_EOI_REGISTER = 0xB0;
+static constexpr U32 APIC_SPURIOUS_INTERRUPT_VECTOR_REGISTER = 0xF0;
+static constexpr U32 APIC_ERROR_STATUS_REGISTER = 0x280;
+static constexpr U32 APIC_ICR_LOW_REGISTER = 0x300;
+static constexpr U32 APIC_ICR_HIGH_REGISTER = 0x310;
+static constexpr U32 APIC_LVT_TIMER_REGISTER = 0x320;
+static constexpr U32 APIC_LVT_PERFORMANCE_COUNTER_REGISTER = 0x340;
+static constexpr U32 APIC_TIMER_INITIAL_COUNT_REGISTER = 0x380;
+static constexpr U32 APIC_TIMER_CURRENT_COUNT_REGISTER = 0x390;
+static constexpr U32 APIC_TIMER_DIVIDE_CONFIGURATION_REGISTER = 0x3E0;
+
+static constexpr U32 APIC_SPURIOUS_INTERRUPT_SOFTWARE_ENABLE = (1 << 8);
+
+static constexpr U32 APIC_LVT_DELIVERY_MODE_NMI = (0b100 << 8);
+static constexpr U32 APIC_LVT_MASKED = (1 << 16);
+static constexpr U32 APIC_TIMER_MODE_ONE_SHOT = (0b00 << 17);
+static constexpr U32 APIC_TIMER_MODE_TSC_DEADLINE = (0b10 << 17);
+static constexpr U32 APIC_TIMER_DIVIDE_BY_16 = 0b0011;
+
+static constexpr U32 APIC_ICR_DELIVERY_MODE_FIXED = (0b000 << 8);
+static constexpr U32 APIC_ICR_DELIVERY_MODE_INIT = (0b101 << 8);
+static constexpr U32 APIC_ICR_DELIVERY_MODE_START_UP = (0b110 << 8);
+static constexpr U32 APIC_ICR_DELIVERY_STATUS_PENDING = (1 << 12);
+static constexpr U32 APIC_ICR_LEVEL_ASSERT = (1 << 14);
+static constexpr U32 APIC_ICR_TRIGGER_MODE_LEVEL = (1 << 15);
+static constexpr auto APIC_ICR_DESTINATION_SHIFT = 24;
+
+// NOTE: Processors can only be addressed with 8 bits in xAPIC mode.
+static constexpr U32 APIC_ID_MAX = 0xFF;
+
+// The memory mapped registers of the local APIC. Every processor sees its own
+// local APIC at the same address.
+extern U8 *APICBase;
+
+[[nodiscard]] U32 APICRead(U32 reg);
+void APICWrite(U32 reg, U32 value);
+
+// Sends the INIT-SIPI-SIPI sequence. The processor starts executing in real
+// mode at startAddress, which must be page-aligned and below 1 MiB.
+void APICProcessorStart(U32 APICID, U32 startAddress);
+// Sends an INIT, which leaves the processor waiting for a start-up IPI.
+void APICProcessorStop(U32 APICID);
+
+// Software-enables the local APIC of the current processor, without it no
+// fixed interrupts are accepted. The spurious vector must not be acknowledged.
+void APICEnable(U8 spuriousVector);
+void APICInterruptSend(U32 APICID, U8 vector);
+
+// Sets up the timer of the current processor as a one-shot timer that fires
+// the vector. Uses TSC-deadline mode where available, otherwise the timer is
+// calibrated against the TSC once.
+void APICTimerInit(U8 vector);
+// Fires the timer once after the given time, replacing an earlier arming.
+void APICTimerArm(U64 microSeconds);
+// Same, but for a deadline in cycles. A deadline that passed fires right away.
+void APICTimerDeadlineArm(U64 cycles);
+
+#endif
@@ -0,0 +1,133 @@
+#include "x86/apic.h"
+
+#include "abstraction/time.h"
+#include "shared/maths.h"
+#include "shared/types/numeric.h"
+#include "x86/configuration/cpu.h"
+#include "x86/configuration/features.h"
+#include "x86/time.h"
+
+U8 *APICBase;
+
+U32 APICRead(U32 reg) { return *(volatile U32 *)(APICBase + reg); }
+
+void APICWrite(U32 reg, U32 value) {
+    *(volatile U32 *)(APICBase + reg) = value;
+}
+
+static void APICInterruptCommandSend(U32 APICID, U32 command) {
+    while (APICRead(APIC_ICR_LOW_REGISTER) &
+           APIC_ICR_DELIVERY_STATUS_PENDING) {
+        asm volatile("pause" ::: "memory");
+    }
+
+    // NOTE: Writing the low register sends the IPI, so set the destination
+    // first.
+    APICWrite(APIC_ICR_HIGH_REGISTER, APICID << APIC_ICR_DESTINATION_SHIFT);
+    APICWrite(APIC_ICR_LOW_REGISTER, command);
+}
+
+void APICInterruptSend(U32 APICID, U8 vector) {
+    APICInterruptCommandSend(APICID, APIC_ICR_DELIVERY_MODE_FIXED | vector);
+}
+
+void APICEnable(U8 spuriousVector) {
+    APICWrite(APIC_SPURIOUS_INTERRUPT_VECTOR_REGISTER,
+              APIC_SPURIOUS_INTERRUPT_SOFTWARE_ENABLE | spuriousVector);
+}
+
+static constexpr U32 IA32_TSC_DEADLINE_LOCATION = 0x6E0;
+static constexpr auto TIMER_CALIBRATION_MICROSECONDS = 10 * 1000;
+
+static bool TSCDeadlineUsed;
+static U64 timerTicksPerMicroSecond;
+
+static void timerCalibrate() {
+    APICWrite(APIC_TIMER_DIVIDE_CONFIGURATION_REGISTER,
+              APIC_TIMER_DIVIDE_BY_16);
+    APICWrite(APIC_LVT_TIMER_REGISTER,
+              APIC_LVT_MASKED | APIC_TIMER_MODE_ONE_SHOT);
+    APICWrite(APIC_TIMER_INITIAL_COUNT_REGISTER, U32_MAX);
+    waitBlock(TIMER_CALIBRATION_MICROSECONDS);
+    U32 ticks = U32_MAX - APICRead(APIC_TIMER_CURRENT_COUNT_REGISTER);
+    APICWrite(APIC_TIMER_INITIAL_COUNT_REGISTER, 0);
+
+    timerTicksPerMicroSecond = MAX(ticks / TIMER_CALIBRATION_MICROSECONDS, 1);
+}
+
+void APICTimerInit(U8 vector) {
+    CPUIDResult processorInfoAndFeatureBits =
+        CPUID(BASIC_PROCESSOR_INFO_AND_FEATURE_BITS);
+    BASICCPUFeatures features = {.ecx = processorInfoAndFeatureBits.ecx,
+                                 .edx = processorInfoAndFeatureBits.edx};
+    TSCDeadlineUsed = features.TSC_DEADLINE;
+
+    if (TSCDeadlineUsed) {
+        APICWrite(APIC_LVT_TIMER_REGISTER,
+                  APIC_TIMER_MODE_TSC_DEADLINE | vector);
+        return;
+    }
+
+    if (!timerTicksPerMicroSecond) {
+        timerCalibrate();
+    }
+    APICWrite(APIC_TIMER_DIVIDE_CONFIGURATION_REGISTER,
+              APIC_TIMER_DIVIDE_BY_16);
+    APICWrite(APIC_LVT_TIMER_REGISTER, APIC_TIMER_MODE_ONE_SHOT | vector);
+}
+
+void APICTimerArm(U64 microSeconds) {
+    if (TSCDeadlineUsed) {
+        wrmsr(IA32_TSC_DEADLINE_LOCATION,
+              cycleCounterGet(false, false) +
+                  microSeconds * tscCyclesPerMicroSecond);
+        return;
+    }
+
+    APICWrite(APIC_TIMER_INITIAL_COUNT_REGISTER,
+              (U32)MIN(microSeconds * timerTicksPerMicroSecond, U32_MAX));
+}
+
+void APICTimerDeadlineArm(U64 cycles) {
+    if (TSCDeadlineUsed) {
+        wrmsr(IA32_TSC_DEADLINE_LOCATION, cycles);
+        return;
+    }
+
+    // NOTE: An initial count of 0 stops the timer, so fire at least a tick
+    // later.
+    U64 now = cycleCounterGet(false, false);
+    U64 ticks = cycles > now
+                    ? ((cycles - now) * timerTicksPerMicroSecond) /
+                          tscCyclesPerMicroSecond
+                    : 0;
+    APICWrite(APIC_TIMER_INITIAL_COUNT_REGISTER,
+              (U32)MIN(MAX(ticks, 1), U32_MAX));
+}
+
+static constexpr auto INIT_WAIT_MICROSECONDS = 10 * 1000;
+static constexpr auto START_UP_WAIT_MICROSECONDS = 200;
+static constexpr auto START_UP_ATTEMPTS = 2;
+
+void APICProcessorStart(U32 APICID, U32 startAddress) {
+    APICWrite(APIC_ERROR_STATUS_REGISTER, 0);
+
+    APICInterruptCommandSend(APICID, APIC_ICR_DELIVERY_MODE_INIT |
+                                         APIC_ICR_LEVEL_ASSERT |
+                                         APIC_ICR_TRIGGER_MODE_LEVEL);
+    waitBlock(INIT_WAIT_MICROSECONDS);
+
+    // NOTE: The vector of a start-up IPI is the page number of the address
+    // to start executing at.
+    for (typeof_unqual(START_UP_ATTEMPTS) i = 0; i < START_UP_ATTEMPTS; i++) {
+        APICInterruptCommandSend(APICID, APIC_ICR_DELIVERY_MODE_START_UP |
+                                             (startAddress >> 12));
+        waitBlock(START_UP_WAIT_MICROSECONDS);
+    }
+}
+
+void APICProcessorStop(U32 APICID) {
+    APICInterruptCommandSend(APICID, APIC_ICR_DELIVERY_MODE_INIT |
+                                         APIC_ICR_LEVEL_ASSERT |
+                                         APIC_ICR_TRIGGER_MODE_LEVEL);
+}
@@ -8,6 +8,15 @@ void wrmsr(U32 msr, U64 value);
 
 void flushCPUCaches();
 
+[[nodiscard]] U8 inb(U16 port);
+[[nodiscard]] U32 inl(U16 port);
+void outb(U16 port, U8 value);
+
+// NOTE: Set by the kernel once other processors share the address space. From
+// PAGE_CACHE_FLUSH_THRESHOLD entries on, it stands for a full flush.
+typedef void (*PageCacheRemoteFlush)(U64 *virts, U32 len);
+extern PageCacheRemoteFlush pageCacheRemoteFlush;
+
 typedef U32 CPUIDLeaf;
 
 // NOTE: constexpr c26 for max calculation
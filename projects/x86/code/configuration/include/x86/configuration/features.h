@@ -183,6 +183,15 @@ typedef struct {
     };
 } BASICCPUFeatures;
 
+// NOTE: The values are also used in isr.S, keep them in sync!
+typedef enum : U8 {
+    XSAVE_INSTRUCTION_XSAVEC = 0,
+    XSAVE_INSTRUCTION_XSAVEOPT = 1,
+    XSAVE_INSTRUCTION_XSAVES = 2,
+} XSAVEInstruction;
+
+static constexpr U32 IA32_XSS_LOCATION = 0xDA0;
+
 void PGEEnable();
 void FPUEnable();
 void XSAVEEnableAndConfigure(bool supportsAVX512);
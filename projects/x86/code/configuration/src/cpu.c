@@ -1,5 +1,4 @@
 #include "x86/configuration/cpu.h"
-#include "abstraction/memory/virtual/map.h"
 
 U64 rdmsr(U32 msr) {
     U32 edx;
@@ -14,16 +13,23 @@ void wrmsr(U32 msr, U64 value) {
     asm volatile("wrmsr" : : "a"(eax), "d"(edx), "c"(msr) : "memory");
 }
 
-void pageCacheEntryFlush(U64 virt) {
-    asm volatile("invlpg (%0)" ::"r"(virt) : "memory");
+void flushCPUCaches() { asm volatile("wbinvd" ::: "memory"); }
+
+U8 inb(U16 port) {
+    U8 ret;
+    asm volatile("inb %1, %0" : "=a"(ret) : "Nd"(port));
+    return ret;
 }
-void pageCacheFlush() {
-    U64 cr3;
-    asm volatile("mov %%cr3, %0" : "=r"(cr3)::"memory");
-    asm volatile("mov %0, %%cr3" ::"r"(cr3) : "memory");
+
+U32 inl(U16 port) {
+    U32 ret;
+    asm volatile("inl %1, %0" : "=a"(ret) : "Nd"(port));
+    return ret;
 }
 
-void flushCPUCaches() { asm volatile("wbinvd" ::: "memory"); }
+void outb(U16 port, U8 value) {
+    asm volatile("outb %0, %1" : : "a"(value), "Nd"(port));
+}
 
 CPUIDResult CPUIDWithSubleaf(U32 leaf, U32 subleaf) {
     CPUIDResult result;
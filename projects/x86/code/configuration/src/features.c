@@ -1,4 +1,5 @@
 #include "x86/configuration/features.h"
+#include "abstraction/memory/virtual/map.h"
 #include "shared/types/numeric.h"
 #include "x86/configuration/cpu.h"
 #include "x86/memory/pat.h"
@@ -169,6 +170,28 @@ void SSEEnable() {
 void PATConfigure() {
     PAT patValues = {.value = rdmsr(PAT_LOCATION)};
 
-    patValues.pats[3].pat = PAT_WRITE_COMBINGING_WC;
+    // NOTE: Only the lower 4 entries can be used by every page size, see
+    // PATMapping. Entry 1 (PWT) is rarely used by firmware, so it is repurposed
+    // for write combining while entry 3 (PWT | PCD) stays strong uncachable for
+    // any MMIO the firmware still has mapped.
+    patValues.pats[1].pat = PAT_WRITE_COMBINGING_WC;
+
+    // The SDM requires that no stale cache lines or TLB entries that were
+    // created with the old memory type survive the PAT change.
+    flushCPUCaches();
     wrmsr(PAT_LOCATION, patValues.value);
+    flushCPUCaches();
+
+    // NOTE: Reloading CR3 keeps the global entries, toggling CR4.PGE flushes
+    // all of them.
+    CR4 cr4;
+    asm volatile("mov %%cr4, %%rax" : "=a"(cr4));
+    if (cr4.PGE) {
+        cr4.PGE = 0;
+        asm volatile("mov %%rax, %%cr4" : : "a"(cr4) : "memory");
+        cr4.PGE = 1;
+        asm volatile("mov %%rax, %%cr4" : : "a"(cr4) : "memory");
+    } else {
+        pageCacheFlush();
+    }
 }
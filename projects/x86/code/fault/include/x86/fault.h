@@ -25,6 +25,11 @@ static constexpr auto TOTAL_IST_STACKS_BYTES =
     IST_STACK_SIZE * INTERRUPT_STACK_TABLE_COUNT;
 static_assert(TOTAL_IST_STACKS_BYTES % KERNEL_STACK_ALIGNMENT == 0);
 
+// NOTE: One XSAVE area per level of interrupt nesting: a maskable interrupt or
+// exception, a page fault, an NMI and a machine check.
+static constexpr auto XSAVE_NESTING_MAX = 4;
+static constexpr auto XSAVE_ALIGNMENT = 64;
+
 #define CPU_FAULT_ENUM(VARIANT)                                                \
     VARIANT(FAULT_DIVIDE_ERROR, 0)                                             \
     VARIANT(FAULT_DEBUG, 1)                                                    \
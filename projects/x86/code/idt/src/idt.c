@@ -1,5 +1,13 @@
 #include "abstraction/interrupts.h"
 
+static constexpr U64 RFLAGS_INTERRUPT_ENABLE = 1 << 9;
+
 void interruptsEnable() { asm volatile("sti;"); }
 
 void interruptsDisable() { asm volatile("cli;"); }
+
+bool interruptsEnabled() {
+    U64 flags;
+    asm volatile("pushfq; popq %0" : "=r"(flags));
+    return flags & RFLAGS_INTERRUPT_ENABLE;
+}
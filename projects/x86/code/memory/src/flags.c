@@ -6,4 +6,4 @@ U64 pageFlagsReadWrite() {
     return VirtualPageMasks.PAGE_PRESENT | VirtualPageMasks.PAGE_WRITABLE;
 }
 U64 pageFlagsNoCacheEvict() { return VirtualPageMasks.PAGE_GLOBAL; }
-U64 pageFlagsScreenMemory() { return PATMapping.MAP_3; }
+U64 pageFlagsScreenMemory() { return PATMapping.MAP_1; }
@@ -0,0 +1,35 @@
+#include "abstraction/memory/virtual/map.h"
+#include "shared/types/numeric.h"
+#include "x86/configuration/cpu.h"
+
+void pageCacheEntryFlush(U64 virt) {
+    asm volatile("invlpg (%0)" ::"r"(virt) : "memory");
+}
+void pageCacheFlush() {
+    U64 cr3;
+    asm volatile("mov %%cr3, %0" : "=r"(cr3)::"memory");
+    asm volatile("mov %0, %%cr3" ::"r"(cr3) : "memory");
+}
+
+PageCacheRemoteFlush pageCacheRemoteFlush;
+
+void pageCacheEntriesShootdown(U64 *virts, U32 len) {
+    if (len >= PAGE_CACHE_FLUSH_THRESHOLD) {
+        pageCacheShootdown();
+        return;
+    }
+
+    for (typeof(len) i = 0; i < len; i++) {
+        pageCacheEntryFlush(virts[i]);
+    }
+    if (pageCacheRemoteFlush && len) {
+        pageCacheRemoteFlush(virts, len);
+    }
+}
+
+void pageCacheShootdown() {
+    pageCacheFlush();
+    if (pageCacheRemoteFlush) {
+        pageCacheRemoteFlush(nullptr, PAGE_CACHE_FLUSH_THRESHOLD);
+    }
+}
@@ -182,3 +182,26 @@ Memory pageUnmap(U64 virt) {
 
     __builtin_unreachable();
 }
+
+bool pageMapped(U64 virt) {
+    ASSERT(pageTableRoot);
+
+    VirtualPageTable *pageTable = pageTableRoot;
+    for (U64_pow2 entrySize = PAGE_ROOT_ENTRY_MAX_SIZE;
+         entrySize >= pageSizeSmallest();
+         entrySize /= PageTableFormat.ENTRIES) {
+        U64 tableEntry = pageTable->pages[calculateTableIndex(virt, entrySize)];
+        if (!tableEntry) {
+            return false;
+        }
+
+        if (entrySize == pageSizeSmallest() ||
+            (tableEntry & VirtualPageMasks.PAGE_EXTENDED_SIZE)) {
+            return true;
+        }
+
+        pageTable = (VirtualPageTable *)getPhysicalAddressFrame(tableEntry);
+    }
+
+    __builtin_unreachable();
+}
@@ -1,24 +1,21 @@
 #include "abstraction/serial.h"
+#include "x86/configuration/cpu.h"
 #include "x86/serial.h"
 
-U8 inb(U16 port) {
-    U8 ret;
-    asm volatile("inb %1, %0" : "=a"(ret) : "Nd"(port));
-    return ret;
-}
+static constexpr auto LINE_STATUS_REGISTER_OFFSET = 5;
+static constexpr auto TRANSMITTER_HOLDING_REGISTER_EMPTY = 0b100000;
 
-void outb(U16 port, U8 value) {
-    asm volatile("outb %0, %1" : : "a"(value), "Nd"(port));
+bool serialReady() {
+    return inb(COM1 + LINE_STATUS_REGISTER_OFFSET) &
+           TRANSMITTER_HOLDING_REGISTER_EMPTY;
 }
 
-static constexpr auto LINE_STATUS_REGISTER_OFFSET = 5;
-static constexpr auto TRANSMITTER_HOLDING_REGISTER_EMPTY = 0b100000;
+void serialByteSend(U8 byte) { outb(COM1, byte); }
 
 void serialFlush(U8_a buffer) {
     for (typeof(buffer.len) i = 0; i < buffer.len; i++) {
-        while (!((inb(COM1 + LINE_STATUS_REGISTER_OFFSET) &
-                  TRANSMITTER_HOLDING_REGISTER_EMPTY))) {
+        while (!serialReady()) {
         }
-        outb(COM1, buffer.buf[i]);
+        serialByteSend(buffer.buf[i]);
     }
 }
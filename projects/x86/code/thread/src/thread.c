@@ -1,3 +1,5 @@
 #include "abstraction/thread.h"
 
 void threadHang() { asm volatile("cli; hlt;"); }
+
+void spinWaitHint() { asm volatile("pause" ::: "memory"); }
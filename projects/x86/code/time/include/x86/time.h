@@ -5,4 +5,11 @@
 
 extern U64 tscCyclesPerMicroSecond;
 
+// Sets the frequency that the cycle counter is converted with.
+void tscFrequencySet(U64 hertz);
+
+// An invariant TSC ticks at the same rate in all power states, otherwise the
+// cycle counter can not be used to keep time.
+[[nodiscard]] bool tscInvariant();
+
 #endif
@@ -1,5 +1,8 @@
 #include "abstraction/time.h"
+#include "x86/time.h"
+
 #include "shared/types/numeric.h"
+#include "x86/configuration/cpu.h"
 
 U64 cycleCounterGet(bool previousFinished, bool blocksSubsequent) {
     U32 edx;
@@ -16,9 +19,41 @@ U64 cycleCounterGet(bool previousFinished, bool blocksSubsequent) {
     return ((U64)edx << 32) | eax;
 }
 
-// NOTE: 1 GigaHertz = 1000 cycles per microsecond default - really should
-// calibrate this!
+static constexpr U64 NANOSECONDS_PER_SECOND = 1000000000;
+static constexpr U64 HERTZ_PER_MEGAHERTZ = 1000000;
+
+// NOTE: Nanoseconds per cycle as a fixed-point number with
+// TSC_NANOS_SHIFT fractional bits, so converting is a multiply and a shift.
+static constexpr auto TSC_NANOS_SHIFT = 32;
+
+// NOTE: Assumes 1 GigaHertz until tscFrequencySet is called.
 U64 tscCyclesPerMicroSecond = 1000;
+static U64 tscNanosMultiplier = 1ULL << TSC_NANOS_SHIFT;
+
+void tscFrequencySet(U64 hertz) {
+    tscCyclesPerMicroSecond = hertz / HERTZ_PER_MEGAHERTZ;
+    tscNanosMultiplier = (NANOSECONDS_PER_SECOND << TSC_NANOS_SHIFT) / hertz;
+}
+
+static constexpr auto INVARIANT_TSC = (1 << 8);
+
+bool tscInvariant() {
+    U32 maxExtendedLeaf = CPUID(EXTENDED_MAX_VALUE).eax;
+    if (maxExtendedLeaf < EXTENDED_PROCESSOR_POWER_MANEGEMENT_OPERATION) {
+        return false;
+    }
+    return CPUID(EXTENDED_PROCESSOR_POWER_MANEGEMENT_OPERATION).edx &
+           INVARIANT_TSC;
+}
+
+// NOTE: The product does not fit in 64 bits after a couple of seconds of
+// cycles, so multiply in 128 bits.
+U64 cyclesToNanos(U64 cycles) {
+    return (U64)(((unsigned __int128)cycles * tscNanosMultiplier) >>
+                 TSC_NANOS_SHIFT);
+}
+
+U64 monotonicNanos() { return cyclesToNanos(cycleCounterGet(false, false)); }
 
 // 1 millionth of a second
 void waitBlock(U64 microSeconds) {
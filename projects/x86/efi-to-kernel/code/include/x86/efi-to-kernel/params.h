@@ -2,14 +2,29 @@
 #define X86_EFI_TO_KERNEL_PARAMS_H
 
 #include "shared/types/numeric.h"
+#include "x86/configuration/features.h"
 #include "x86/memory/virtual.h"
 
 // NOTE: Used for crossing ABI boundaries.
 
+static constexpr auto PROCESSORS_MAX = 64;
+
+typedef struct {
+    U32 count; // The bootstrap processor is always the first processor
+    U32 APICIDs[PROCESSORS_MAX];
+    U64 stackTops[PROCESSORS_MAX];
+    U8 *APICBase;
+    U64 trampolinePhysical; // An identity-mapped page below 1 MiB
+} ProcessorParams;
+
 typedef struct {
-    U64 tscFrequencyPerMicroSecond;
+    U64 tscFrequencyHertz;
+    // XSAVE_NESTING_MAX areas of XSAVEAreaBytes each per processor
     U8 *XSAVELocation;
+    U64 XSAVEAreaBytes;
+    XSAVEInstruction XSAVEInstructionUsed;
     PageMetaDataNode pageMetaDataRoot;
+    ProcessorParams processors;
 } X86ArchParams;
 
 #endif
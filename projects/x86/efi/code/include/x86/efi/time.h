@@ -4,6 +4,14 @@
 #include "shared/types/numeric.h"
 
 static constexpr auto MICROSECONDS_PER_SECOND = 1000000;
+
+// Reads the TSC frequency from the processor. Returns 0 if the processor does
+// not tell.
 [[nodiscard]] U64 timestampFrequencyGet();
 
+// Measures the TSC frequency against a timer with a known frequency. The ACPI
+// PM timer is preferred, then the HPET, and the PIT is the fallback that every
+// PC has.
+[[nodiscard]] U64 timestampFrequencyCalibrate();
+
 #endif
@@ -7,8 +7,12 @@
 #include "abstraction/log.h"
 #include "abstraction/memory/manipulation.h"
 #include "abstraction/memory/virtual/allocator.h"
+#include "abstraction/memory/virtual/converter.h"
 #include "abstraction/time.h"
 #include "efi-to-kernel/memory/definitions.h"
+#include "efi/acpi/madt.h"
+#include "efi/acpi/rdsp.h"
+#include "efi/acpi/rsdt.h"
 #include "efi/error.h"
 #include "efi/firmware/base.h"   // for PhysicalAddress
 #include "efi/firmware/system.h" // for PhysicalAddress
@@ -18,11 +22,13 @@
 #include "shared/log.h"
 #include "shared/maths.h"
 #include "shared/memory/allocator/macros.h"
+#include "shared/memory/management/init.h"
 #include "shared/memory/management/management.h"
 #include "shared/memory/management/page.h"
 #include "shared/memory/management/status.h"
 #include "shared/text/string.h"
 #include "shared/types/numeric.h"
+#include "x86/apic.h"
 #include "x86/configuration/cpu.h"
 #include "x86/configuration/features.h"
 #include "x86/efi-to-kernel/params.h"
@@ -30,7 +36,9 @@
 #include "x86/fault.h"
 #include "x86/gdt.h"
 #include "x86/memory/definitions.h"
+#include "x86/memory/pat.h"
 #include "x86/memory/virtual.h"
+#include "x86/time.h"
 
 static constexpr auto MANUFACTURER_STRING_LEN = 12;
 
@@ -89,8 +97,8 @@ static constexpr auto MAX_BYTES_GDT = 64 * KiB;
 // - x tss descriptors = 16 * x bytes !!! should be aligned to 16 bytes for
 // performance reasons.
 // So, we align the GDT to 16 bytes, so everything is at least self-aligned.
-static void prepareDescriptors(U16 numberOfProcessors, U16 cacheLineSizeBytes,
-                               U64 memoryVirtualAddressAvailable) {
+static U64 prepareDescriptors(U16 numberOfProcessors, U16 cacheLineSizeBytes,
+                              U64 memoryVirtualAddressAvailable) {
     U32 requiredBytesForDescriptorTable =
         CODE_SEGMENTS_BYTES + numberOfProcessors * sizeof(TSSDescriptor);
     if (requiredBytesForDescriptorTable > MAX_BYTES_GDT) {
@@ -171,7 +179,8 @@ static void prepareDescriptors(U16 numberOfProcessors, U16 cacheLineSizeBytes,
             for (typeof_unqual(INTERRUPT_STACK_TABLE_COUNT) j = 0;
                  j < INTERRUPT_STACK_TABLE_COUNT; j++) {
                 StackResult stackResult = stackCreateAndMap(
-                    memoryVirtualAddressAvailable, IST_STACK_SIZE, false);
+                    memoryVirtualAddressAvailable, IST_STACK_SIZE,
+                    IST_STACK_SIZE, false);
                 memoryVirtualAddressAvailable =
                     stackResult.virtualMemoryFirstAvailable;
                 perCPUTSS->ists[j] = stackResult.stackVirtualTop;
@@ -200,15 +209,132 @@ static void prepareDescriptors(U16 numberOfProcessors, U16 cacheLineSizeBytes,
 
     gdtDescriptor = (DescriptorTableRegister){
         .limit = ((U16)requiredBytesForDescriptorTable) - 1, .base = (U64)GDT};
+
+    return memoryVirtualAddressAvailable;
 }
 
-static void bootstrapProcessorWork(U16 cacheLineSizeBytes,
-                                   U64 memoryVirtualAddressAvailable) {
+// Collects the APIC IDs of the processors that can be started from the MADT
+// and returns the physical address of the local APIC.
+static U64 processorsFind(ProcessorParams *processors, U32 BSPAPICID) {
+    RSDPResult rsdp = RSDPGet(globals.st->number_of_table_entries,
+                              globals.st->configuration_table);
+    if (!rsdp.rsdp) {
+        EXIT_WITH_MESSAGE { ERROR(STRING("Could not find an RSDP!\n")); }
+    }
+
+    CAcpiMADT *MADT =
+        (CAcpiMADT *)descriptionTableFind(rsdp, (U8 *)MADT_SIGNATURE);
+    if (!MADT) {
+        EXIT_WITH_MESSAGE { ERROR(STRING("Could not find the MADT!\n")); }
+    }
+
+    U64 APICPhysical = MADT->localControllerAddress;
+    processors->count = 1;
+    processors->APICIDs[0] = BSPAPICID;
+
+    U8 *MADTEnd = (U8 *)MADT + MADT->header.length;
+    for (U8 *entry = (U8 *)MADT->madtEntriesStart; entry < MADTEnd;
+         entry += ((CAcpiMADTHeader *)entry)->length) {
+        U32 APICID;
+        U32 flags;
+        switch (((CAcpiMADTHeader *)entry)->type) {
+        case MADT_LAPIC: {
+            APICID = ((CAcpiMADTLAPIC *)entry)->LAPICID;
+            flags = ((CAcpiMADTLAPIC *)entry)->flags;
+            break;
+        }
+        case MADT_X2APIC: {
+            APICID = ((CAcpiMADTX2APIC *)entry)->X2APICID;
+            flags = ((CAcpiMADTX2APIC *)entry)->flags;
+            break;
+        }
+        case MADT_LAPIC_ADDRESS_OVERRIDE: {
+            APICPhysical = ((CAcpiMADTLAPICAddressOverride *)entry)->address;
+            continue;
+        }
+        default: {
+            continue;
+        }
+        }
+
+        if (!(flags &
+              (MADT_PROCESSOR_ENABLED | MADT_PROCESSOR_ONLINE_CAPABLE)) ||
+            APICID == BSPAPICID) {
+            continue;
+        }
+
+        if (APICID > APIC_ID_MAX) {
+            KFLUSH_AFTER {
+                INFO(STRING("Skipping processor that can not be addressed "
+                            "in xAPIC mode, APIC ID: "));
+                INFO(APICID, .flags = NEWLINE);
+            }
+            continue;
+        }
+
+        if (processors->count == PROCESSORS_MAX) {
+            KFLUSH_AFTER {
+                INFO(STRING("Found more processors than supported, using "));
+                INFO(PROCESSORS_MAX, .flags = NEWLINE);
+            }
+            break;
+        }
+
+        processors->APICIDs[processors->count] = APICID;
+        processors->count++;
+    }
+
+    KFLUSH_AFTER {
+        INFO(STRING("Processors found: "));
+        INFO(processors->count, .flags = NEWLINE);
+    }
+
+    return APICPhysical;
+}
+
+static constexpr auto TRAMPOLINE_ADDRESS_END = 1 * MiB;
+
+static U64 bootstrapProcessorWork(ProcessorParams *processors,
+                                  U64 APICPhysical, U16 cacheLineSizeBytes,
+                                  U64 memoryVirtualAddressAvailable) {
     // NOTE: Disabled the PIC so we can use local APIC and IOAPIC
     PICDisable();
 
-    // TODO: Find out number of processors!
-    prepareDescriptors(1, cacheLineSizeBytes, memoryVirtualAddressAvailable);
+    memoryVirtualAddressAvailable =
+        prepareDescriptors((U16)processors->count, cacheLineSizeBytes,
+                           memoryVirtualAddressAvailable);
+
+    // NOTE: Device memory, so uncachable.
+    processors->APICBase = (U8 *)memoryVirtualAddressAvailable;
+    memoryVirtualAddressAvailable = memoryMap(
+        memoryVirtualAddressAvailable, APICPhysical, UEFI_PAGE_SIZE,
+        pageFlagsReadWrite() | pageFlagsNoCacheEvict() | PATMapping.MAP_3);
+    KFLUSH_AFTER {
+        mappingMemoryAppend((U64)processors->APICBase, APICPhysical,
+                            UEFI_PAGE_SIZE);
+    }
+
+    // NOTE: The other processors start in real mode, so the start of their
+    // code must be below 1 MiB. All physical memory is identity mapped, so
+    // the page is also reachable once they enable paging.
+    processors->trampolinePhysical =
+        (U64)kernelPagesBelowAlloc(UEFI_PAGE_SIZE, TRAMPOLINE_ADDRESS_END);
+    KFLUSH_AFTER {
+        INFO(STRING("Processor trampoline: "));
+        INFO((void *)processors->trampolinePhysical, .flags = NEWLINE);
+    }
+
+    // NOTE: Fully backed, a page fault on these stacks would enter the
+    // memory managers while the bootstrap processor may be using them.
+    for (typeof(processors->count) i = 1; i < processors->count; i++) {
+        StackResult stackResult =
+            stackCreateAndMap(memoryVirtualAddressAvailable, KERNEL_STACK_SIZE,
+                              KERNEL_STACK_SIZE, true);
+        memoryVirtualAddressAvailable = stackResult.virtualMemoryFirstAvailable;
+        processors->stackTops[i] = stackResult.stackVirtualTop;
+    }
+
+    return memoryVirtualAddressAvailable;
 }
 
 void virtualMemoryRootPageInit() {
@@ -223,10 +349,13 @@ void virtualMemoryRootPageInit() {
     }
 }
 
-// NOTE: Should be enough until put into final kernel position.
-static constexpr auto INITIAL_VIRTUAL_MAPPING_SIZES = 128;
+// NOTE: Should be enough until put into final kernel position. Every
+// processor adds mappings for its stacks.
+static constexpr auto INITIAL_VIRTUAL_MAPPING_SIZES = 1024;
 
 void kernelMemoryManagementInit(U64 startingAddress, U64 endingAddress) {
+    memoryLocksInit();
+
     Exponent orderCount =
         buddyOrderCountOnLargestPageSize(BUDDY_VIRTUAL_PAGE_SIZE_MAX);
     U64 *backingBuffer =
@@ -263,8 +392,8 @@ void kernelMemoryManagementInit(U64 startingAddress, U64 endingAddress) {
         sizeof(*memoryMapperSizes.tree), alignof(*memoryMapperSizes.tree));
 }
 
-static constexpr auto XSAVE_ALIGNMENT = 64;
-void archParamsFill(void *archParams, U64 memoryVirtualAddressAvailable) {
+U64 archParamsFill(void *archParams, U64 memoryVirtualAddressAvailable,
+                   U64 stackTop) {
     X86ArchParams *x86ArchParams = (X86ArchParams *)archParams;
 
     U32 manufacturerString[3];
@@ -296,7 +425,9 @@ void archParamsFill(void *archParams, U64 memoryVirtualAddressAvailable) {
         INFO(cacheLineSizeBytes, .flags = NEWLINE);
     }
 
-    // U32 BSPID = processorInfoAndFeatureBits.ebx >> 24;
+    U32 BSPAPICID = processorInfoAndFeatureBits.ebx >> 24;
+    U64 APICPhysical = processorsFind(&x86ArchParams->processors, BSPAPICID);
+    x86ArchParams->processors.stackTops[0] = stackTop;
 
     if (!features.TSC) {
         EXIT_WITH_MESSAGE {
@@ -368,15 +499,41 @@ void archParamsFill(void *archParams, U64 memoryVirtualAddressAvailable) {
         EXIT_WITH_MESSAGE { ERROR(STRING("No Support for XSAVEC found!\n")); }
     }
     KFLUSH_AFTER { INFO(STRING("Support for XSAVEC found!\n")); }
-    U32 XSAVESize = CPUIDWithSubleaf(XSAVE_CPU_SUPPORT, 0).ebx;
-    U8 *XSAVEAddress = NEW(&globals.kernelPermanent, U8, .count = XSAVESize,
-                           .align = XSAVE_ALIGNMENT, .flags = ALLOCATOR_ZERO_MEMORY);
+
+    // NOTE: XSAVES uses the compacted format of XSAVEC and only writes the
+    // modified state like XSAVEOPT, so prefer it. The XSAVE size in the
+    // subleaf 1 is for the compacted format, subleaf 0 for the standard one.
+    U32 XSAVESize;
+    if (XSAVECPUSupport.eax & (1 << 3)) {
+        KFLUSH_AFTER { INFO(STRING("Using XSAVES\n")); }
+        // No supervisor state components are used.
+        wrmsr(IA32_XSS_LOCATION, 0);
+        x86ArchParams->XSAVEInstructionUsed = XSAVE_INSTRUCTION_XSAVES;
+        XSAVESize = CPUIDWithSubleaf(XSAVE_CPU_SUPPORT, 1).ebx;
+    } else if (XSAVECPUSupport.eax & (1 << 0)) {
+        KFLUSH_AFTER { INFO(STRING("Using XSAVEOPT\n")); }
+        x86ArchParams->XSAVEInstructionUsed = XSAVE_INSTRUCTION_XSAVEOPT;
+        XSAVESize = CPUIDWithSubleaf(XSAVE_CPU_SUPPORT, 0).ebx;
+    } else {
+        KFLUSH_AFTER { INFO(STRING("Using XSAVEC\n")); }
+        x86ArchParams->XSAVEInstructionUsed = XSAVE_INSTRUCTION_XSAVEC;
+        XSAVESize = CPUIDWithSubleaf(XSAVE_CPU_SUPPORT, 1).ebx;
+    }
+
+    U32 XSAVEAreaBytes = (U32)alignUp(XSAVESize, XSAVE_ALIGNMENT);
+    U32 XSAVEBytes =
+        XSAVEAreaBytes * XSAVE_NESTING_MAX * x86ArchParams->processors.count;
+    U8 *XSAVEAddress =
+        NEW(&globals.kernelPermanent, U8, .count = XSAVEBytes,
+            .align = XSAVE_ALIGNMENT, .flags = ALLOCATOR_ZERO_MEMORY);
     KFLUSH_AFTER {
         INFO(STRING("XSAVE space location: "));
-        memoryAppend((Memory){.start = (U64)XSAVEAddress, .bytes = XSAVESize});
+        memoryAppend(
+            (Memory){.start = (U64)XSAVEAddress, .bytes = XSAVEBytes});
         INFO(STRING("\n"));
     }
     x86ArchParams->XSAVELocation = XSAVEAddress;
+    x86ArchParams->XSAVEAreaBytes = XSAVEAreaBytes;
 
     CPUIDResult extendedProcessorInfoAndFeatureBits =
         CPUID(EXTENDED_PROCESSOR_INFO_AND_FEATURE_BITS_PARAMETER);
@@ -387,21 +544,25 @@ void archParamsFill(void *archParams, U64 memoryVirtualAddressAvailable) {
     }
 
     KFLUSH_AFTER { INFO(STRING("Bootstrap processor work...\n")); }
-    bootstrapProcessorWork(cacheLineSizeBytes, memoryVirtualAddressAvailable);
+    memoryVirtualAddressAvailable = bootstrapProcessorWork(
+        &x86ArchParams->processors, APICPhysical, cacheLineSizeBytes,
+        memoryVirtualAddressAvailable);
 
-    U32 processorPowerManagement =
-        CPUID(EXTENDED_PROCESSOR_POWER_MANEGEMENT_OPERATION).edx;
-    if (!(processorPowerManagement & (1 << 8))) {
+    if (!tscInvariant()) {
         EXIT_WITH_MESSAGE {
             ERROR(STRING("CPU does not support invariant TSC!\n"));
         }
     }
 
-    x86ArchParams->tscFrequencyPerMicroSecond =
-        timestampFrequencyGet() / MICROSECONDS_PER_SECOND;
+    U64 tscFrequencyHertz = timestampFrequencyGet();
+    if (!tscFrequencyHertz) {
+        tscFrequencyHertz = timestampFrequencyCalibrate();
+    }
+    tscFrequencySet(tscFrequencyHertz);
+    x86ArchParams->tscFrequencyHertz = tscFrequencyHertz;
     KFLUSH_AFTER {
-        INFO(STRING("tsc frequency per microsecond: "));
-        INFO(x86ArchParams->tscFrequencyPerMicroSecond, .flags = NEWLINE);
+        INFO(STRING("tsc frequency in hertz: "));
+        INFO(tscFrequencyHertz, .flags = NEWLINE);
     }
 
     x86ArchParams->pageMetaDataRoot.children =
@@ -411,4 +572,6 @@ void archParamsFill(void *archParams, U64 memoryVirtualAddressAvailable) {
     x86ArchParams->pageMetaDataRoot.metaData
         .entriesMappedWithSmallerGranularity =
         pageMetaDataRoot.metaData.entriesMappedWithSmallerGranularity;
+
+    return memoryVirtualAddressAvailable;
 }
@@ -20,21 +20,32 @@ typedef struct {
 } Leaf0x16;
 
 U64 timestampFrequencyGet() {
-    Leaf0x15 leaf0x15;
-    {
-        CPUIDResult leaf = CPUID(TSC_AND_CORE_CRYSTAL_FREQ);
-        leaf0x15 = (Leaf0x15){.tscFreqToCrystalClockDenominator = leaf.eax,
-                              .tscFreqToCrystalClockNumerator = leaf.ebx,
-                              .crystalClockFreqHertz = leaf.ecx};
+    U32 maxLeaf = CPUID(BASIC_MAX_VALUE_AND_MANUFACTURER).eax;
+
+    if (maxLeaf >= TSC_AND_CORE_CRYSTAL_FREQ) {
+        Leaf0x15 leaf0x15;
+        {
+            CPUIDResult leaf = CPUID(TSC_AND_CORE_CRYSTAL_FREQ);
+            leaf0x15 = (Leaf0x15){.tscFreqToCrystalClockDenominator = leaf.eax,
+                                  .tscFreqToCrystalClockNumerator = leaf.ebx,
+                                  .crystalClockFreqHertz = leaf.ecx};
+        }
+        // Not completely supported, sadly. Many processors leave out the
+        // crystal frequency.
+        if (leaf0x15.tscFreqToCrystalClockDenominator &&
+            leaf0x15.tscFreqToCrystalClockNumerator &&
+            leaf0x15.crystalClockFreqHertz) {
+            U64 result = ((U64)leaf0x15.crystalClockFreqHertz *
+                          leaf0x15.tscFreqToCrystalClockNumerator) /
+                         leaf0x15.tscFreqToCrystalClockDenominator;
+            if (result > HERTZ_MINIMUM_SPEED) {
+                return result;
+            }
+        }
     }
-    // Not completely supported, sadly
-    if (leaf0x15.tscFreqToCrystalClockNumerator &&
-        leaf0x15.crystalClockFreqHertz > HERTZ_MINIMUM_SPEED) {
-        return (leaf0x15.crystalClockFreqHertz *
-                (leaf0x15.tscFreqToCrystalClockNumerator /
-                 leaf0x15.tscFreqToCrystalClockDenominator));
-    } else {
-        // Calculate it through other leaf if possible
+
+    // Calculate it through other leaf if possible
+    if (maxLeaf >= PROCESSOR_AND_BUS_FREQ) {
         Leaf0x16 leaf0x16;
         {
             CPUIDResult leaf = CPUID(PROCESSOR_AND_BUS_FREQ);
@@ -43,8 +54,10 @@ U64 timestampFrequencyGet() {
                                   .busFreqMHertz = leaf.ecx};
         }
         if (leaf0x16.processorBaseFreqMHertz > MEGAHERTZ_MINIMUM_SPEED) {
-            // no-op, but for copletion's sake.
-            return (leaf0x16.processorBaseFreqMHertz * HERTZ_PER_MEGAHERTZ);
+            return ((U64)leaf0x16.processorBaseFreqMHertz *
+                    HERTZ_PER_MEGAHERTZ);
         }
     }
+
+    return 0;
 }
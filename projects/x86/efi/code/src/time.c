@@ -0,0 +1,145 @@
+#include "x86/efi/time.h"
+
+#include "abstraction/log.h"
+#include "abstraction/time.h"
+#include "efi/acpi/fadt.h"
+#include "efi/acpi/hpet.h"
+#include "efi/acpi/rdsp.h"
+#include "efi/acpi/rsdt.h"
+#include "efi/globals.h"
+#include "shared/log.h"
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+#include "x86/configuration/cpu.h"
+
+static constexpr auto CALIBRATION_MICROSECONDS = 10000;
+static constexpr auto CALIBRATION_RUNS = 3;
+
+static constexpr U16 PIT_CHANNEL_2_PORT = 0x42;
+static constexpr U16 PIT_COMMAND_PORT = 0x43;
+static constexpr U16 PIT_GATE_PORT = 0x61;
+static constexpr U64 PIT_FREQUENCY_HERTZ = 1193182;
+// Channel 2, low byte then high byte, mode 0 (interrupt on terminal count)
+static constexpr U8 PIT_CHANNEL_2_ONE_SHOT = 0b10110000;
+static constexpr U8 PIT_GATE_CHANNEL_2 = (1 << 0);
+static constexpr U8 PIT_GATE_SPEAKER = (1 << 1);
+static constexpr U8 PIT_GATE_CHANNEL_2_OUTPUT = (1 << 5);
+
+static constexpr U64 HPET_CAPABILITIES_64_BITS = (1 << 13);
+
+// A free-running counter with a known frequency that wraps at its mask.
+typedef struct {
+    U64 (*ticksGet)();
+    U64 mask;
+    U64 frequencyHertz;
+} ReferenceTimer;
+
+static U16 PMTimerPort;
+static U64 PMTimerTicksGet() { return inl(PMTimerPort); }
+
+static volatile U64 *HPETMainCounter;
+static U64 HPETTicksGet() { return *HPETMainCounter; }
+
+// NOTE: Interruptions by the firmware can land in a run, so the median of the
+// runs is used.
+static U64 median(U64 runs[CALIBRATION_RUNS]) {
+    for (U32 i = 1; i < CALIBRATION_RUNS; i++) {
+        for (U32 j = i; j > 0 && runs[j - 1] > runs[j]; j--) {
+            U64 swap = runs[j];
+            runs[j] = runs[j - 1];
+            runs[j - 1] = swap;
+        }
+    }
+    return runs[CALIBRATION_RUNS / 2];
+}
+
+static U64 referenceTimerCalibrate(ReferenceTimer *timer) {
+    U64 calibrationTicks = (timer->frequencyHertz * CALIBRATION_MICROSECONDS) /
+                           MICROSECONDS_PER_SECOND;
+
+    U64 runs[CALIBRATION_RUNS];
+    for (U32 i = 0; i < CALIBRATION_RUNS; i++) {
+        U64 startTicks = timer->ticksGet();
+        U64 startCycles = cycleCounterGet(false, false);
+        U64 elapsedTicks;
+        do {
+            elapsedTicks = (timer->ticksGet() - startTicks) & timer->mask;
+        } while (elapsedTicks < calibrationTicks);
+        U64 cycles = cycleCounterGet(false, false) - startCycles;
+
+        runs[i] = (cycles * timer->frequencyHertz) / elapsedTicks;
+    }
+
+    return median(runs);
+}
+
+static U64 PITCalibrate() {
+    U16 calibrationTicks =
+        (U16)((PIT_FREQUENCY_HERTZ * CALIBRATION_MICROSECONDS) /
+              MICROSECONDS_PER_SECOND);
+
+    U64 runs[CALIBRATION_RUNS];
+    for (U32 i = 0; i < CALIBRATION_RUNS; i++) {
+        outb(PIT_GATE_PORT,
+             (inb(PIT_GATE_PORT) & ~PIT_GATE_SPEAKER) | PIT_GATE_CHANNEL_2);
+        outb(PIT_COMMAND_PORT, PIT_CHANNEL_2_ONE_SHOT);
+        outb(PIT_CHANNEL_2_PORT, (U8)calibrationTicks);
+        outb(PIT_CHANNEL_2_PORT, (U8)(calibrationTicks >> 8));
+
+        U64 startCycles = cycleCounterGet(false, false);
+        while (!(inb(PIT_GATE_PORT) & PIT_GATE_CHANNEL_2_OUTPUT)) {
+        }
+        U64 cycles = cycleCounterGet(false, false) - startCycles;
+
+        runs[i] = (cycles * PIT_FREQUENCY_HERTZ) / calibrationTicks;
+    }
+
+    return median(runs);
+}
+
+U64 timestampFrequencyCalibrate() {
+    RSDPResult rsdp = RSDPGet(globals.st->number_of_table_entries,
+                              globals.st->configuration_table);
+    if (rsdp.rsdp) {
+        CAcpiFADT *FADT =
+            (CAcpiFADT *)descriptionTableFind(rsdp, (U8 *)FADT_SIGNATURE);
+        if (FADT && FADT->PMTimerBlock) {
+            KFLUSH_AFTER {
+                INFO(STRING("Calibrating the TSC against the PM timer\n"));
+            }
+            PMTimerPort = (U16)FADT->PMTimerBlock;
+            ReferenceTimer timer = {
+                .ticksGet = PMTimerTicksGet,
+                .mask = FADT->flags & FADT_PM_TIMER_32_BITS ? U32_MAX
+                                                            : 0xFFFFFF,
+                .frequencyHertz = PM_TIMER_FREQUENCY_HERTZ};
+            return referenceTimerCalibrate(&timer);
+        }
+
+        CAcpiHPET *HPET =
+            (CAcpiHPET *)descriptionTableFind(rsdp, (U8 *)HPET_SIGNATURE);
+        if (HPET && HPET->base.addressSpace == ACPI_ADDRESS_SPACE_MEMORY) {
+            KFLUSH_AFTER {
+                INFO(STRING("Calibrating the TSC against the HPET\n"));
+            }
+            U8 *registers = (U8 *)HPET->base.address;
+            U64 capabilities =
+                *(volatile U64 *)(registers + HPET_CAPABILITIES_REGISTER);
+            *(volatile U64 *)(registers + HPET_CONFIGURATION_REGISTER) |=
+                HPET_CONFIGURATION_ENABLE;
+            HPETMainCounter =
+                (volatile U64 *)(registers + HPET_MAIN_COUNTER_REGISTER);
+
+            ReferenceTimer timer = {
+                .ticksGet = HPETTicksGet,
+                .mask = capabilities & HPET_CAPABILITIES_64_BITS ? U64_MAX
+                                                                 : U32_MAX,
+                .frequencyHertz = FEMTOSECONDS_PER_SECOND /
+                                  (capabilities >> HPET_PERIOD_SHIFT)};
+            return referenceTimerCalibrate(&timer);
+        }
+    }
+
+    KFLUSH_AFTER { INFO(STRING("Calibrating the TSC against the PIT\n")); }
+    return PITCalibrate();
+}
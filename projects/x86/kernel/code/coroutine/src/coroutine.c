@@ -0,0 +1,111 @@
+#include "abstraction/coroutine.h"
+
+#include "shared/maths.h"
+#include "shared/memory/management/definitions.h"
+#include "shared/memory/policy.h"
+#include "shared/memory/sizes.h"
+#include "shared/types/numeric.h"
+
+static constexpr auto COROUTINE_STACK_BYTES = 64 * KiB;
+
+// NOTE: Lives at the top of its own stack.
+struct Coroutine {
+    U64 stackPointer;        // Of the coroutine while it is suspended
+    U64 resumerStackPointer; // Of the resumer while the coroutine runs
+    CoroutineFunction function;
+    void *argument;
+    CoroutineCompletion awaitCompleted;
+    void *awaitArgument;
+    Memory stack;
+    bool finished;
+};
+
+extern void coroutineSwitch(U64 *stackPointerSave, U64 stackPointerLoad);
+extern void coroutineStart();
+
+__attribute__((noreturn)) void coroutineRun(Coroutine *coroutine) {
+    coroutine->function(coroutine, coroutine->argument);
+    coroutine->finished = true;
+    coroutineSwitch(&coroutine->stackPointer, coroutine->resumerStackPointer);
+    __builtin_unreachable();
+}
+
+// NOTE: Keep in sync with coroutineSwitch in switch.S
+Coroutine *coroutineCreate(CoroutineFunction function, void *argument) {
+    // NOTE: Backed fully for the same reason as thread stacks.
+    Memory stack =
+        mappableStackAlloc(COROUTINE_STACK_BYTES, COROUTINE_STACK_BYTES);
+    U64 stackTop = stack.start + stack.bytes;
+
+    Coroutine *coroutine =
+        (Coroutine *)(stackTop - alignUp(sizeof(Coroutine), 16));
+    *coroutine = (Coroutine){.function = function,
+                             .argument = argument,
+                             .awaitCompleted = nullptr,
+                             .awaitArgument = nullptr,
+                             .stack = stack,
+                             .finished = false};
+
+    // NOTE: coroutineStart is returned to, so the stack is 16-byte aligned
+    // once its address is popped.
+    U64 *stackPointer = (U64 *)coroutine;
+    *(--stackPointer) = (U64)coroutineStart;
+    *(--stackPointer) = 0;              // rbp
+    *(--stackPointer) = 0;              // rbx
+    *(--stackPointer) = (U64)coroutine; // r12
+    *(--stackPointer) = 0;              // r13
+    *(--stackPointer) = 0;              // r14
+    *(--stackPointer) = 0;              // r15
+    coroutine->stackPointer = (U64)stackPointer;
+
+    return coroutine;
+}
+
+void coroutineDestroy(Coroutine *coroutine) {
+    // NOTE: The coroutine is on the stack that is freed.
+    Memory stack = coroutine->stack;
+    mappableStackFree(stack);
+}
+
+bool coroutineResume(Coroutine *coroutine) {
+    if (coroutine->finished) {
+        return false;
+    }
+
+    if (coroutine->awaitCompleted) {
+        if (!coroutine->awaitCompleted(coroutine->awaitArgument)) {
+            return true;
+        }
+        coroutine->awaitCompleted = nullptr;
+    }
+
+    coroutineSwitch(&coroutine->resumerStackPointer, coroutine->stackPointer);
+    return !coroutine->finished;
+}
+
+void coroutineYield(Coroutine *self) {
+    coroutineSwitch(&self->stackPointer, self->resumerStackPointer);
+}
+
+void coroutineAwait(Coroutine *self, CoroutineCompletion completed,
+                    void *argument) {
+    if (completed(argument)) {
+        return;
+    }
+
+    self->awaitCompleted = completed;
+    self->awaitArgument = argument;
+    coroutineYield(self);
+}
+
+void coroutinesRun(Coroutine **coroutines, U32 count) {
+    U32 running = count;
+    while (running) {
+        running = 0;
+        for (typeof(count) i = 0; i < count; i++) {
+            if (coroutineResume(coroutines[i])) {
+                running++;
+            }
+        }
+    }
+}
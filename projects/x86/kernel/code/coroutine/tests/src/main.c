@@ -0,0 +1,225 @@
+#include "abstraction/coroutine.h"
+#include "abstraction/jmp.h"
+#include "abstraction/log.h"
+#include "posix/log.h"
+#include "posix/memory/virtual.h"
+#include "posix/test-framework/test.h"
+#include "shared/log.h"
+#include "shared/macros.h"
+#include "shared/memory/sizes.h"
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+
+static constexpr auto PHYSICAL_MEMORY = 1 * GiB;
+static constexpr auto VIRTUAL_MEMORY = 64 * GiB;
+
+static constexpr auto YIELDS = 3;
+static constexpr auto STEPS_MAX = 16;
+
+static void resumeEqual(bool expected, bool actual) {
+    if (expected != actual) {
+        TEST_FAILURE {
+            INFO(STRING("Resume returned the wrong result\n"));
+            INFO(STRING("Expected: "));
+            INFO(expected, .flags = NEWLINE);
+            INFO(STRING("Actual: "));
+            INFO(actual, .flags = NEWLINE);
+        }
+    }
+}
+
+static void counterIncrement(Coroutine *self, void *argument) {
+    (void)self;
+    U64 *counter = argument;
+    (*counter)++;
+}
+
+static void testSwitch() {
+    U64 counter = 0;
+    Coroutine *coroutine = coroutineCreate(counterIncrement, &counter);
+    testCountEqual(STRING("increments before the first resume"), 0, counter);
+
+    resumeEqual(false, coroutineResume(coroutine));
+    testCountEqual(STRING("increments"), 1, counter);
+
+    // NOTE: A finished coroutine is not switched to again.
+    resumeEqual(false, coroutineResume(coroutine));
+    testCountEqual(STRING("increments after finishing"), 1, counter);
+
+    coroutineDestroy(coroutine);
+
+    testSuccess();
+}
+
+static void counterYieldingIncrement(Coroutine *self, void *argument) {
+    U64 *counter = argument;
+    for (U32 i = 0; i < YIELDS; i++) {
+        (*counter)++;
+        coroutineYield(self);
+    }
+}
+
+static void testYield() {
+    U64 counter = 0;
+    Coroutine *coroutine = coroutineCreate(counterYieldingIncrement, &counter);
+
+    for (U32 i = 0; i < YIELDS; i++) {
+        resumeEqual(true, coroutineResume(coroutine));
+        testCountEqual(STRING("increments"), i + 1, counter);
+    }
+    resumeEqual(false, coroutineResume(coroutine));
+    testCountEqual(STRING("increments after finishing"), YIELDS, counter);
+
+    coroutineDestroy(coroutine);
+
+    testSuccess();
+}
+
+typedef struct {
+    bool completed;
+    U32 polls;
+    U32 steps;
+} Device;
+
+static bool deviceCompleted(void *argument) {
+    Device *device = argument;
+    device->polls++;
+    return device->completed;
+}
+
+static void deviceAwaiting(Coroutine *self, void *argument) {
+    Device *device = argument;
+    device->steps++;
+    coroutineAwait(self, deviceCompleted, device);
+    device->steps++;
+}
+
+static void testAwait() {
+    Device device = {.completed = false, .polls = 0, .steps = 0};
+    Coroutine *coroutine = coroutineCreate(deviceAwaiting, &device);
+
+    resumeEqual(true, coroutineResume(coroutine));
+    testCountEqual(STRING("steps before completion"), 1, device.steps);
+    testCountEqual(STRING("polls by the coroutine"), 1, device.polls);
+
+    // NOTE: The resumer polls, the coroutine is not switched to until the
+    // device completed.
+    resumeEqual(true, coroutineResume(coroutine));
+    resumeEqual(true, coroutineResume(coroutine));
+    testCountEqual(STRING("steps while waiting"), 1, device.steps);
+    testCountEqual(STRING("polls by the resumer"), 3, device.polls);
+
+    device.completed = true;
+    resumeEqual(false, coroutineResume(coroutine));
+    testCountEqual(STRING("steps after completion"), 2, device.steps);
+    testCountEqual(STRING("polls after completion"), 4, device.polls);
+
+    coroutineDestroy(coroutine);
+
+    testSuccess();
+}
+
+static void testAwaitCompleted() {
+    Device device = {.completed = true, .polls = 0, .steps = 0};
+    Coroutine *coroutine = coroutineCreate(deviceAwaiting, &device);
+
+    // NOTE: Awaiting a device that is already done does not switch at all.
+    resumeEqual(false, coroutineResume(coroutine));
+    testCountEqual(STRING("steps"), 2, device.steps);
+    testCountEqual(STRING("polls"), 1, device.polls);
+
+    coroutineDestroy(coroutine);
+
+    testSuccess();
+}
+
+typedef struct {
+    U8 buf[STEPS_MAX];
+    U32 len;
+} Steps;
+
+typedef struct {
+    Steps *steps;
+    U8 name;
+} Stepper;
+
+static void stepsRecord(Coroutine *self, void *argument) {
+    Stepper *stepper = argument;
+    for (U32 i = 0; i < YIELDS; i++) {
+        stepper->steps->buf[stepper->steps->len] = stepper->name;
+        stepper->steps->len++;
+        coroutineYield(self);
+    }
+}
+
+static void testRunInterleaved() {
+    Steps steps = {.len = 0};
+    Stepper first = {.steps = &steps, .name = 'a'};
+    Stepper second = {.steps = &steps, .name = 'b'};
+    Coroutine *coroutines[] = {coroutineCreate(stepsRecord, &first),
+                               coroutineCreate(stepsRecord, &second)};
+
+    coroutinesRun(coroutines, COUNTOF(coroutines));
+
+    String expected = STRING("ababab");
+    String actual = {.buf = steps.buf, .len = steps.len};
+    if (!stringEquals(expected, actual)) {
+        TEST_FAILURE {
+            INFO(STRING("Coroutines did not take turns\n"));
+            INFO(STRING("Expected: "));
+            INFO(expected, .flags = NEWLINE);
+            INFO(STRING("Actual: "));
+            INFO(actual, .flags = NEWLINE);
+        }
+    }
+
+    for (U32 i = 0; i < COUNTOF(coroutines); i++) {
+        coroutineDestroy(coroutines[i]);
+    }
+
+    testSuccess();
+}
+
+static void testCoroutines() {
+    TEST_TOPIC(STRING("Single coroutine")) {
+        JumpBuffer failureHandler;
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Switch"), failureHandler) { testSwitch(); }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Yield"), failureHandler) { testYield(); }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Await"), failureHandler) { testAwait(); }
+        }
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Await completed"), failureHandler) {
+                testAwaitCompleted();
+            }
+        }
+    }
+
+    TEST_TOPIC(STRING("Multiple coroutines")) {
+        JumpBuffer failureHandler;
+        if (!setjmp(failureHandler)) {
+            TEST(STRING("Run interleaved"), failureHandler) {
+                testRunInterleaved();
+            }
+        }
+    }
+}
+
+int main() {
+    if (!hostedMemoryInit(PHYSICAL_MEMORY, VIRTUAL_MEMORY)) {
+        PFLUSH_AFTER(STDERR) {
+            ERROR(STRING("Failed to set up hosted memory!\n"));
+        }
+        return -1;
+    }
+
+    testSuiteStart(STRING("Coroutines"));
+
+    testCoroutines();
+
+    return testSuiteFinish();
+}
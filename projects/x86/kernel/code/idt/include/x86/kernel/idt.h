@@ -1,9 +1,72 @@
 #ifndef X86_KERNEL_IDT_H
 #define X86_KERNEL_IDT_H
 
+#include "abstraction/interrupts.h"
+#include "shared/enum.h"
+#include "shared/types/numeric.h"
+#include "x86/configuration/features.h"
 #include "x86/fault.h"
 
-extern U8 *XSAVESpace;
+// NOTE: Areas are handed out per nesting level from the XSAVECurrent of the
+// current processor.
+extern U64 XSAVEAreaBytes;
+extern XSAVEInstruction XSAVEInstructionUsed;
+
+// NOTE: Keep in sync with isr.S
+// Only sent to wake a halted processor, the handler just acknowledges it.
+static constexpr U8 PROCESSOR_WAKE_VECTOR = 0xF0;
+static constexpr U8 APIC_SPURIOUS_VECTOR = 0xF1;
+static constexpr U8 APIC_TIMER_VECTOR = 0xF2;
+static constexpr U8 PAGE_CACHE_SHOOTDOWN_VECTOR = 0xF3;
+
+// NOTE: Keep in sync with isr.S
+// Every interrupt that returns is timed from its stub, in cycles. Bucket i
+// counts the ones that took [2^i, 2^(i + 1)) cycles, the last bucket also
+// everything slower.
+static constexpr auto INTERRUPT_LATENCY_BUCKETS = 24;
+static constexpr auto INTERRUPT_VECTORS = 256;
+
+// Page faults are timed per outcome instead of under their vector. A stack
+// overflow is timed up to the point it is detected.
+#define PAGE_FAULT_LATENCY_ENUM(VARIANT)                                       \
+    VARIANT(PAGE_FAULT_LATENCY_MAPPED_4K)                                      \
+    VARIANT(PAGE_FAULT_LATENCY_MAPPED_2M)                                      \
+    VARIANT(PAGE_FAULT_LATENCY_MAPPED_1G)                                      \
+    VARIANT(PAGE_FAULT_LATENCY_STACK_OVERFLOW)
+
+typedef enum : U8 {
+    PAGE_FAULT_LATENCY_ENUM(ENUM_STANDARD_VARIANT)
+} PageFaultLatency;
+static constexpr auto PAGE_FAULT_LATENCY_COUNT =
+    PAGE_FAULT_LATENCY_ENUM(PLUS_ONE);
+
+// NOTE: The stubs see this as a single array of histograms, the page fault
+// ones come right after the vectors.
+typedef struct InterruptLatencies {
+    U64 vectors[INTERRUPT_VECTORS][INTERRUPT_LATENCY_BUCKETS];
+    U64 pageFaults[PAGE_FAULT_LATENCY_COUNT][INTERRUPT_LATENCY_BUCKETS];
+} InterruptLatencies;
+
+// NOTE: For vectors that do not signal a fault. Called from faultHandler with
+// interrupts disabled, the handler has to send the EOI itself. The timer and
+// shootdown vectors do not save the vector state, so their handlers and all
+// they call must be built with -mgeneral-regs-only, see isr.S.
+typedef void (*InterruptHandler)(Registers *regs);
+void interruptHandlerSet(U8 vector, InterruptHandler handler);
+
+// Where the interrupted code was, for handlers that sample it.
+[[nodiscard]] U64 registersInstructionPointer(Registers *regs);
+[[nodiscard]] U64 registersFramePointer(Registers *regs);
+[[nodiscard]] U64 registersStackPointer(Registers *regs);
+
+__attribute__((noreturn)) void faultHandlerNoReturn(Registers *regs);
+// NOTE: Only checked in DEBUG builds, see isr.S.
+__attribute__((noreturn)) void vectorStateNestingExceeded();
+
+// For handlers that are entered without saving the vector state, see isr.S.
+// Every save has to be followed by a restore on the same thread.
+void vectorStateSave();
+void vectorStateRestore();
 
 __attribute__((noreturn)) void faultTrigger(Fault fault);
 
@@ -7,6 +7,7 @@
 #include "abstraction/thread.h"
 #include "shared/enum.h"
 #include "shared/log.h"
+#include "shared/macros.h"
 #include "shared/maths.h"
 #include "shared/memory/converter.h"
 #include "shared/memory/management/management.h"
@@ -14,11 +15,19 @@
 #include "shared/types/numeric.h"
 #include "x86/configuration/cpu.h"
 #include "x86/fault.h"
+#include "x86/kernel/idt.h"
 #include "x86/memory/definitions.h"
 
 static String faultToString[CPU_FAULT_COUNT] = {CPU_FAULT_ENUM(STRING_CONVERTER_ENUM)};
 
-U8 *XSAVESpace;
+U64 XSAVEAreaBytes;
+XSAVEInstruction XSAVEInstructionUsed;
+
+static InterruptHandler interruptHandlers[256];
+
+void interruptHandlerSet(U8 vector, InterruptHandler handler) {
+    interruptHandlers[vector] = handler;
+}
 
 struct Registers {
     U64 r15;
@@ -51,9 +60,11 @@ struct Registers {
     U64 ss;
 };
 
-U64 pageFaultsCurrent = 0;
+U64 registersInstructionPointer(Registers *regs) { return regs->rip; }
+U64 registersFramePointer(Registers *regs) { return regs->rbp; }
+U64 registersStackPointer(Registers *regs) { return regs->rsp; }
 
-static void kernelPanic(Registers *regs) {
+__attribute__((noreturn)) static void kernelPanic(Registers *regs) {
     KFLUSH_AFTER {
         INFO(STRING("We are in an interrupt!!!\n"));
         INFO(STRING("regs:\n"));
@@ -107,21 +118,45 @@ static void kernelPanic(Registers *regs) {
     __builtin_unreachable();
 }
 
+// NOTE: The page fault stub in isr.S relies on these values.
+static_assert(GUARD_PAGE_SIZE == 0);
+static_assert(INTERRUPT_LATENCY_BUCKETS == 24);
+static_assert(INTERRUPT_VECTORS == 256);
+static_assert(PAGE_FAULT_LATENCY_MAPPED_4K == 0);
+static_assert(PAGE_FAULT_LATENCY_MAPPED_2M == 1);
+static_assert(PAGE_FAULT_LATENCY_MAPPED_1G == 2);
+static_assert(PAGE_FAULT_LATENCY_STACK_OVERFLOW == 3);
+static_assert(OFFSETOF(InterruptLatencies, pageFaults) ==
+              sizeof(((InterruptLatencies *)nullptr)->vectors));
+
 void faultHandler(Registers *regs) {
-    if (regs->interruptNumber == FAULT_PAGE_FAULT) {
-        pageFaultsCurrent++;
-        PageFaultResult pageFaultResult = pageFaultHandle(CR2());
+    if (interruptHandlers[regs->interruptNumber]) {
+        interruptHandlers[regs->interruptNumber](regs);
+        return;
+    }
 
-        switch (pageFaultResult) {
-        case PAGE_FAULT_RESULT_MAPPED: {
-            return;
-        }
-        case PAGE_FAULT_RESULT_STACK_OVERFLOW: {
-            KFLUSH_AFTER { INFO(STRING("Stack overflow detected!\n")); }
-            kernelPanic(regs);
-        }
+    // NOTE: Page faults are handled in isr.S and only end up here if they
+    // could not be resolved.
+    if (regs->interruptNumber == FAULT_PAGE_FAULT) {
+        KFLUSH_AFTER {
+            INFO(STRING("Stack overflow detected! Faulting address: "));
+            INFO((void *)CR2(), .flags = NEWLINE);
         }
-    } else {
-        kernelPanic(regs);
     }
+
+    kernelPanic(regs);
+}
+
+// NOTE: Called without saving the vector state of the interrupted code, so
+// this must never return to it.
+void faultHandlerNoReturn(Registers *regs) { kernelPanic(regs); }
+
+void vectorStateNestingExceeded() {
+    KFLUSH_AFTER {
+        ERROR(STRING("Interrupts nested deeper than XSAVE_NESTING_MAX\n"));
+    }
+
+    threadHang();
+
+    __builtin_unreachable();
 }
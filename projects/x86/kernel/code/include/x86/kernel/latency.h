@@ -0,0 +1,8 @@
+#ifndef X86_KERNEL_LATENCY_H
+#define X86_KERNEL_LATENCY_H
+
+// Gives every processor its latency histograms, interrupts are only timed from
+// here on.
+void interruptLatenciesInit();
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef X86_KERNEL_PERCPU_H
+#define X86_KERNEL_PERCPU_H
+
+#include "abstraction/kernel.h"
+#include "shared/macros.h"
+#include "shared/types/numeric.h"
+
+// NOTE: Every processor has its GS base set to its own area, so a field of the
+// current processor is a single gs-relative access. Aligned to a cache line so
+// processors do not falsely share their areas.
+typedef struct __attribute__((aligned(64))) PerCPU {
+    struct PerCPU *self;
+    U64 pageFaults;
+    U8 *XSAVECurrent; // The next free XSAVE area of this processor
+    // Interrupts are only timed once this is set, see isr.S
+    struct InterruptLatencies *interruptLatencies;
+    U8 *XSAVEEnd; // Past the XSAVE areas of the running thread, see isr.S
+    U32 id;
+    U32 APICID;
+    U64 stackTop;
+    U8 *XSAVELocation;  // XSAVE_NESTING_MAX areas of XSAVEAreaBytes each
+    ProcessorWork work; // Cleared by the processor once the work is done
+    void *argument;
+    U64 pageCacheShootdownsSent; // Interrupts sent to other processors
+    U64 pageCacheEntriesFlushed; // On request of other processors
+    U64 pageCacheFullFlushes;    // On request of other processors
+} PerCPU;
+
+// NOTE: Used in isr.S, keep them in sync!
+static constexpr auto PERCPU_PAGE_FAULTS_OFFSET = 8;
+static constexpr auto PERCPU_XSAVE_CURRENT_OFFSET = 16;
+static constexpr auto PERCPU_INTERRUPT_LATENCIES_OFFSET = 24;
+static constexpr auto PERCPU_XSAVE_END_OFFSET = 32;
+static_assert(OFFSETOF(PerCPU, pageFaults) == PERCPU_PAGE_FAULTS_OFFSET);
+static_assert(OFFSETOF(PerCPU, XSAVECurrent) ==
+              PERCPU_XSAVE_CURRENT_OFFSET);
+static_assert(OFFSETOF(PerCPU, interruptLatencies) ==
+              PERCPU_INTERRUPT_LATENCIES_OFFSET);
+static_assert(OFFSETOF(PerCPU, XSAVEEnd) == PERCPU_XSAVE_END_OFFSET);
+
+#define PERCPU_GET(field)                                                      \
+    ({                                                                         \
+        typeof(((PerCPU *)nullptr)->field) MACRO_VAR(value);                   \
+        asm volatile("mov %%gs:%c1, %0"                                        \
+                     : "=r"(MACRO_VAR(value))                                  \
+                     : "i"(OFFSETOF(PerCPU, field)));                          \
+        MACRO_VAR(value);                                                      \
+    })
+
+#define PERCPU_SET(field, value)                                               \
+    asm volatile("mov %0, %%gs:%c1"                                            \
+                 :                                                             \
+                 : "r"((typeof(((PerCPU *)nullptr)->field))(value)),           \
+                   "i"(OFFSETOF(PerCPU, field))                                \
+                 : "memory")
+
+// NOTE: A single instruction, so it can not be torn by an interrupt.
+#define PERCPU_ADD(field, value)                                               \
+    asm volatile("add %0, %%gs:%c1"                                            \
+                 :                                                             \
+                 : "r"((typeof(((PerCPU *)nullptr)->field))(value)),           \
+                   "i"(OFFSETOF(PerCPU, field))                                \
+                 : "memory")
+
+// For fields that are not accessed as a whole.
+#define PERCPU_ADDRESS() PERCPU_GET(self)
+
+#endif
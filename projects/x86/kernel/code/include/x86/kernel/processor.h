@@ -0,0 +1,16 @@
+#ifndef X86_KERNEL_PROCESSOR_H
+#define X86_KERNEL_PROCESSOR_H
+
+#include "shared/types/numeric.h"
+#include "x86/efi-to-kernel/params.h"
+#include "x86/kernel/percpu.h"
+
+// NOTE: Indexed by processor ID, the bootstrap processor has ID 0.
+extern PerCPU processors[PROCESSORS_MAX];
+extern U32 processorsCount;
+
+// Also makes the area of the bootstrap processor the current one.
+void processorsInit(ProcessorParams *processorParams, U8 *XSAVELocation,
+                    U64 XSAVEAreaBytes);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef X86_KERNEL_SHOOTDOWN_H
+#define X86_KERNEL_SHOOTDOWN_H
+
+// Page cache entries that are flushed on one processor can still be cached by
+// the others that run on the same page tables. Flushes are therefore queued
+// per processor and announced with a single interrupt per batch.
+
+// Makes the current processor a target of flushes from now on.
+void pageCacheShootdownJoin();
+
+// Starts sending flushes to the processors that joined.
+void pageCacheShootdownInit();
+
+// Flushes what was queued for the current processor. Done in the interrupt
+// handler, but also by processors that spin with interrupts disabled.
+void pageCacheShootdownReceive();
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef X86_KERNEL_THREAD_H
+#define X86_KERNEL_THREAD_H
+
+#include "shared/memory/management/definitions.h"
+
+// Switches to the next thread if the time slice of the current one ended.
+// Called at the end of the timer interrupt, once all expired timers ran.
+void threadPreemptCheck();
+
+// The stack of the current thread. The first thread of a processor, and the
+// code that runs before threads are set up, use the kernel stack.
+[[nodiscard]] Memory threadStackGet();
+
+#endif
@@ -4,6 +4,7 @@
 #include "x86/configuration/cpu.h"
 #include "x86/efi-to-kernel/params.h"
 #include "x86/kernel/idt.h"
+#include "x86/kernel/processor.h"
 #include "x86/memory/definitions.h"
 #include "x86/memory/virtual.h"
 #include "x86/serial.h"
@@ -11,10 +12,15 @@
 
 void archInit(void *archParams) {
     X86ArchParams *x86ArchParams = (X86ArchParams *)archParams;
-    XSAVESpace = x86ArchParams->XSAVELocation;
+    // NOTE: The interrupt handlers use the area of the current processor.
+    processorsInit(&x86ArchParams->processors, x86ArchParams->XSAVELocation,
+                   x86ArchParams->XSAVEAreaBytes);
+
+    XSAVEAreaBytes = x86ArchParams->XSAVEAreaBytes;
+    XSAVEInstructionUsed = x86ArchParams->XSAVEInstructionUsed;
     interruptsInit();
 
-    tscCyclesPerMicroSecond = x86ArchParams->tscFrequencyPerMicroSecond;
+    tscFrequencySet(x86ArchParams->tscFrequencyHertz);
 
     pageTableRoot = (VirtualPageTable *)CR3();
 
@@ -0,0 +1,107 @@
+#include "x86/kernel/latency.h"
+
+#include "abstraction/kernel.h"
+#include "abstraction/log.h"
+#include "abstraction/text/converter/converter.h"
+#include "abstraction/time.h"
+#include "shared/enum.h"
+#include "shared/log.h"
+#include "shared/maths.h"
+#include "shared/memory/policy.h"
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+#include "x86/kernel/idt.h"
+#include "x86/kernel/percpu.h"
+#include "x86/kernel/processor.h"
+
+static String pageFaultLatencyToString[PAGE_FAULT_LATENCY_COUNT] = {
+    PAGE_FAULT_LATENCY_ENUM(STRING_CONVERTER_ENUM)};
+
+void interruptLatenciesInit() {
+    for (typeof(processorsCount) i = 0; i < processorsCount; i++) {
+        InterruptLatencies *latencies =
+            identityMemoryAlloc(ceilingPowerOf2(sizeof(InterruptLatencies)));
+        *latencies = (InterruptLatencies){0};
+        __atomic_store_n(&processors[i].interruptLatencies, latencies,
+                         __ATOMIC_RELEASE);
+    }
+}
+
+typedef struct {
+    U64 count;
+    U64 buckets[INTERRUPT_LATENCY_BUCKETS];
+} LatencyHistogram;
+
+// Merges the histograms of all processors.
+static LatencyHistogram latencyHistogramGet(U64 histogram) {
+    LatencyHistogram result = {0};
+    for (typeof(processorsCount) i = 0; i < processorsCount; i++) {
+        InterruptLatencies *latencies = processors[i].interruptLatencies;
+        if (!latencies) {
+            continue;
+        }
+
+        U64 *buckets = &latencies->vectors[0][0] +
+                       (histogram * INTERRUPT_LATENCY_BUCKETS);
+        for (U32 j = 0; j < INTERRUPT_LATENCY_BUCKETS; j++) {
+            U64 count = __atomic_load_n(&buckets[j], __ATOMIC_RELAXED);
+            result.buckets[j] += count;
+            result.count += count;
+        }
+    }
+    return result;
+}
+
+// Returns the upper bound in cycles of the bucket the percentile falls in.
+static U64 latencyPercentile(LatencyHistogram *histogram, U64 percentile) {
+    U64 wanted = MAX((histogram->count * percentile + 99) / 100, 1);
+    U64 seen = 0;
+    for (U32 i = 0; i < INTERRUPT_LATENCY_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= wanted) {
+            return 1ULL << (i + 1);
+        }
+    }
+    return 1ULL << INTERRUPT_LATENCY_BUCKETS;
+}
+
+static void latencyHistogramAppend(LatencyHistogram *histogram) {
+    INFO(STRING(" count: "));
+    INFO(stringWithMinSizeDefault(STRING_CONVERT(histogram->count), 10));
+    INFO(STRING(" p50: < "));
+    INFO(stringWithMinSizeDefault(
+        STRING_CONVERT(cyclesToNanos(latencyPercentile(histogram, 50))), 10));
+    INFO(STRING(" p99: < "));
+    INFO(stringWithMinSizeDefault(
+        STRING_CONVERT(cyclesToNanos(latencyPercentile(histogram, 99))), 10));
+    INFO(STRING(" max: < "));
+    INFO(cyclesToNanos(latencyPercentile(histogram, 100)));
+    INFO(STRING(" ns\n"));
+}
+
+// NOTE: The latency of the timer vector includes the time its thread was
+// switched out when the interrupt preempted it.
+void interruptLatenciesStatusAppend() {
+    INFO(STRING("Interrupt latencies, rounded up to a power of 2 cycles:\n"));
+    for (U64 vector = 0; vector < INTERRUPT_VECTORS; vector++) {
+        LatencyHistogram histogram = latencyHistogramGet(vector);
+        if (!histogram.count) {
+            continue;
+        }
+
+        INFO(STRING("vector "));
+        INFO(stringWithMinSizeDefault(STRING_CONVERT(vector), 27));
+        latencyHistogramAppend(&histogram);
+    }
+
+    for (U64 outcome = 0; outcome < PAGE_FAULT_LATENCY_COUNT; outcome++) {
+        LatencyHistogram histogram =
+            latencyHistogramGet(INTERRUPT_VECTORS + outcome);
+        if (!histogram.count) {
+            continue;
+        }
+
+        INFO(stringWithMinSizeDefault(pageFaultLatencyToString[outcome], 34));
+        latencyHistogramAppend(&histogram);
+    }
+}
@@ -0,0 +1,272 @@
+#include "x86/kernel/processor.h"
+
+#include "abstraction/kernel.h"
+#include "abstraction/log.h"
+#include "abstraction/memory/manipulation.h"
+#include "abstraction/time.h"
+#include "shared/log.h"
+#include "shared/text/string.h"
+#include "shared/types/numeric.h"
+#include "x86/apic.h"
+#include "x86/configuration/cpu.h"
+#include "x86/configuration/features.h"
+#include "x86/fault.h"
+#include "x86/gdt.h"
+#include "x86/kernel/idt.h"
+#include "x86/kernel/latency.h"
+#include "x86/kernel/shootdown.h"
+#include "x86/memory/pat.h"
+#include "x86/time.h"
+
+extern U8 processorTrampolineStart[];
+extern U8 processorTrampolineLongMode[];
+extern U8 processorTrampolineGDT[];
+extern U8 processorTrampolineData[];
+extern U8 processorTrampolineEnd[];
+
+// NOTE: Keep in sync with the data at the end of trampoline.S
+typedef struct __attribute__((packed)) {
+    U64 CR0;
+    U64 CR3;
+    U64 CR4;
+    U64 EFER;
+    U64 entry;
+    U64 stackTop;
+    U64 processorID;
+    U32 longModeAddress;
+    U16 longModeSelector;
+    U16 GDTLimit;
+    U32 GDTAddress;
+} TrampolineData;
+
+static constexpr U32 IA32_EFER_LOCATION = 0xC0000080;
+static constexpr U32 IA32_GS_BASE_LOCATION = 0xC0000101;
+static constexpr U32 IA32_KERNEL_GS_BASE_LOCATION = 0xC0000102;
+static constexpr U64 EFER_LONG_MODE_ACTIVE = (1 << 10);
+// NOTE: Can only be set once long mode is active.
+static constexpr U64 CR4_PCID_ENABLE = (1 << 17);
+
+static constexpr auto PROCESSOR_START_TIMEOUT_MICROSECONDS = 100 * 1000;
+
+PerCPU processors[PROCESSORS_MAX];
+U32 processorsCount;
+
+static U64 trampolinePhysical;
+
+// NOTE: State that is per processor, copied from the bootstrap processor.
+static DescriptorTableRegister GDTRegister;
+static DescriptorTableRegister IDTRegister;
+static U64 PATValue;
+static U64 XCR0Value;
+
+static U32 processorsRunning;
+// NOTE: The ID of the processor that is being started. Both that processor and
+// the bootstrap processor on a timeout try to clear it, whoever does decides
+// whether the processor joins.
+static U32 processorStarting;
+static constexpr U32 PROCESSOR_STARTING_NONE = U32_MAX;
+
+// NOTE: Everything runs in ring 0, so there is no need to swapgs on entry. The
+// kernel GS base is set to the same area so a swapgs can not lose it.
+static void perCPUSet(PerCPU *perCPU) {
+    wrmsr(IA32_GS_BASE_LOCATION, (U64)perCPU);
+    wrmsr(IA32_KERNEL_GS_BASE_LOCATION, (U64)perCPU);
+}
+
+void processorsInit(ProcessorParams *processorParams, U8 *XSAVELocation,
+                    U64 XSAVEAreaBytes) {
+    APICBase = processorParams->APICBase;
+    trampolinePhysical = processorParams->trampolinePhysical;
+
+    processorsCount = processorParams->count;
+    for (typeof(processorsCount) i = 0; i < processorsCount; i++) {
+        U8 *processorXSAVE =
+            XSAVELocation + (i * XSAVEAreaBytes * XSAVE_NESTING_MAX);
+        processors[i] = (PerCPU){.self = &processors[i],
+                                 .pageFaults = 0,
+                                 .XSAVECurrent = processorXSAVE,
+                                 .interruptLatencies = nullptr,
+                                 .XSAVEEnd = processorXSAVE +
+                                             (XSAVEAreaBytes *
+                                              XSAVE_NESTING_MAX),
+                                 .id = i,
+                                 .APICID = processorParams->APICIDs[i],
+                                 .stackTop = processorParams->stackTops[i],
+                                 .XSAVELocation = processorXSAVE,
+                                 .work = nullptr,
+                                 .argument = nullptr,
+                                 .pageCacheShootdownsSent = 0,
+                                 .pageCacheEntriesFlushed = 0,
+                                 .pageCacheFullFlushes = 0};
+    }
+
+    perCPUSet(&processors[0]);
+}
+
+__attribute__((noreturn)) static void processorEntry(U32 processorID) {
+    U32 expected = processorID;
+    if (!__atomic_compare_exchange_n(&processorStarting, &expected,
+                                     PROCESSOR_STARTING_NONE, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        // NOTE: Too late, the bootstrap processor gave up on us.
+        while (1) {
+            asm volatile("cli; hlt");
+        }
+    }
+
+    // NOTE: Loading the segments clears the GS base, so set it after.
+    GDTAndSegmentsLoad(&GDTRegister);
+    perCPUSet(&processors[processorID]);
+    taskRegisterLoad((U16)processorID);
+    asm volatile("lidt %0" : : "m"(IDTRegister));
+
+    wrmsr(PAT_LOCATION, PATValue);
+    asm volatile("xsetbv"
+                 :
+                 : "c"(0), "a"((U32)(XCR0Value & 0xFFFFFFFF)),
+                   "d"((U32)(XCR0Value >> 32)));
+    if (XSAVEInstructionUsed == XSAVE_INSTRUCTION_XSAVES) {
+        wrmsr(IA32_XSS_LOCATION, 0);
+    }
+    asm volatile("fninit");
+    APICEnable(APIC_SPURIOUS_VECTOR);
+    pageCacheShootdownJoin();
+
+    PerCPU *processor = PERCPU_ADDRESS();
+    __atomic_fetch_add(&processorsRunning, 1, __ATOMIC_RELEASE);
+
+    while (1) {
+        ProcessorWork work =
+            __atomic_load_n(&processor->work, __ATOMIC_ACQUIRE);
+        if (!work) {
+            // NOTE: Interrupts are disabled, so the shootdown interrupt stays
+            // pending.
+            pageCacheShootdownReceive();
+            asm volatile("pause" ::: "memory");
+            continue;
+        }
+
+        work(processor->argument);
+        __atomic_store_n(&processor->work, nullptr, __ATOMIC_RELEASE);
+    }
+}
+
+static TrampolineData *trampolinePrepare(U64 pageTableRoot) {
+    U8 *trampoline = (U8 *)trampolinePhysical;
+    memcpy(trampoline, processorTrampolineStart,
+           (U64)(processorTrampolineEnd - processorTrampolineStart));
+
+    TrampolineData *data =
+        (TrampolineData *)(trampoline + (processorTrampolineData -
+                                         processorTrampolineStart));
+
+    U64 CR0;
+    asm volatile("mov %%cr0, %0" : "=r"(CR0));
+    U64 CR4;
+    asm volatile("mov %%cr4, %0" : "=r"(CR4));
+
+    data->CR0 = CR0;
+    data->CR3 = pageTableRoot;
+    data->CR4 = CR4 & ~CR4_PCID_ENABLE;
+    data->EFER = rdmsr(IA32_EFER_LOCATION) & ~EFER_LONG_MODE_ACTIVE;
+    data->entry = (U64)processorEntry;
+    data->longModeAddress =
+        (U32)(trampolinePhysical +
+              (U64)(processorTrampolineLongMode - processorTrampolineStart));
+    data->GDTAddress =
+        (U32)(trampolinePhysical +
+              (U64)(processorTrampolineGDT - processorTrampolineStart));
+
+    return data;
+}
+
+U32 processorsStart() {
+    interruptLatenciesInit();
+
+    if (processorsCount == 1) {
+        return 1;
+    }
+
+    U64 pageTableRoot = CR3();
+    if (pageTableRoot > U32_MAX) {
+        KFLUSH_AFTER {
+            ERROR(STRING("Can not start other processors, the page table "
+                         "root is above 4 GiB: "));
+            ERROR((void *)pageTableRoot, .flags = NEWLINE);
+        }
+        processorsCount = 1;
+        return 1;
+    }
+
+    asm volatile("sgdt %0" : "=m"(GDTRegister));
+    asm volatile("sidt %0" : "=m"(IDTRegister));
+    PATValue = rdmsr(PAT_LOCATION);
+    U32 eax;
+    U32 edx;
+    asm volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    XCR0Value = ((U64)edx << 32) | eax;
+
+    TrampolineData *data = trampolinePrepare(pageTableRoot);
+    APICEnable(APIC_SPURIOUS_VECTOR);
+    pageCacheShootdownInit();
+
+    processorsRunning = 1;
+    // NOTE: Processors are started one at a time because they share the
+    // trampoline data.
+    for (typeof(processorsCount) i = 1; i < processorsCount; i++) {
+        data->stackTop = processors[i].stackTop;
+        data->processorID = i;
+        __atomic_store_n(&processorStarting, i, __ATOMIC_RELEASE);
+
+        APICProcessorStart(processors[i].APICID, (U32)trampolinePhysical);
+
+        U64 deadline =
+            cycleCounterGet(false, false) +
+            PROCESSOR_START_TIMEOUT_MICROSECONDS * tscCyclesPerMicroSecond;
+        while (__atomic_load_n(&processorsRunning, __ATOMIC_ACQUIRE) <= i &&
+               cycleCounterGet(false, false) < deadline) {
+            asm volatile("pause" ::: "memory");
+        }
+
+        // NOTE: The processor IDs also select the TSS, so they can not have
+        // gaps and all remaining processors are left alone.
+        U32 expected = i;
+        if (__atomic_compare_exchange_n(&processorStarting, &expected,
+                                        PROCESSOR_STARTING_NONE, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            APICProcessorStop(processors[i].APICID);
+            KFLUSH_AFTER {
+                ERROR(STRING("Processor did not start, APIC ID: "));
+                ERROR(processors[i].APICID, .flags = NEWLINE);
+            }
+            break;
+        }
+
+        // NOTE: The processor claimed its ID, maybe only just after the
+        // deadline, so it is joining.
+        while (__atomic_load_n(&processorsRunning, __ATOMIC_ACQUIRE) <= i) {
+            asm volatile("pause" ::: "memory");
+        }
+    }
+
+    processorsCount = processorsRunning;
+    return processorsCount;
+}
+
+void processorWorkWait(U32 processorID) {
+    while (__atomic_load_n(&processors[processorID].work, __ATOMIC_ACQUIRE)) {
+        asm volatile("pause" ::: "memory");
+    }
+}
+
+void processorWorkRun(U32 processorID, ProcessorWork work, void *argument) {
+    processorWorkWait(processorID);
+    processors[processorID].argument = argument;
+    __atomic_store_n(&processors[processorID].work, work, __ATOMIC_RELEASE);
+}
+
+void processorSleep() { asm volatile("sti; hlt; cli" ::: "memory"); }
+
+void processorWake(U32 processorID) {
+    APICInterruptSend(processors[processorID].APICID, PROCESSOR_WAKE_VECTOR);
+}
@@ -0,0 +1,186 @@
+#include "abstraction/profiler.h"
+
+#include "abstraction/interrupts.h"
+#include "freestanding/log/init.h"
+#include "shared/log.h"
+#include "shared/maths.h"
+#include "shared/memory/policy.h"
+#include "shared/text/string.h"
+#include "shared/types/array-types.h"
+#include "shared/types/numeric.h"
+#include "x86/apic.h"
+#include "x86/configuration/cpu.h"
+#include "x86/fault.h"
+#include "x86/kernel/idt.h"
+#include "x86/kernel/percpu.h"
+#include "x86/kernel/processor.h"
+#include "x86/kernel/thread.h"
+#include "x86/time.h"
+
+// NOTE: The first general purpose counter, counting unhalted core cycles.
+#if defined(VENDOR_INTEL)
+static constexpr U32 PERFORMANCE_EVENT_SELECT_MSR = 0x186; // IA32_PERFEVTSEL0
+static constexpr U32 PERFORMANCE_COUNTER_MSR = 0xC1;       // IA32_PMC0
+static constexpr U64 PERFORMANCE_EVENT_CYCLES = 0x3C;
+// NOTE: Plain writes to the counter only set the low 32 bits and sign-extend
+// them.
+static constexpr auto PERFORMANCE_COUNTER_WRITE_BITS = 32;
+#elif defined(VENDOR_AMD)
+static constexpr U32 PERFORMANCE_EVENT_SELECT_MSR = 0xC0010000; // PERF_CTL0
+static constexpr U32 PERFORMANCE_COUNTER_MSR = 0xC0010004;      // PERF_CTR0
+static constexpr U64 PERFORMANCE_EVENT_CYCLES = 0x76;
+static constexpr auto PERFORMANCE_COUNTER_WRITE_BITS = 48;
+#else
+#error "No performance counter for this vendor"
+#endif
+
+static constexpr U64 PERFORMANCE_EVENT_USER = (1 << 16);
+static constexpr U64 PERFORMANCE_EVENT_KERNEL = (1 << 17);
+static constexpr U64 PERFORMANCE_EVENT_INTERRUPT = (1 << 20);
+static constexpr U64 PERFORMANCE_EVENT_ENABLE = (1 << 22);
+
+static constexpr auto PROFILER_SAMPLES = 4096;
+static constexpr auto PROFILER_FRAMES_MAX = 15;
+
+typedef struct {
+    U64 len;
+    U64 frames[PROFILER_FRAMES_MAX]; // The interrupted instruction first
+} ProfileSample;
+static_assert(sizeof(ProfileSample) == 128);
+
+typedef struct __attribute__((aligned(64))) {
+    U64 reload;             // Written to the counter, overflows after interval
+    ProfileSample *samples; // A ring of PROFILER_SAMPLES
+    U64 taken;              // The ring holds the newest of these
+} Profiler;
+
+static Profiler profilers[PROCESSORS_MAX];
+
+// Follows the saved frame pointers up the stack. Every frame has to be above
+// the previous one and inside the stack, so a garbage frame pointer ends the
+// walk instead of looping or reading past the stack. An interrupted stack
+// pointer outside the stack, e.g., on a coroutine stack, is not walked at all.
+// Only complete with frame pointers, see the PROFILING build.
+static U64 framesWalk(U64 *frames, U64 len, U64 framePointer,
+                      U64 stackPointer, Memory stack) {
+    U64 stackEnd = stack.start + stack.bytes;
+    if (stackPointer < stack.start || stackPointer >= stackEnd) {
+        return len;
+    }
+
+    while (len < PROFILER_FRAMES_MAX && framePointer >= stackPointer &&
+           framePointer + 2 * sizeof(U64) <= stackEnd &&
+           aligned(framePointer, sizeof(U64))) {
+        U64 *frame = (U64 *)framePointer;
+        // NOTE: A thread starts with a 0 return address.
+        if (!frame[1]) {
+            break;
+        }
+        frames[len] = frame[1];
+        len++;
+
+        stackPointer = framePointer + 2 * sizeof(U64);
+        framePointer = frame[0];
+    }
+    return len;
+}
+
+// NOTE: The counter counts up from reload, so it only has its top bit clear
+// again once it overflowed.
+static bool profilerCounterOverflowed() {
+    return !(rdmsr(PERFORMANCE_COUNTER_MSR) &
+             (1ULL << (PERFORMANCE_COUNTER_WRITE_BITS - 1)));
+}
+
+// NOTE: An NMI, so it runs wherever the processor was, even with interrupts
+// disabled or in the middle of another handler. It must not take any locks.
+static void profilerInterruptHandle(Registers *regs) {
+    if (!profilerCounterOverflowed()) {
+        faultHandlerNoReturn(regs);
+    }
+    // NOTE: One can still be on its way while the profiler is stopped.
+    Profiler *profiler = &profilers[PERCPU_GET(id)];
+    if (!profiler->reload) {
+        return;
+    }
+
+    ProfileSample *sample =
+        &profiler->samples[profiler->taken % PROFILER_SAMPLES];
+    sample->frames[0] = registersInstructionPointer(regs);
+    sample->len = framesWalk(sample->frames, 1, registersFramePointer(regs),
+                             registersStackPointer(regs), threadStackGet());
+    profiler->taken++;
+
+    wrmsr(PERFORMANCE_COUNTER_MSR, profiler->reload);
+    // NOTE: The local APIC masks the entry every time it delivers it.
+    APICWrite(APIC_LVT_PERFORMANCE_COUNTER_REGISTER,
+              APIC_LVT_DELIVERY_MODE_NMI);
+}
+
+void profilerStart(U64 intervalMicroSeconds) {
+    Profiler *profiler = &profilers[PERCPU_GET(id)];
+    if (!profiler->samples) {
+        profiler->samples = identityMemoryAlloc(
+            ceilingPowerOf2(PROFILER_SAMPLES * sizeof(ProfileSample)));
+        interruptHandlerSet(FAULT_NMI, profilerInterruptHandle);
+    }
+    profiler->taken = 0;
+    // NOTE: Core cycles are close enough to TSC cycles for an interval.
+    U64 cycles = MAX(intervalMicroSeconds * tscCyclesPerMicroSecond, 1);
+    profiler->reload =
+        (-cycles) & ((1ULL << PERFORMANCE_COUNTER_WRITE_BITS) - 1);
+
+    wrmsr(PERFORMANCE_COUNTER_MSR, profiler->reload);
+    APICWrite(APIC_LVT_PERFORMANCE_COUNTER_REGISTER,
+              APIC_LVT_DELIVERY_MODE_NMI);
+    wrmsr(PERFORMANCE_EVENT_SELECT_MSR,
+          PERFORMANCE_EVENT_CYCLES | PERFORMANCE_EVENT_USER |
+              PERFORMANCE_EVENT_KERNEL | PERFORMANCE_EVENT_INTERRUPT |
+              PERFORMANCE_EVENT_ENABLE);
+}
+
+void profilerStop() {
+    Profiler *profiler = &profilers[PERCPU_GET(id)];
+    if (profiler->samples) {
+        wrmsr(PERFORMANCE_EVENT_SELECT_MSR, 0);
+        APICWrite(APIC_LVT_PERFORMANCE_COUNTER_REGISTER, APIC_LVT_MASKED);
+        profiler->reload = 0;
+    }
+}
+
+static constexpr auto PROFILER_LINE_BYTES = 512;
+
+// Every sample is written as its own line, root first, followed by a count of
+// 1. Identical stacks are merged by the host tool.
+void profilerDump() {
+    profilerStop();
+
+    U32 processorID = PERCPU_GET(id);
+    Profiler *profiler = &profilers[processorID];
+
+    U8 lineBuffer[PROFILER_LINE_BYTES];
+    U8_a line = {.buf = lineBuffer, .len = 0};
+
+    KLOG_APPEND(&line, STRING("PROFILE BEGIN "));
+    KLOG_APPEND(&line, processorID);
+    KLOG_APPEND(&line, STRING(" "));
+    KLOG_APPEND(&line, profiler->taken);
+    KLOG_APPEND(&line, STRING("\n"));
+    logSerialFlush(line);
+    line.len = 0;
+
+    U64 samples = MIN(profiler->taken, PROFILER_SAMPLES);
+    for (U64 i = 0; i < samples; i++) {
+        ProfileSample *sample = &profiler->samples[i];
+        for (U64 frame = sample->len; frame-- > 0;) {
+            KLOG_APPEND(&line, (void *)sample->frames[frame]);
+            KLOG_APPEND(&line, frame ? STRING(";") : STRING(" "));
+        }
+        KLOG_APPEND(&line, STRING("1\n"));
+        logSerialFlush(line);
+        line.len = 0;
+    }
+
+    KLOG_APPEND(&line, STRING("PROFILE END\n"));
+    logSerialFlush(line);
+}
@@ -0,0 +1,139 @@
+#include "x86/kernel/shootdown.h"
+
+#include "abstraction/interrupts.h"
+#include "abstraction/memory/manipulation.h"
+#include "abstraction/memory/virtual/map.h"
+#include "abstraction/thread.h"
+#include "shared/lock/spin.h"
+#include "shared/types/numeric.h"
+#include "x86/apic.h"
+#include "x86/configuration/cpu.h"
+#include "x86/kernel/idt.h"
+#include "x86/kernel/percpu.h"
+#include "x86/kernel/processor.h"
+
+// NOTE: Senders only interrupt the processor when its queue is empty. Later
+// senders add to the same batch until the processor takes it, so one
+// interrupt can cover the flushes of several senders.
+typedef struct __attribute__((aligned(64))) {
+    SpinLock lock;
+    U32 len; // PAGE_CACHE_FLUSH_THRESHOLD stands for a full flush
+    U64 virts[PAGE_CACHE_FLUSH_THRESHOLD];
+    U64 requested; // Batches that were queued
+    U64 completed; // Batches that were flushed
+} ShootdownQueue;
+
+static ShootdownQueue shootdownQueues[PROCESSORS_MAX];
+
+// NOTE: There is only the kernel address space for now, so this is the single
+// mask of processors that can have its entries cached.
+static_assert(PROCESSORS_MAX <= 64);
+static U64 addressSpaceProcessors;
+
+static LockClass shootdownLockClass = LOCK_CLASS("shootdown");
+
+void pageCacheShootdownReceive() {
+    ShootdownQueue *queue = &shootdownQueues[PERCPU_GET(id)];
+    if (!__atomic_load_n(&queue->len, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    // NOTE: Interrupts stay disabled until completed is stored. Otherwise, a
+    // nested receive could take a later batch and report it done before this
+    // batch is flushed, or this could report an older batch over it.
+    U64 virts[PAGE_CACHE_FLUSH_THRESHOLD];
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&queue->lock);
+    U32 len = queue->len;
+    // NOTE: Not memcpy, this runs in an interrupt that did not save the vector
+    // state.
+    if (len < PAGE_CACHE_FLUSH_THRESHOLD) {
+        for (typeof(len) i = 0; i < len; i++) {
+            virts[i] = queue->virts[i];
+        }
+    }
+    U64 requested = queue->requested;
+    __atomic_store_n(&queue->len, 0, __ATOMIC_RELAXED);
+    spinLockRelease(&queue->lock);
+
+    if (len >= PAGE_CACHE_FLUSH_THRESHOLD) {
+        pageCacheFlush();
+        PERCPU_ADD(pageCacheFullFlushes, 1);
+    } else {
+        for (typeof(len) i = 0; i < len; i++) {
+            pageCacheEntryFlush(virts[i]);
+        }
+        PERCPU_ADD(pageCacheEntriesFlushed, len);
+    }
+
+    __atomic_store_n(&queue->completed, requested, __ATOMIC_RELEASE);
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+}
+
+static void shootdownInterruptHandle(Registers *regs) {
+    (void)regs;
+    APICWrite(APIC_EOI_REGISTER, 0);
+    pageCacheShootdownReceive();
+}
+
+// Queues the flush on the other processors and waits until all of them have
+// done it, only then can the caller hand out the memory again.
+static void shootdownSend(U64 *virts, U32 len) {
+    U32 self = PERCPU_GET(id);
+    U64 targets = __atomic_load_n(&addressSpaceProcessors, __ATOMIC_ACQUIRE) &
+                  ~(1ULL << self);
+
+    U64 tickets[PROCESSORS_MAX];
+    for (U64 remaining = targets; remaining; remaining &= remaining - 1) {
+        U32 target = (U32)__builtin_ctzll(remaining);
+        ShootdownQueue *queue = &shootdownQueues[target];
+
+        bool interruptsWereEnabled =
+            spinLockAcquireInterruptsDisable(&queue->lock);
+        bool announced = queue->len;
+        if (queue->len + len >= PAGE_CACHE_FLUSH_THRESHOLD) {
+            __atomic_store_n(&queue->len, PAGE_CACHE_FLUSH_THRESHOLD,
+                             __ATOMIC_RELEASE);
+        } else {
+            memcpy(&queue->virts[queue->len], virts, len * sizeof(*virts));
+            __atomic_store_n(&queue->len, queue->len + len, __ATOMIC_RELEASE);
+        }
+        queue->requested++;
+        tickets[target] = queue->requested;
+        spinLockReleaseInterruptsRestore(&queue->lock, interruptsWereEnabled);
+
+        if (!announced) {
+            APICInterruptSend(processors[target].APICID,
+                              PAGE_CACHE_SHOOTDOWN_VECTOR);
+            PERCPU_ADD(pageCacheShootdownsSent, 1);
+        }
+    }
+
+    // NOTE: The targets may be waiting on a flush from this processor at the
+    // same time, possibly with interrupts disabled, so keep taking our own
+    // queue while waiting.
+    for (U64 remaining = targets; remaining; remaining &= remaining - 1) {
+        U32 target = (U32)__builtin_ctzll(remaining);
+        while (__atomic_load_n(&shootdownQueues[target].completed,
+                               __ATOMIC_ACQUIRE) < tickets[target]) {
+            pageCacheShootdownReceive();
+            spinWaitHint();
+        }
+    }
+}
+
+void pageCacheShootdownJoin() {
+    __atomic_fetch_or(&addressSpaceProcessors, 1ULL << PERCPU_GET(id),
+                      __ATOMIC_RELEASE);
+}
+
+void pageCacheShootdownInit() {
+    for (U32 i = 0; i < PROCESSORS_MAX; i++) {
+        spinLockInit(&shootdownQueues[i].lock, &shootdownLockClass);
+    }
+    interruptHandlerSet(PAGE_CACHE_SHOOTDOWN_VECTOR, shootdownInterruptHandle);
+    pageCacheShootdownJoin();
+    pageCacheRemoteFlush = shootdownSend;
+}
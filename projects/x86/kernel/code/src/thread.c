@@ -0,0 +1,355 @@
+#include "abstraction/thread.h"
+
+#include "abstraction/interrupts.h"
+#include "abstraction/kernel.h"
+#include "abstraction/timer.h"
+#include "efi-to-kernel/memory/definitions.h"
+#include "shared/lock/spin.h"
+#include "shared/maths.h"
+#include "shared/memory/management/definitions.h"
+#include "shared/memory/policy.h"
+#include "shared/memory/sizes.h"
+#include "shared/types/numeric.h"
+#include "x86/kernel/idt.h"
+#include "x86/kernel/percpu.h"
+#include "x86/kernel/processor.h"
+#include "x86/kernel/thread.h"
+
+static constexpr auto THREAD_STACK_BYTES = 256 * KiB;
+static constexpr auto THREAD_TIME_SLICE_MICROSECONDS = 10 * 1000;
+
+typedef enum : U8 {
+    THREAD_READY,
+    THREAD_RUNNING,
+    THREAD_BLOCKED,
+    THREAD_DEAD
+} ThreadState;
+
+struct Thread {
+    U64 stackPointer;    // Only valid while the thread is not running
+    U8 *XSAVECurrent;    // Only valid while the thread is not running
+    struct Thread *next; // In a run queue or wait list
+    ThreadState state;
+    U32 processorID;
+    Timer sleepTimer;
+    ThreadFunction function;
+    void *argument;
+    Memory stack;      // Empty for the first thread, it must never exit
+    U8 *XSAVELocation; // XSAVE_NESTING_MAX areas of XSAVEAreaBytes each
+};
+
+typedef struct {
+    Thread *head;
+    Thread *tail;
+} ThreadQueue;
+
+typedef struct {
+    SpinLock lock; // Threads of other processors can wake ours
+    Thread *current;
+    Thread *idle;
+    ThreadQueue ready;
+    Thread *dead; // Freed by the next threadCreate on this processor
+    Timer timeSlice;
+    bool preemptPending;
+} Scheduler;
+
+static Scheduler schedulers[PROCESSORS_MAX];
+static LockClass schedulerLockClass = LOCK_CLASS("scheduler");
+
+extern void threadContextSwitch(U64 *stackPointerSave, U64 stackPointerLoad);
+
+static void threadQueuePush(ThreadQueue *queue, Thread *thread) {
+    thread->next = nullptr;
+    if (queue->tail) {
+        queue->tail->next = thread;
+    } else {
+        queue->head = thread;
+    }
+    queue->tail = thread;
+}
+
+static Thread *threadQueuePop(ThreadQueue *queue) {
+    Thread *thread = queue->head;
+    if (thread) {
+        queue->head = thread->next;
+        if (!queue->head) {
+            queue->tail = nullptr;
+        }
+    }
+    return thread;
+}
+
+// NOTE: Must be called with interrupts disabled.
+static void schedule() {
+    Scheduler *scheduler = &schedulers[PERCPU_GET(id)];
+
+    spinLockAcquire(&scheduler->lock);
+    Thread *current = scheduler->current;
+    // NOTE: A thread that blocked can already be woken and be in the queue.
+    if (current->state == THREAD_RUNNING) {
+        current->state = THREAD_READY;
+        if (current != scheduler->idle) {
+            threadQueuePush(&scheduler->ready, current);
+        }
+    }
+
+    Thread *next = threadQueuePop(&scheduler->ready);
+    if (!next) {
+        next = scheduler->idle;
+    }
+    next->state = THREAD_RUNNING;
+    scheduler->current = next;
+    spinLockRelease(&scheduler->lock);
+
+    if (next == current) {
+        return;
+    }
+
+    current->XSAVECurrent = PERCPU_GET(XSAVECurrent);
+    PERCPU_SET(XSAVECurrent, next->XSAVECurrent);
+    PERCPU_SET(XSAVEEnd,
+               next->XSAVELocation + (XSAVEAreaBytes * XSAVE_NESTING_MAX));
+    threadContextSwitch(&current->stackPointer, next->stackPointer);
+}
+
+static void threadWake(Thread *thread) {
+    U32 processorID = thread->processorID;
+    Scheduler *scheduler = &schedulers[processorID];
+
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&scheduler->lock);
+    if (thread->state == THREAD_BLOCKED) {
+        thread->state = THREAD_READY;
+        threadQueuePush(&scheduler->ready, thread);
+    }
+    spinLockReleaseInterruptsRestore(&scheduler->lock, interruptsWereEnabled);
+
+    if (processorID != PERCPU_GET(id)) {
+        processorWake(processorID);
+    }
+}
+
+static void threadSleepEnd(void *argument) { threadWake(argument); }
+
+static void timeSliceEnd(void *argument) {
+    Scheduler *scheduler = argument;
+    scheduler->preemptPending = true;
+}
+
+void threadPreemptCheck() {
+    Scheduler *scheduler = &schedulers[PERCPU_GET(id)];
+    if (scheduler->preemptPending) {
+        scheduler->preemptPending = false;
+        // NOTE: The timer interrupt leaves the vector state in the registers,
+        // where the next thread would overwrite it.
+        vectorStateSave();
+        schedule();
+        vectorStateRestore();
+    }
+}
+
+static void threadsDeadFree(Scheduler *scheduler) {
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&scheduler->lock);
+    Thread *dead = scheduler->dead;
+    scheduler->dead = nullptr;
+    spinLockReleaseInterruptsRestore(&scheduler->lock, interruptsWereEnabled);
+
+    while (dead) {
+        Thread *next = dead->next;
+        mappableStackFree(dead->stack);
+        identityMemoryFree((Memory){
+            .start = (U64)dead->XSAVELocation,
+            .bytes = ceilingPowerOf2(XSAVEAreaBytes * XSAVE_NESTING_MAX)});
+        identityMemoryFree((Memory){.start = (U64)dead,
+                                    .bytes = ceilingPowerOf2(sizeof(Thread))});
+        dead = next;
+    }
+}
+
+// NOTE: Every thread starts here through the return of threadContextSwitch,
+// coming from schedule with interrupts disabled.
+__attribute__((noreturn)) static void threadEntry() {
+    Thread *current = schedulers[PERCPU_GET(id)].current;
+    interruptsEnable();
+    current->function(current->argument);
+    threadExit();
+}
+
+// NOTE: Keep in sync with threadContextSwitch in context.S
+static void threadStackPrepare(Thread *thread) {
+    U64 *stackPointer = (U64 *)(thread->stack.start + thread->stack.bytes);
+    // NOTE: threadEntry is entered as if it was called, so the stack is 16-byte
+    // aligned minus the return address, which is never used.
+    *(--stackPointer) = 0;
+    *(--stackPointer) = (U64)threadEntry;
+    // rbp, rbx, r12, r13, r14, r15
+    for (U64 i = 0; i < 6; i++) {
+        *(--stackPointer) = 0;
+    }
+    thread->stackPointer = (U64)stackPointer;
+}
+
+static Thread *threadAlloc(ThreadFunction function, void *argument) {
+    Thread *thread = identityMemoryAlloc(ceilingPowerOf2(sizeof(Thread)));
+    thread->next = nullptr;
+    thread->state = THREAD_BLOCKED;
+    thread->processorID = PERCPU_GET(id);
+    timerInit(&thread->sleepTimer, threadSleepEnd, thread);
+    thread->function = function;
+    thread->argument = argument;
+    // NOTE: Backed fully, a stack growth fault would enter the memory
+    // allocators, which the thread may have preempted.
+    thread->stack = mappableStackAlloc(THREAD_STACK_BYTES, THREAD_STACK_BYTES);
+    thread->XSAVELocation = identityMemoryAlloc(
+        ceilingPowerOf2(XSAVEAreaBytes * XSAVE_NESTING_MAX));
+    thread->XSAVECurrent = thread->XSAVELocation;
+    threadStackPrepare(thread);
+    return thread;
+}
+
+static void idleRun(void *argument) {
+    (void)argument;
+    interruptsDisable();
+    while (1) {
+        schedule();
+        processorSleep();
+    }
+}
+
+void threadsInit() {
+    U32 processorID = PERCPU_GET(id);
+    Scheduler *scheduler = &schedulers[processorID];
+    spinLockInit(&scheduler->lock, &schedulerLockClass);
+    scheduler->ready = (ThreadQueue){.head = nullptr, .tail = nullptr};
+    scheduler->dead = nullptr;
+    scheduler->preemptPending = false;
+
+    // NOTE: The running code keeps its stack and the XSAVE areas of the
+    // processor.
+    Thread *first = identityMemoryAlloc(ceilingPowerOf2(sizeof(Thread)));
+    *first = (Thread){.next = nullptr,
+                      .state = THREAD_RUNNING,
+                      .processorID = processorID,
+                      .function = nullptr,
+                      .argument = nullptr,
+                      .stack = (Memory){.start = 0, .bytes = 0},
+                      .XSAVELocation = PERCPU_GET(XSAVELocation)};
+    timerInit(&first->sleepTimer, threadSleepEnd, first);
+    scheduler->current = first;
+    scheduler->idle = threadAlloc(idleRun, nullptr);
+
+    timersInit();
+    timerInit(&scheduler->timeSlice, timeSliceEnd, scheduler);
+    timerPeriodicStart(&scheduler->timeSlice, THREAD_TIME_SLICE_MICROSECONDS);
+    interruptsEnable();
+}
+
+Memory threadStackGet() {
+    Thread *current = schedulers[PERCPU_GET(id)].current;
+    if (current && current->stack.bytes) {
+        return current->stack;
+    }
+    return (Memory){.start = PERCPU_GET(stackTop) - KERNEL_STACK_SIZE,
+                    .bytes = KERNEL_STACK_SIZE};
+}
+
+Thread *threadCreate(ThreadFunction function, void *argument) {
+    threadsDeadFree(&schedulers[PERCPU_GET(id)]);
+
+    Thread *thread = threadAlloc(function, argument);
+    threadWake(thread);
+    return thread;
+}
+
+void threadExit() {
+    interruptsDisable();
+    Scheduler *scheduler = &schedulers[PERCPU_GET(id)];
+
+    spinLockAcquire(&scheduler->lock);
+    Thread *current = scheduler->current;
+    current->state = THREAD_DEAD;
+    current->next = scheduler->dead;
+    scheduler->dead = current;
+    spinLockRelease(&scheduler->lock);
+
+    schedule();
+    __builtin_unreachable();
+}
+
+void threadYield() {
+    bool interruptsWereEnabled = interruptsEnabled();
+    interruptsDisable();
+    schedule();
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+}
+
+void threadSleep(U64 microSeconds) {
+    bool interruptsWereEnabled = interruptsEnabled();
+    interruptsDisable();
+    Scheduler *scheduler = &schedulers[PERCPU_GET(id)];
+
+    // NOTE: The timer fires on this processor, so not before interrupts are
+    // enabled again after switching away.
+    spinLockAcquire(&scheduler->lock);
+    Thread *current = scheduler->current;
+    current->state = THREAD_BLOCKED;
+    spinLockRelease(&scheduler->lock);
+    timerStart(&current->sleepTimer, microSeconds);
+
+    schedule();
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+}
+
+void threadEventInit(ThreadEvent *event) {
+    spinLockInit(&event->lock, &schedulerLockClass);
+    event->signaled = false;
+    event->waitersHead = nullptr;
+    event->waitersTail = nullptr;
+}
+
+void threadEventWait(ThreadEvent *event) {
+    bool interruptsWereEnabled = spinLockAcquireInterruptsDisable(&event->lock);
+    if (event->signaled) {
+        event->signaled = false;
+        spinLockReleaseInterruptsRestore(&event->lock, interruptsWereEnabled);
+        return;
+    }
+
+    // NOTE: Marked as blocked while holding the event lock, so a signal can
+    // only wake it after this.
+    Thread *current = schedulers[PERCPU_GET(id)].current;
+    current->state = THREAD_BLOCKED;
+    ThreadQueue waiters = {.head = event->waitersHead,
+                           .tail = event->waitersTail};
+    threadQueuePush(&waiters, current);
+    event->waitersHead = waiters.head;
+    event->waitersTail = waiters.tail;
+    spinLockRelease(&event->lock);
+
+    schedule();
+    if (interruptsWereEnabled) {
+        interruptsEnable();
+    }
+}
+
+void threadEventSignal(ThreadEvent *event) {
+    bool interruptsWereEnabled = spinLockAcquireInterruptsDisable(&event->lock);
+    ThreadQueue waiters = {.head = event->waitersHead,
+                           .tail = event->waitersTail};
+    Thread *waiter = threadQueuePop(&waiters);
+    event->waitersHead = waiters.head;
+    event->waitersTail = waiters.tail;
+    if (!waiter) {
+        event->signaled = true;
+    }
+    spinLockReleaseInterruptsRestore(&event->lock, interruptsWereEnabled);
+
+    if (waiter) {
+        threadWake(waiter);
+    }
+}
@@ -0,0 +1,271 @@
+#include "abstraction/timer.h"
+
+#include "abstraction/time.h"
+#include "shared/lock/spin.h"
+#include "shared/maths.h"
+#include "shared/types/numeric.h"
+#include "x86/apic.h"
+#include "x86/kernel/idt.h"
+#include "x86/kernel/percpu.h"
+#include "x86/kernel/processor.h"
+#include "x86/kernel/thread.h"
+#include "x86/time.h"
+
+// NOTE: A tick is 2^TIMER_TICK_SHIFT cycles, a third of a microsecond at
+// 3 GHz.
+static constexpr auto TIMER_TICK_SHIFT = 10;
+static constexpr auto TIMER_LEVEL_BITS = 6;
+static constexpr auto TIMER_LEVEL_SLOTS = 1 << TIMER_LEVEL_BITS;
+static constexpr auto TIMER_LEVELS = 5;
+static constexpr auto TIMER_LAST_LEVEL_SHIFT =
+    (TIMER_LEVELS - 1) * TIMER_LEVEL_BITS;
+
+// Every level is TIMER_LEVEL_SLOTS times coarser than the one below it.
+// Timers are never cascaded down. Instead, their deadline is rounded up to
+// the granularity of the level they are in, at most about 1/64th of the time
+// until it. This is what coalesces nearby deadlines: they end up in the same
+// slot and expire with a single interrupt.
+//
+// Deadlines beyond the last level are put in its furthest slot and are moved
+// again once that expires.
+typedef struct __attribute__((aligned(64))) {
+    SpinLock lock; // Timers can be cancelled from other processors
+    U64 now;       // In ticks, all timers up to here have expired
+    U64 armed;     // The tick the hardware timer fires at
+    U64 occupied[TIMER_LEVELS]; // A bit per slot that has timers
+    Timer *slots[TIMER_LEVELS][TIMER_LEVEL_SLOTS];
+    Timer *expired; // Taken one at a time, so they can still be cancelled
+} TimerWheel;
+
+static TimerWheel timerWheels[PROCESSORS_MAX];
+static LockClass timerWheelLockClass = LOCK_CLASS("timer wheel");
+
+static U64 ticksGet() {
+    return cycleCounterGet(false, false) >> TIMER_TICK_SHIFT;
+}
+
+static U64 microSecondsToTicks(U64 microSeconds) {
+    return MAX((microSeconds * tscCyclesPerMicroSecond) >> TIMER_TICK_SHIFT,
+               1);
+}
+
+static void timerHardwareArm(TimerWheel *wheel, U64 expiry) {
+    wheel->armed = expiry;
+    APICTimerDeadlineArm(expiry << TIMER_TICK_SHIFT);
+}
+
+static void timerPush(Timer **list, Timer *timer) {
+    timer->next = *list;
+    if (*list) {
+        (*list)->previousNext = &timer->next;
+    }
+    timer->previousNext = list;
+    *list = timer;
+    timer->pending = true;
+}
+
+static void timerLink(TimerWheel *wheel, Timer *timer, U64 now) {
+    U64 deadline = MAX(timer->deadline, now + 1);
+    U64 delta = deadline - now;
+
+    U32 shift = 0;
+    while (shift < TIMER_LAST_LEVEL_SHIFT &&
+           delta >= ((U64)(TIMER_LEVEL_SLOTS - 1) << shift)) {
+        shift += TIMER_LEVEL_BITS;
+    }
+    if (delta >= ((U64)(TIMER_LEVEL_SLOTS - 1) << shift)) {
+        deadline = now + ((U64)(TIMER_LEVEL_SLOTS - 1) << shift);
+    }
+
+    U64 slotTicks = (deadline + (1ULL << shift) - 1) >> shift;
+    timer->expiry = slotTicks << shift;
+
+    U32 level = shift / TIMER_LEVEL_BITS;
+    U32 index = slotTicks & (TIMER_LEVEL_SLOTS - 1);
+    timerPush(&wheel->slots[level][index], timer);
+    wheel->occupied[level] |= 1ULL << index;
+}
+
+static void timerUnlink(TimerWheel *wheel, Timer *timer) {
+    *timer->previousNext = timer->next;
+    if (timer->next) {
+        timer->next->previousNext = timer->previousNext;
+    }
+    timer->pending = false;
+
+    // NOTE: A slot is only empty if this was the last timer in it, in which
+    // case previousNext points into the slots array.
+    Timer **slots = &wheel->slots[0][0];
+    if (timer->previousNext >= slots &&
+        timer->previousNext < slots + (TIMER_LEVELS * TIMER_LEVEL_SLOTS) &&
+        !*timer->previousNext) {
+        U64 slotIndex = (U64)(timer->previousNext - slots);
+        wheel->occupied[slotIndex / TIMER_LEVEL_SLOTS] &=
+            ~(1ULL << (slotIndex % TIMER_LEVEL_SLOTS));
+    }
+}
+
+// Moves the timers that expired at or before now to the expired list. Timers
+// that were only parked in the last level are linked again.
+static void timersExpiredTake(TimerWheel *wheel, U64 now) {
+    Timer *parked = nullptr;
+
+    for (U32 level = 0; level < TIMER_LEVELS; level++) {
+        U32 shift = level * TIMER_LEVEL_BITS;
+        U64 from = (wheel->now >> shift) + 1;
+        U64 to = now >> shift;
+        if (to < from) {
+            continue;
+        }
+        U64 slotsToCheck = MIN(to - from + 1, TIMER_LEVEL_SLOTS);
+
+        for (U64 i = 0; i < slotsToCheck; i++) {
+            U32 index = (from + i) & (TIMER_LEVEL_SLOTS - 1);
+            Timer *timer = wheel->slots[level][index];
+            while (timer) {
+                Timer *next = timer->next;
+                if (timer->expiry <= now) {
+                    timerUnlink(wheel, timer);
+                    if (timer->deadline > now) {
+                        timer->next = parked;
+                        parked = timer;
+                    } else {
+                        timerPush(&wheel->expired, timer);
+                    }
+                }
+                timer = next;
+            }
+        }
+    }
+
+    wheel->now = now;
+    while (parked) {
+        Timer *next = parked->next;
+        timerLink(wheel, parked, now);
+        parked = next;
+    }
+}
+
+// NOTE: All pending timers are within TIMER_LEVEL_SLOTS slots of now in their
+// level, so the first occupied slot after now is the next expiry of a level.
+static U64 timersNextExpiry(TimerWheel *wheel) {
+    U64 result = U64_MAX;
+    for (U32 level = 0; level < TIMER_LEVELS; level++) {
+        U64 occupied = wheel->occupied[level];
+        if (!occupied) {
+            continue;
+        }
+
+        U32 shift = level * TIMER_LEVEL_BITS;
+        U64 current = wheel->now >> shift;
+        U32 start = (current + 1) & (TIMER_LEVEL_SLOTS - 1);
+        U64 rotated = (occupied >> start) |
+                      (start ? occupied << (TIMER_LEVEL_SLOTS - start) : 0);
+        U64 distance = (U64)__builtin_ctzll(rotated) + 1;
+        result = MIN(result, (current + distance) << shift);
+    }
+    return result;
+}
+
+// NOTE: Called from faultHandler with interrupts disabled, on the stack of the
+// interrupted thread.
+static void timerInterruptHandle(Registers *regs) {
+    (void)regs;
+    APICWrite(APIC_EOI_REGISTER, 0);
+    TimerWheel *wheel = &timerWheels[PERCPU_GET(id)];
+
+    spinLockAcquire(&wheel->lock);
+    timersExpiredTake(wheel, ticksGet());
+    while (wheel->expired) {
+        Timer *timer = wheel->expired;
+        timerUnlink(wheel, timer);
+
+        // NOTE: Linked again before running, so the function can cancel or
+        // restart its own timer. Missed periods are skipped.
+        if (timer->period) {
+            timer->deadline += timer->period;
+            if (timer->deadline <= wheel->now) {
+                timer->deadline = wheel->now + timer->period;
+            }
+            timerLink(wheel, timer, wheel->now);
+        }
+        spinLockRelease(&wheel->lock);
+
+        timer->function(timer->argument);
+
+        spinLockAcquire(&wheel->lock);
+    }
+
+    U64 nextExpiry = timersNextExpiry(wheel);
+    if (nextExpiry != U64_MAX) {
+        timerHardwareArm(wheel, nextExpiry);
+    } else {
+        wheel->armed = U64_MAX;
+    }
+    spinLockRelease(&wheel->lock);
+
+    threadPreemptCheck();
+}
+
+void timersInit() {
+    TimerWheel *wheel = &timerWheels[PERCPU_GET(id)];
+    spinLockInit(&wheel->lock, &timerWheelLockClass);
+    wheel->now = ticksGet();
+    wheel->armed = U64_MAX;
+    wheel->expired = nullptr;
+
+    interruptHandlerSet(APIC_TIMER_VECTOR, timerInterruptHandle);
+    APICTimerInit(APIC_TIMER_VECTOR);
+}
+
+void timerInit(Timer *timer, TimerFunction function, void *argument) {
+    *timer = (Timer){.next = nullptr,
+                     .previousNext = nullptr,
+                     .deadline = 0,
+                     .expiry = 0,
+                     .period = 0,
+                     .processorID = 0,
+                     .pending = false,
+                     .function = function,
+                     .argument = argument};
+}
+
+static void timerSchedule(Timer *timer, U64 ticks, U64 period) {
+    timerCancel(timer);
+
+    TimerWheel *wheel = &timerWheels[PERCPU_GET(id)];
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&wheel->lock);
+    U64 now = ticksGet();
+    timer->deadline = now + ticks;
+    timer->period = period;
+    timer->processorID = PERCPU_GET(id);
+    timerLink(wheel, timer, now);
+
+    // NOTE: The wheel is only brought up to date in the interrupt, so only
+    // move the hardware timer forward here.
+    if (timer->expiry < wheel->armed) {
+        timerHardwareArm(wheel, timer->expiry);
+    }
+    spinLockReleaseInterruptsRestore(&wheel->lock, interruptsWereEnabled);
+}
+
+void timerStart(Timer *timer, U64 microSeconds) {
+    timerSchedule(timer, microSecondsToTicks(microSeconds), 0);
+}
+
+void timerPeriodicStart(Timer *timer, U64 microSeconds) {
+    U64 ticks = microSecondsToTicks(microSeconds);
+    timerSchedule(timer, ticks, ticks);
+}
+
+void timerCancel(Timer *timer) {
+    TimerWheel *wheel = &timerWheels[timer->processorID];
+    bool interruptsWereEnabled =
+        spinLockAcquireInterruptsDisable(&wheel->lock);
+    if (timer->pending) {
+        timerUnlink(wheel, timer);
+    }
+    timer->period = 0;
+    spinLockReleaseInterruptsRestore(&wheel->lock, interruptsWereEnabled);
+}